@@ -0,0 +1,42 @@
+# ============================================================================
+#  EmbedShaders.cmake — Turn shaders/* into a compiled-in string table
+# ============================================================================
+#  Run in script mode at build time:
+#    cmake -DSHADER_DIR=<dir> -DOUTPUT=<file> -P EmbedShaders.cmake
+#  Writes one constexpr byte array per file (so UTF-8 comments, quotes
+#  and string-literal length limits never matter) plus a table
+#  { file name, source, length } included by src/EmbeddedShaders.cpp.
+# ============================================================================
+
+file(GLOB SHADER_FILES RELATIVE "${SHADER_DIR}" "${SHADER_DIR}/*")
+list(SORT SHADER_FILES)
+
+string(REPEAT "0x..," 16 ROW)
+
+set(ARRAYS "")
+set(TABLE "")
+set(INDEX 0)
+foreach(NAME ${SHADER_FILES})
+    file(READ "${SHADER_DIR}/${NAME}" HEX HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX}")
+    # Line-wrap every 16 bytes (CMake regexes have no {n} quantifier)
+    string(REGEX REPLACE "(${ROW})" "\\1\n    " BYTES "${BYTES}")
+    string(APPEND ARRAYS
+        "// ${NAME}\nstatic constexpr unsigned char kShader${INDEX}[] = {\n    ${BYTES}0x00\n};\n\n")
+    string(APPEND TABLE
+        "    { \"${NAME}\", kShader${INDEX}, sizeof(kShader${INDEX}) - 1 },\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+set(CONTENT "// Generated by cmake/EmbedShaders.cmake from ${SHADER_DIR} - do not edit.\n\n")
+string(APPEND CONTENT "${ARRAYS}")
+string(APPEND CONTENT "static constexpr EmbeddedShaders::Entry kEmbeddedShaders[] = {\n${TABLE}};\n")
+
+# Only touch the file when it changed, so dependents don't rebuild
+set(OLD "")
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" OLD)
+endif()
+if(NOT OLD STREQUAL CONTENT)
+    file(WRITE "${OUTPUT}" "${CONTENT}")
+endif()
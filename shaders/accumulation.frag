@@ -0,0 +1,29 @@
+#version 330 core
+// ============================================================================
+//  Accumulation — Multi-Exposure Integration — Modular Effect
+// ============================================================================
+//  Adds one sub-frame to the running exposure: the history texture holds
+//  this stage's previous output and u_historyWeight its weight (1 for a
+//  box window, the decay for an exponential one), so the result is the
+//  integrated signal so far.  Self-contained (temporal stages are not
+//  fused); the chain prepends noise_utils.glsl and the NoiseChainBlock.
+// ============================================================================
+
+in  vec2 v_texCoord;
+out vec4 fragColor;
+
+uniform sampler2D u_inputTexture;
+uniform sampler2D u_historyTexture;  // previous sub-frame's output
+uniform float     u_historyWeight;   // weight of the history, 0 = restart
+
+void main()
+{
+    vec3 color = texture(u_inputTexture, v_texCoord).rgb;
+
+    // The first sub-frame never reads the history: it holds the previous
+    // exposure or, before the first one, undefined (possibly NaN) texels.
+    if (u_historyWeight > 0.0)
+        color += u_historyWeight * texture(u_historyTexture, v_texCoord).rgb;
+
+    fragColor = vec4(color, 1.0);
+}
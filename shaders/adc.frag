@@ -0,0 +1,21 @@
+#version 330 core
+// ============================================================================
+//  ADC — Analogue-to-Digital Conversion — Modular Effect
+// ============================================================================
+//  The only quantisation stage in a float chain.  Applies conversion gain
+//  and black level to the linear signal, clips at full scale and rounds to
+//  an N-bit code; the output is the code normalised to [0,1].
+//  Expects the chain preamble and noise_utils.glsl to be prepended; the
+//  chain generates main() around apply_adc().
+// ============================================================================
+
+uniform int       u_adcBits;         // bit depth (e.g. 12)
+uniform float     u_adcGain;         // signal -> full scale
+uniform float     u_blackLevel;      // offset added before clipping (full scale units)
+
+vec3 apply_adc(vec3 color, vec2 fragCoord)
+{
+    float maxCode = exp2(float(u_adcBits)) - 1.0;
+    vec3  analog  = clamp(color * u_adcGain + u_blackLevel, 0.0, 1.0);
+    return floor(analog * maxCode + 0.5) / maxCode;
+}
@@ -3,49 +3,57 @@
 //  Dark Noise — Dark Current + DSNU + Hot Pixels — Modular Effect
 // ============================================================================
 //  Adds dark current (Poisson-sampled temporal noise) plus fixed-pattern
-//  dark-signal non-uniformity and hot pixel defects.
-//  Expects noise_utils.glsl to be prepended.
+//  dark-signal non-uniformity and hot pixel defects.  The DSNU offset map
+//  and hot pixel mask are baked on the CPU (FixedPatternMaps).
+//  Expects the chain preamble and noise_utils.glsl to be prepended; the
+//  chain generates main() around apply_dark_noise().
+//  Feature keys (DarkNoiseEffect::getFeatureKeys()):
+//    DARK_DSNU          sample the DSNU map (else no offset)
+//    DARK_HOT_PIXELS    sample the hot pixel mask (else no hot pixels)
+//    DARK_FAST_NORMALS  rand_normal_fast() for the Gaussian approximation
+//                       (large lambda, or POISSON_QUALITY 0)
 // ============================================================================
 
-in  vec2 v_texCoord;
-out vec4 fragColor;
+#ifndef DARK_DSNU
+#define DARK_DSNU 0
+#endif
+#ifndef DARK_HOT_PIXELS
+#define DARK_HOT_PIXELS 0
+#endif
+#ifndef DARK_FAST_NORMALS
+#define DARK_FAST_NORMALS 0
+#endif
 
-uniform sampler2D u_inputTexture;
 uniform float     u_darkCurrent;         // mean dark current (normalised)
-uniform float     u_dsnuStrength;        // DSNU sigma
-uniform float     u_hotPixelProbability; // fraction of hot pixels
 uniform float     u_hotPixelStrength;    // hot pixel dark current multiplier
-uniform int       u_frameNumber;
-uniform vec2      u_resolution;
+uniform sampler2D u_dsnuMap;             // half-normal DSNU offset, R16F
+uniform sampler2D u_hotPixelMask;        // 1 = hot pixel, R8
+uniform uint      u_darkStream;          // RNG stream ID
 
-void main()
+vec3 apply_dark_noise(vec3 color, vec2 fragCoord)
 {
-    vec2 fragCoord = v_texCoord * u_resolution;
-    vec3 color = texture(u_inputTexture, v_texCoord).rgb;
-
-    // ── Fixed-pattern: DSNU offset + hot pixel (spatial seed, static) ───
-    uint spatialState = rng_seed_spatial(fragCoord);
-
-    // DSNU: half-normal offset (always additive)
-    float dsnuOffset = abs(u_dsnuStrength * rand_normal(spatialState));
-
-    // Hot pixel determination
-    bool isHotPixel = (rand_float(spatialState) < u_hotPixelProbability);
-
-    // Total dark current for this pixel
-    float darkContrib = u_darkCurrent + dsnuOffset;
-    if (isHotPixel)
+    // ── Fixed-pattern: DSNU offset + hot pixel (baked maps) ─────────────
+    vec2  mapCoord   = map_coord(fragCoord);
+
+    // Total dark signal for this pixel, accumulated over the exposure
+    float darkContrib = u_darkCurrent;
+#if DARK_DSNU
+    darkContrib += texture(u_dsnuMap, mapCoord).r;
+#endif
+#if DARK_HOT_PIXELS
+    if (texture(u_hotPixelMask, mapCoord).r > 0.5)
         darkContrib += u_hotPixelStrength * u_darkCurrent;
+#endif
+    darkContrib *= u_exposure;
 
     // ── Temporal: Poisson-sample the dark current ───────────────────────
     // Dark current generates electrons randomly each frame
-    uint temporalState = rng_seed_temporal(fragCoord, u_frameNumber + 7919);
+    RngStream temporalState = rng_stream(fragCoord, u_frameNumber, u_darkStream);
+    temporalState.fastNormals = DARK_FAST_NORMALS != 0;
 
     // Add dark current noise to each channel identically
     // (dark current is not wavelength-dependent to first order)
     float darkNoise = float(sample_poisson(darkContrib * 1000.0, temporalState)) / 1000.0;
 
-    vec3 noisy = color + vec3(darkNoise);
-
-    fragColor = vec4(clamp(noisy, 0.0, 1.0), 1.0);
+    return color + vec3(darkNoise);
 }
@@ -0,0 +1,41 @@
+#version 330 core
+// ============================================================================
+//  Demosaic — Bilinear CFA Reconstruction — Chain Stage
+// ============================================================================
+//  Rebuilds RGB from a CFA raw frame (photosite value in .r): each colour
+//  is the mean of the same-colour photosites in the 3x3 neighbourhood,
+//  and the photosite's own colour is kept exact.  Added by the chain after
+//  the effects when demosaicing is on; self-contained, so the chain
+//  prepends noise_utils.glsl (cfa_channel) and the NoiseChainBlock.
+//  Neighbours are clamped to the frame, so in a tiled run (chain region)
+//  the pixels along a tile edge differ from an untiled one.
+// ============================================================================
+
+in  vec2 v_texCoord;
+out vec4 fragColor;
+
+uniform sampler2D u_inputTexture;
+
+void main()
+{
+    vec2  fragCoord = v_texCoord * u_resolution;
+    ivec2 size      = textureSize(u_inputTexture, 0);
+    ivec2 pixel     = clamp(ivec2(fragCoord), ivec2(0), size - 1);
+
+    vec3 sum    = vec3(0.0);
+    vec3 weight = vec3(0.0);
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+        for (int dx = -1; dx <= 1; ++dx)
+        {
+            ivec2 site = clamp(pixel + ivec2(dx, dy), ivec2(0), size - 1);
+            int   c    = cfa_channel(vec2(site) + 0.5 + u_tileOffset);
+            sum[c]    += texelFetch(u_inputTexture, site, 0).r;
+            weight[c] += 1.0;
+        }
+    }
+    vec3 rgb = sum / max(weight, vec3(1.0));
+    rgb[cfa_channel(vec2(pixel) + 0.5 + u_tileOffset)] = texelFetch(u_inputTexture, pixel, 0).r;
+
+    fragColor = vec4(rgb, 1.0);
+}
@@ -2,10 +2,33 @@
 //  noise_utils.glsl — Shared RNG & Sampling Utilities
 // ============================================================================
 //  Prepended to each noise shader at load time by C++.
-//  Provides: PCG hash, uniform/normal random, Poisson sampling,
-//            spatial (fixed-pattern) and temporal seed generators.
+//  Provides: PCG hash and spatial (fixed-pattern) draws, counter-based
+//            temporal streams, uniform/normal random, Poisson sampling.
+//
+//  Temporal draws come from rng_stream(fragCoord, frame, stream): the
+//  chain seed (u_seed, PostProcessChain::setSeed()) and the effect's
+//  stream ID (INoiseEffect::setStreamId()) select the sequence, so nodes
+//  seeded by index (low or high word, see rng_stream()) never repeat each
+//  other's noise and no two effects draw correlated numbers.
+//
+//  POISSON_QUALITY selects the small-lambda (< 30) Poisson sampler:
+//    0  Gaussian approximation everywhere (fastest, biased for tiny lambda)
+//    1  inverse-CDF table lookup, constant cost (default)
+//    2  Knuth multiplication loop, exact but up to 200 iterations
+//
+//  CFA_PATTERN selects the colour filter array (0 = full RGB, 1 = RGGB,
+//  2 = BGGR, 3 = GRBG, 4 = GBRG, naming the top-left 2x2 of the sensor
+//  row by row).  In CFA mode the chain carries one photosite value
+//  in .r and effects sample only that channel.
 // ============================================================================
 
+#ifndef POISSON_QUALITY
+#define POISSON_QUALITY 1
+#endif
+#ifndef CFA_PATTERN
+#define CFA_PATTERN 0
+#endif
+
 // ── PCG Hash ────────────────────────────────────────────────────────────────
 uint pcg_hash(uint input_state)
 {
@@ -14,25 +37,24 @@ uint pcg_hash(uint input_state)
     return (word >> 22u) ^ word;
 }
 
-// ── Seeding ─────────────────────────────────────────────────────────────────
-// Temporal seed: varies per pixel AND per frame (for shot/read noise)
-uint rng_seed_temporal(vec2 fragCoord, int frame)
+// ── Spatial (fixed-pattern) draws ───────────────────────────────────────────
+// Vary per pixel ONLY (PRNU, DSNU).  The calibration maps are baked from
+// the NoiseMath port of these and do not depend on the chain seed: the
+// seed picks a noise realisation, not a different sensor.
+uint rng_seed_spatial(vec2 fragCoord)
 {
     uint x = uint(fragCoord.x);
     uint y = uint(fragCoord.y);
-    uint f = uint(frame);
-    return pcg_hash(x + pcg_hash(y + pcg_hash(f)));
+    return pcg_hash(x * 1664525u + pcg_hash(y * 1013904223u + 374761393u));
 }
 
-// Spatial seed: varies per pixel ONLY (for fixed-pattern noise: PRNU, DSNU)
-uint rng_seed_spatial(vec2 fragCoord)
+// Texture coordinate of fragCoord in the baked maps.  fragCoord is on the
+// sensor; the maps cover only the chain's region of it.
+vec2 map_coord(vec2 fragCoord)
 {
-    uint x = uint(fragCoord.x);
-    uint y = uint(fragCoord.y);
-    return pcg_hash(x * 1664525u + pcg_hash(y * 1013904223u + 374761393u));
+    return (fragCoord - u_tileOffset) / u_resolution;
 }
 
-// ── Random number generators ────────────────────────────────────────────────
 float rand_float(inout uint state)
 {
     state = pcg_hash(state);
@@ -46,8 +68,107 @@ float rand_normal(inout uint state)
     return sqrt(-2.0 * log(u1)) * cos(6.28318530718 * u2);
 }
 
+// ── Counter-based temporal streams ──────────────────────────────────────────
+// pcg4d (Jarzynski & Olano, "Hash Functions for GPU Rendering", 2020): a
+// bijection of uvec4 from 32-bit multiplies only (Philox needs the 64-bit
+// products of umulExtended, GLSL 4.00).  One call yields four words.
+uvec4 pcg4d(uvec4 v)
+{
+    v = v * 1664525u + 1013904223u;
+    v.x += v.y * v.w;  v.y += v.z * v.x;  v.z += v.x * v.y;  v.w += v.y * v.z;
+    v ^= v >> 16u;
+    v.x += v.y * v.w;  v.y += v.z * v.x;  v.z += v.x * v.y;  v.w += v.y * v.z;
+    return v;
+}
+
+// The draws of one effect for one pixel and frame.  Block b of a stream
+// is pcg4d of the counter
+//   (x | y << 16,  frame,  stream << 24 | b,  u_seed.x ^ pcg_hash(u_seed.y))
+// so no two pixels, frames or streams share a block, and neither do two
+// seeds that differ in only one of their words (pcg_hash is a
+// bijection).  Frames up to 65536 pixels per side, 2^24 blocks.
+struct RngStream
+{
+    uvec4 counter;
+    uvec4 block;
+    int   used;          // words of `block` already returned
+    float spare;         // second Box-Muller output, valid if hasSpare
+    bool  hasSpare;
+    bool  fastNormals;   // rand_normal() uses rand_normal_fast()
+};
+
+RngStream rng_stream(vec2 fragCoord, int frame, uint stream)
+{
+    RngStream s;
+    s.counter = uvec4(uint(fragCoord.x) | (uint(fragCoord.y) << 16u),
+                      uint(frame), stream << 24u, u_seed.x ^ pcg_hash(u_seed.y));
+    s.block   = uvec4(0u);
+    s.used    = 4;
+    s.spare       = 0.0;
+    s.hasSpare    = false;
+    s.fastNormals = false;
+    return s;
+}
+
+uint rng_next(inout RngStream s)
+{
+    if (s.used == 4)
+    {
+        s.block      = pcg4d(s.counter);
+        s.counter.z += 1u;
+        s.used       = 0;
+    }
+    return s.block[s.used++];
+}
+
+float rand_float(inout RngStream s)
+{
+    return float(rng_next(s)) / 4294967296.0;
+}
+
+// ── Normal draws ────────────────────────────────────────────────────────────
+// Both outputs of one Box-Muller transform: two independent N(0,1).
+vec2 rand_normal2(inout RngStream s)
+{
+    float u1 = max(rand_float(s), 1e-10);
+    float u2 = rand_float(s);
+    float r  = sqrt(-2.0 * log(u1));
+    float a  = 6.28318530718 * u2;
+    return r * vec2(cos(a), sin(a));
+}
+
+// Approximate N(0,1) without transcendentals: the 16-bit halves of two
+// words as four uniforms, summed (Irwin-Hall) and scaled to unit
+// variance.  Mean and variance are exact; the tails end at +-3.46 sigma
+// and the excess kurtosis is -0.3.
+float rand_normal_fast(inout RngStream s)
+{
+    uint a = rng_next(s);
+    uint b = rng_next(s);
+    float sum = float(a & 0xFFFFu) + float(a >> 16u) + float(b & 0xFFFFu) + float(b >> 16u);
+    return ((sum + 2.0) / 65536.0 - 2.0) * 1.73205080757;
+}
+
+// One N(0,1).  Box-Muller pairs are used up two calls at a time, so
+// every second call costs no transcendentals; effects opt into the fast
+// approximation with s.fastNormals.
+float rand_normal(inout RngStream s)
+{
+    if (s.fastNormals)
+        return rand_normal_fast(s);
+    if (s.hasSpare)
+    {
+        s.hasSpare = false;
+        return s.spare;
+    }
+    vec2 n = rand_normal2(s);
+    s.spare    = n.y;
+    s.hasSpare = true;
+    return n.x;
+}
+
 // ── Poisson Sampling ────────────────────────────────────────────────────────
-int poisson_small(float lambda, inout uint state)
+int poisson_small(float lambda, inout RngStream state)
 {
     float L = exp(-lambda);
     float p = 1.0;
@@ -61,20 +182,74 @@ int poisson_small(float lambda, inout uint state)
     return k;
 }
 
-int poisson_large(float lambda, inout uint state)
+int poisson_large(float lambda, inout RngStream state)
 {
     float result = lambda + sqrt(lambda) * rand_normal(state);
     return max(0, int(round(result)));
 }
 
-int sample_poisson(float lambda, inout uint state)
+#if POISSON_QUALITY == 1
+// Must match PoissonTable.h
+#define POISSON_TABLE_LAMBDA_MAX 30.0
+#define POISSON_TABLE_COLUMNS    128
+#define POISSON_TABLE_ROWS       512
+
+uniform sampler2D u_poissonTable;
+
+int poisson_table(float lambda, inout RngStream state)
+{
+    // Stochastic rounding between neighbouring lambda columns keeps the
+    // mean exact; the row is the inverse-CDF quantile.
+    float t   = lambda * (float(POISSON_TABLE_COLUMNS - 1) / POISSON_TABLE_LAMBDA_MAX);
+    int   col = int(t) + int(rand_float(state) < fract(t));
+    int   row = min(int(rand_float(state) * float(POISSON_TABLE_ROWS)), POISSON_TABLE_ROWS - 1);
+    return int(texelFetch(u_poissonTable, ivec2(col, row), 0).r * 255.0 + 0.5);
+}
+#endif
+
+int sample_poisson(float lambda, inout RngStream state)
 {
     if (lambda < 0.001)
         return 0;
+#if POISSON_QUALITY == 0
+    return poisson_large(lambda, state);
+#else
     else if (lambda < 30.0)
+#if POISSON_QUALITY == 1
+        return poisson_table(lambda, state);
+#else
         return poisson_small(lambda, state);
+#endif
     else
         return poisson_large(lambda, state);
+#endif
+}
+
+// ── Colour filter array ─────────────────────────────────────────────────────
+#if CFA_PATTERN
+// Colour (0 = R, 1 = G, 2 = B) of the photosite at fragCoord.  Rows are
+// counted from the top of the sensor, as it is written to disk.
+int cfa_channel(vec2 fragCoord)
+{
+    int x = int(fragCoord.x) & 1;
+    int y = (int(u_sensorSize.y) - 1 - int(fragCoord.y)) & 1;
+    int site = y * 2 + x;   // 0 top-left, 1 top-right, 2 bottom-left, 3 bottom-right
+#if CFA_PATTERN == 1
+    return site == 0 ? 0 : site == 3 ? 2 : 1;
+#elif CFA_PATTERN == 2
+    return site == 0 ? 2 : site == 3 ? 0 : 1;
+#elif CFA_PATTERN == 3
+    return site == 1 ? 0 : site == 2 ? 2 : 1;
+#else
+    return site == 1 ? 2 : site == 2 ? 0 : 1;
+#endif
+}
+
+// The value the photosite at fragCoord records from a full-colour signal.
+float cfa_sample(vec3 color, vec2 fragCoord)
+{
+    return color[cfa_channel(fragCoord)];
 }
+#endif
 
 // ── End noise_utils.glsl ────────────────────────────────────────────────────
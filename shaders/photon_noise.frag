@@ -2,29 +2,54 @@
 // ============================================================================
 //  Photon (Shot) Noise — Modular Effect
 // ============================================================================
-//  Applies Poisson-distributed shot noise per channel.
-//  Expects noise_utils.glsl to be prepended.
+//  Applies Poisson-distributed shot noise per channel.  The expected
+//  photon count scales with the chain's relative exposure (u_exposure).
+//  Expects the chain preamble and noise_utils.glsl to be prepended; the
+//  chain generates main() around apply_photon_noise().
+//  Feature keys (PhotonNoiseEffect::getFeatureKeys()):
+//    PHOTON_GAUSSIAN      Gaussian approximation only, as POISSON_QUALITY 0
+//                         (photon scales where lambda < 30 is below one code)
+//    PHOTON_FAST_NORMALS  rand_normal_fast() for the Gaussian approximation
+//                         (large lambda, or POISSON_QUALITY 0)
 // ============================================================================
 
-in  vec2 v_texCoord;
-out vec4 fragColor;
+#ifndef PHOTON_GAUSSIAN
+#define PHOTON_GAUSSIAN 0
+#endif
+#ifndef PHOTON_FAST_NORMALS
+#define PHOTON_FAST_NORMALS 0
+#endif
 
-uniform sampler2D u_inputTexture;
 uniform float     u_photonScale;
-uniform int       u_frameNumber;
-uniform vec2      u_resolution;
+uniform uint      u_photonStream;    // RNG stream ID
 
-void main()
+int photon_count(float lambda, inout RngStream state)
 {
-    vec2 fragCoord = v_texCoord * u_resolution;
-    vec3 color = max(texture(u_inputTexture, v_texCoord).rgb, vec3(0.0));
+#if PHOTON_GAUSSIAN
+    return lambda < 0.001 ? 0 : poisson_large(lambda, state);
+#else
+    return sample_poisson(lambda, state);
+#endif
+}
+
+vec3 apply_photon_noise(vec3 color, vec2 fragCoord)
+{
+    color = max(color, vec3(0.0));
+
+    RngStream state = rng_stream(fragCoord, u_frameNumber, u_photonStream);
+    state.fastNormals = PHOTON_FAST_NORMALS != 0;
 
-    uint state = rng_seed_temporal(fragCoord, u_frameNumber);
+    float photons = u_photonScale * u_exposure;
 
     vec3 noisy;
-    noisy.r = float(sample_poisson(color.r * u_photonScale, state)) / u_photonScale;
-    noisy.g = float(sample_poisson(color.g * u_photonScale, state)) / u_photonScale;
-    noisy.b = float(sample_poisson(color.b * u_photonScale, state)) / u_photonScale;
+#if CFA_PATTERN
+    // One photosite, one sample
+    noisy = vec3(float(photon_count(color.r * photons, state)) / u_photonScale, 0.0, 0.0);
+#else
+    noisy.r = float(photon_count(color.r * photons, state)) / u_photonScale;
+    noisy.g = float(photon_count(color.g * photons, state)) / u_photonScale;
+    noisy.b = float(photon_count(color.b * photons, state)) / u_photonScale;
+#endif
 
-    fragColor = vec4(clamp(noisy, 0.0, 1.0), 1.0);
+    return noisy;
 }
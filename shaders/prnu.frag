@@ -3,31 +3,19 @@
 //  PRNU — Photo-Response Non-Uniformity — Modular Effect
 // ============================================================================
 //  Each pixel has a slightly different quantum efficiency (gain).
-//  This is a multiplicative, fixed-pattern effect.
-//  Expects noise_utils.glsl to be prepended.
+//  This is a multiplicative, fixed-pattern effect.  The gain map is baked
+//  on the CPU (FixedPatternMaps) and only fetched here.
+//  Expects the chain preamble and noise_utils.glsl to be prepended; the
+//  chain generates main() around apply_prnu().
 // ============================================================================
 
-in  vec2 v_texCoord;
-out vec4 fragColor;
+uniform sampler2D u_prnuGainMap;     // per-pixel gain ~ N(1, sigma), R16F
 
-uniform sampler2D u_inputTexture;
-uniform float     u_prnuStrength;    // PRNU sigma (fraction, e.g. 0.01 = 1%)
-uniform vec2      u_resolution;
-
-void main()
+vec3 apply_prnu(vec3 color, vec2 fragCoord)
 {
-    vec2 fragCoord = v_texCoord * u_resolution;
-    vec3 color = texture(u_inputTexture, v_texCoord).rgb;
-
-    // Spatial-only seed — gain map is fixed across frames
-    uint spatialState = rng_seed_spatial(fragCoord);
-
-    // Per-pixel gain: ~ N(1, sigma)
-    float gain = 1.0 + u_prnuStrength * rand_normal(spatialState);
+    float gain = texture(u_prnuGainMap, map_coord(fragCoord)).r;
 
     // Apply multiplicative gain (same gain for all channels on a given pixel,
     // since PRNU is primarily a per-photosite effect)
-    vec3 modulated = color * gain;
-
-    fragColor = vec4(clamp(modulated, 0.0, 1.0), 1.0);
+    return color * gain;
 }
@@ -4,30 +4,35 @@
 // ============================================================================
 //  Additive, signal-independent Gaussian noise from the sensor's ADC
 //  and readout electronics.
-//  Expects noise_utils.glsl to be prepended.
+//  Expects the chain preamble and noise_utils.glsl to be prepended; the
+//  chain generates main() around apply_read_noise().
+//  Feature keys (ReadNoiseEffect::getFeatureKeys()):
+//    READ_FAST_NORMALS  rand_normal_fast() instead of Box-Muller
 // ============================================================================
 
-in  vec2 v_texCoord;
-out vec4 fragColor;
+#ifndef READ_FAST_NORMALS
+#define READ_FAST_NORMALS 0
+#endif
 
-uniform sampler2D u_inputTexture;
 uniform float     u_readNoise;       // read noise sigma (normalised)
-uniform int       u_frameNumber;
-uniform vec2      u_resolution;
+uniform uint      u_readStream;      // RNG stream ID
 
-void main()
+vec3 apply_read_noise(vec3 color, vec2 fragCoord)
 {
-    vec2 fragCoord = v_texCoord * u_resolution;
-    vec3 color = texture(u_inputTexture, v_texCoord).rgb;
+    // Own stream: independent of the other temporal noise
+    RngStream state = rng_stream(fragCoord, u_frameNumber, u_readStream);
+    state.fastNormals = READ_FAST_NORMALS != 0;
 
-    // Use a different frame offset to decorrelate from other temporal noise
-    uint state = rng_seed_temporal(fragCoord, u_frameNumber + 15731);
-
-    // Independent Gaussian noise per channel
+    // Independent Gaussian noise per channel (per photosite in CFA mode);
+    // r and g share one Box-Muller pair
     vec3 noise;
+#if CFA_PATTERN
+    noise = vec3(u_readNoise * rand_normal(state), 0.0, 0.0);
+#else
     noise.r = u_readNoise * rand_normal(state);
     noise.g = u_readNoise * rand_normal(state);
     noise.b = u_readNoise * rand_normal(state);
+#endif
 
-    fragColor = vec4(clamp(color + noise, 0.0, 1.0), 1.0);
+    return color + noise;
 }
@@ -0,0 +1,87 @@
+#pragma once
+// ============================================================================
+//  AccumulationEffect — Temporal integration of sub-frames into exposures
+// ============================================================================
+//  Sits between the per-sub-frame stages (scene, PRNU, dark and photon
+//  noise) and the per-readout ones (read noise, ADC).  Every sub-frame is
+//  merged into a float history on the GPU; the chain runs the stages after
+//  this one only when the last of the N sub-frames has been merged, so
+//  readout noise and quantisation are applied once per exposure and the
+//  offscreen output is written once every N frames.
+//
+//  The output is the integrated exposure: the (decay-weighted) sum of the
+//  sub-frames, N times the level of one sub-frame for a box window.  Shot
+//  noise variance grows with N and read noise is added once, so SNR in
+//  the read-noise-limited regime improves with N as on a real sensor.
+//  Scale the exposure by 1/N to keep the output level of one sub-frame.
+// ============================================================================
+
+#include "INoiseEffect.h"
+#include "ProgramCache.h"
+#include <osg/Uniform>
+#include <algorithm>
+
+class AccumulationEffect : public INoiseEffect
+{
+public:
+    enum class Window
+    {
+        Box,          ///< every sub-frame weighted equally
+        Exponential   ///< each sub-frame weighted `decay` times the next one
+    };
+
+    AccumulationEffect(const std::string& shaderDir = "shaders",
+                       unsigned int subFrames = 4, Window window = Window::Box,
+                       float decay = 0.8f)
+        : m_shaderDir(shaderDir), m_subFrames(std::max(1u, subFrames)),
+          m_window(window), m_decay(std::clamp(decay, 0.01f, 1.f))
+    {
+        m_uHistory = new osg::Uniform("u_historyTexture", static_cast<int>(HISTORY_UNIT));
+        m_uWeight  = new osg::Uniform("u_historyWeight", 0.0f);
+    }
+
+    std::string getName() const override { return "Accumulation"; }
+
+    std::string getFragmentSource() const override
+    {
+        return ProgramCache::instance().source(m_shaderDir + "/accumulation.frag");
+    }
+
+    void setupUniforms(osg::StateSet* ss) override
+    {
+        ss->addUniform(m_uHistory);
+        ss->addUniform(m_uWeight);
+    }
+
+    bool         isTemporal() const override   { return true; }
+    unsigned int getSubFrames() const override { return m_subFrames; }
+
+    /// Weight of the history in sub-frame `index`: sum_i = w * sum_{i-1}
+    /// + in_i, with w = 0 restarting the exposure, 1 for a box window and
+    /// `decay` for an exponential one.
+    void beginSubFrame(unsigned int index) override
+    {
+        float weight = m_window == Window::Exponential ? m_decay : 1.0f;
+        if (index == 0)
+            weight = 0.0f;
+        m_uWeight->set(weight);
+    }
+
+    // ── Parameter access ────────────────────────────────────────────────
+    /// Sub-frames per exposure.  Takes effect at the next exposure.
+    void         setSubFrames(unsigned int n) { m_subFrames = std::max(1u, n); }
+
+    void   setWindow(Window w)  { m_window = w; }
+    Window getWindow() const    { return m_window; }
+
+    void  setDecay(float d)     { m_decay = std::clamp(d, 0.01f, 1.f); }
+    float getDecay() const      { return m_decay; }
+
+private:
+    std::string  m_shaderDir;
+    unsigned int m_subFrames;
+    Window       m_window;
+    float        m_decay;
+    osg::ref_ptr<osg::Uniform> m_uHistory;
+    osg::ref_ptr<osg::Uniform> m_uWeight;
+};
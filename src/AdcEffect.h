@@ -0,0 +1,69 @@
+#pragma once
+// ============================================================================
+//  AdcEffect — Gain, black level and N-bit quantisation module
+// ============================================================================
+//  Last stage of the sensor model.  With a float signal path the chain
+//  carries the unclipped linear signal between effects and this is the one
+//  place it is clipped and quantised.
+// ============================================================================
+
+#include "INoiseEffect.h"
+#include "ProgramCache.h"
+#include "CpuKernels.h"
+#include <osg/Uniform>
+#include <algorithm>
+
+class AdcEffect : public INoiseEffect
+{
+public:
+    AdcEffect(const std::string& shaderDir = "shaders",
+              int bits = 12, float gain = 1.0f, float blackLevel = 0.0f)
+        : m_shaderDir(shaderDir), m_bits(bits), m_gain(gain), m_blackLevel(blackLevel)
+    {
+        m_uBits       = new osg::Uniform("u_adcBits", m_bits);
+        m_uGain       = new osg::Uniform("u_adcGain", m_gain);
+        m_uBlackLevel = new osg::Uniform("u_blackLevel", m_blackLevel);
+    }
+
+    std::string getName() const override { return "ADC"; }
+
+    std::string getFragmentSource() const override
+    {
+        return ProgramCache::instance().source(m_shaderDir + "/adc.frag");
+    }
+
+    std::string getApplyFunction() const override { return "apply_adc"; }
+
+    void setupUniforms(osg::StateSet* ss) override
+    {
+        ss->addUniform(m_uBits);
+        ss->addUniform(m_uGain);
+        ss->addUniform(m_uBlackLevel);
+    }
+
+    bool prepareCpu(unsigned int, unsigned int) override { return true; }
+    void processCpu(const CpuKernels::Tile& tile) const override
+    {
+        CpuKernels::adc(tile, m_bits, m_gain, m_blackLevel);
+    }
+
+    // ADC has no temporal component — no update callback needed.
+
+    // ── Parameter access ────────────────────────────────────────────────
+    void  setBits(int b)             { setIfChanged(m_uBits.get(), m_bits, std::clamp(b, 1, 16)); }
+    int   getBits() const            { return m_bits; }
+
+    void  setGain(float g)           { setIfChanged(m_uGain.get(), m_gain, std::max(0.f, g)); }
+    float getGain() const            { return m_gain; }
+
+    void  setBlackLevel(float v)     { setIfChanged(m_uBlackLevel.get(), m_blackLevel, std::clamp(v, 0.f, 1.f)); }
+    float getBlackLevel() const      { return m_blackLevel; }
+
+private:
+    std::string m_shaderDir;
+    int   m_bits;
+    float m_gain, m_blackLevel;
+    osg::ref_ptr<osg::Uniform> m_uBits;
+    osg::ref_ptr<osg::Uniform> m_uGain;
+    osg::ref_ptr<osg::Uniform> m_uBlackLevel;
+};
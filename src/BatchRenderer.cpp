@@ -0,0 +1,595 @@
+#include "BatchRenderer.h"
+#include "PboUpload.h"
+#include "CpuNoiseChain.h"
+#include "CpuKernels.h"
+
+#include <osg/Image>
+#include <osgDB/FileUtils>
+#include <osgGA/TrackballManipulator>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <iostream>
+
+// ============================================================================
+BatchRenderer::BatchRenderer(SensorNoiseSimulator& simulator, const Options& options)
+    : m_sim(simulator), m_options(options)
+{
+}
+
+// ============================================================================
+osg::ref_ptr<osg::GraphicsContext> BatchRenderer::createPbufferContext(unsigned int width,
+                                                                      unsigned int height) const
+{
+    osg::ref_ptr<osg::GraphicsContext::Traits> traits = new osg::GraphicsContext::Traits;
+    traits->x = 0;
+    traits->y = 0;
+    traits->width  = width;
+    traits->height = height;
+    traits->windowDecoration = false;
+    traits->doubleBuffer = false;
+    traits->pbuffer = true;
+    traits->alpha = 8;
+
+    osg::ref_ptr<osg::GraphicsContext> gc =
+        osg::GraphicsContext::createGraphicsContext(traits.get());
+    if (!gc || !gc->valid())
+        return nullptr;
+    return gc;
+}
+
+// ============================================================================
+bool BatchRenderer::setUp(osgViewer::Viewer& viewer, osg::Group* root, PostProcessChain& chain,
+                          unsigned int width, unsigned int height)
+{
+    osg::ref_ptr<osg::GraphicsContext> gc = createPbufferContext(width, height);
+    if (!gc)
+    {
+        std::cerr << "[BatchRenderer] ERROR: Could not create pbuffer context.\n";
+        return false;
+    }
+
+    if (!osgDB::makeDirectory(m_options.outputDir))
+    {
+        std::cerr << "[BatchRenderer] ERROR: Cannot create output directory: "
+                  << m_options.outputDir << "\n";
+        return false;
+    }
+
+    m_writers.reset(new FrameWriterPool(m_options.extension,
+                                        m_options.writerThreads,
+                                        m_options.writerQueue));
+
+    if (!attachReadback(chain, width, height))
+        return false;
+
+    if (chain.getGpuTimer() && !m_options.timingCsv.empty())
+        chain.getGpuTimer()->openCsv(m_options.timingCsv);
+
+    // ── Viewer on the pbuffer ───────────────────────────────────────────
+    viewer.setThreadingModel(osgViewer::Viewer::SingleThreaded);
+    viewer.getCamera()->setGraphicsContext(gc);
+    viewer.getCamera()->setViewport(new osg::Viewport(0, 0, width, height));
+    viewer.getCamera()->setProjectionMatrixAsPerspective(
+        30.0, double(width) / double(height), 1.0, 1000.0);
+    viewer.getCamera()->setDrawBuffer(GL_FRONT);
+    viewer.getCamera()->setReadBuffer(GL_FRONT);
+    viewer.setSceneData(root);
+    viewer.realize();
+    return true;
+}
+
+// ============================================================================
+bool BatchRenderer::attachReadback(PostProcessChain& chain, unsigned int width, unsigned int height)
+{
+    if (!chain.getOutputCamera())
+    {
+        std::cerr << "[BatchRenderer] ERROR: Chain has no passes.\n";
+        return false;
+    }
+
+    // Layered: each render yields getBuiltLayerCount() output frames.
+    // Temporal: only every getSubFramesPerOutput()-th render yields one.
+    m_layers = chain.getBuiltLayerCount();
+    m_subFrames = chain.getSubFramesPerOutput();
+    osg::Texture* target = m_layers > 1
+        ? static_cast<osg::Texture*>(chain.getOutputTextureArray())
+        : chain.getOutputTexture();
+
+    osg::ref_ptr<PboReadback> readback = new PboReadback(
+        target, width, height,
+        [this](ReadbackFrame&& frame) { onFrameReadBack(std::move(frame)); },
+        m_options.pboRingSize, chain.getOutputPixelFormat(), chain.getOutputDataType());
+    chain.getOutputCamera()->setFinalDrawCallback(readback);
+    return true;
+}
+
+// ============================================================================
+void BatchRenderer::flushReadback(osgViewer::Viewer& viewer, PostProcessChain& chain)
+{
+    auto* readback = dynamic_cast<PboReadback*>(chain.getOutputCamera()->getFinalDrawCallback());
+    osg::GraphicsContext* gc = viewer.getCamera()->getGraphicsContext();
+    if (!readback || !gc || !gc->makeCurrent())
+        return;
+    readback->flush(*gc->getState());
+    gc->releaseContext();
+}
+
+// ============================================================================
+int BatchRenderer::run(const std::vector<osg::ref_ptr<osg::Node>>& scenes)
+{
+    if (m_options.tileSize > 0 &&
+        (m_options.tileSize < m_options.width || m_options.tileSize < m_options.height))
+        return runTiled(scenes);
+
+    // ── Build chain with an offscreen final target ──────────────────────
+    // Scenes are swapped under one slot group so the chain is built once.
+    PostProcessChain& chain = m_sim.chain();
+    chain.setOffscreenOutput(true);
+    chain.setLayerCount(m_options.layers);
+
+    osg::ref_ptr<osg::Group> sceneSlot = new osg::Group;
+    osg::ref_ptr<osg::Group> root = m_sim.apply(sceneSlot);
+
+    osgViewer::Viewer viewer;
+    if (!setUp(viewer, root, chain, m_options.width, m_options.height))
+        return 1;
+    viewer.setCameraManipulator(new osgGA::TrackballManipulator);
+
+    // ── Render ──────────────────────────────────────────────────────────
+    const osg::Timer_t start = osg::Timer::instance()->tick();
+    unsigned int totalWritten = 0;
+    m_sequence = false;
+    m_tiled = false;
+    m_frameLimit = m_options.frames;
+
+    for (unsigned int s = 0; s < scenes.size(); ++s)
+    {
+        sceneSlot->removeChildren(0, sceneSlot->getNumChildren());
+        sceneSlot->addChild(scenes[s]);
+        viewer.getCameraManipulator()->setNode(scenes[s]);
+        viewer.getCameraManipulator()->home(0.0);
+
+        // Readback lags by ringSize-1 frames: render the scene's frames,
+        // then flush the ring before the next scene.  Every scene starts
+        // a fresh exposure.
+        m_sceneIndex = s;
+        m_framesQueued = 0;
+        m_firstFrame = viewer.getFrameStamp()->getFrameNumber() + 1;
+        chain.restartExposure();
+        const unsigned int renders = (m_options.frames + m_layers - 1) / m_layers * m_subFrames;
+
+        for (unsigned int i = 0; i < renders; ++i)
+            viewer.frame();
+        flushReadback(viewer, chain);
+
+        if (m_framesQueued < m_options.frames)
+        {
+            std::cerr << "[BatchRenderer] ERROR: Only " << m_framesQueued << " of "
+                      << m_options.frames << " frames read back for scene " << s << ".\n";
+            m_writers->finish();
+            return 1;
+        }
+        totalWritten += m_framesQueued;
+    }
+
+    return finish(totalWritten, start);
+}
+
+// ============================================================================
+int BatchRenderer::runTiled(const std::vector<osg::ref_ptr<osg::Node>>& scenes)
+{
+    const unsigned int sensorW = m_options.width;
+    const unsigned int sensorH = m_options.height;
+    const unsigned int tileW   = std::min(m_options.tileSize, sensorW);
+    const unsigned int tileH   = std::min(m_options.tileSize, sensorH);
+    const unsigned int cols    = (sensorW + tileW - 1) / tileW;
+    const unsigned int rows    = (sensorH + tileH - 1) / tileH;
+
+    // ── Chain one tile large, placed on the sensor per tile ─────────────
+    PostProcessChain& chain = m_sim.chain();
+    chain.setOffscreenOutput(true);
+    chain.setLayerCount(m_options.layers);
+    chain.resize(tileW, tileH);
+    chain.setRegion(0, 0, sensorW, sensorH);
+
+    osg::ref_ptr<osg::Group> sceneSlot = new osg::Group;
+    osg::ref_ptr<osg::Group> root = m_sim.apply(sceneSlot);
+
+    osgViewer::Viewer viewer;
+    if (!setUp(viewer, root, chain, tileW, tileH))
+        return 1;
+    viewer.setCameraManipulator(new osgGA::TrackballManipulator);
+
+    // The camera frustum of the whole sensor; each tile renders its window
+    double left, right, bottom, top, zNear, zFar;
+    osg::Matrixd::perspective(30.0, double(sensorW) / double(sensorH), 1.0, 1000.0)
+        .getFrustum(left, right, bottom, top, zNear, zFar);
+
+    std::cout << "[BatchRenderer] " << sensorW << "x" << sensorH << " sensor in "
+              << cols * rows << " tiles of " << tileW << "x" << tileH << "\n";
+
+    // ── Render ──────────────────────────────────────────────────────────
+    const osg::Timer_t start = osg::Timer::instance()->tick();
+    unsigned int totalWritten = 0;
+    m_sequence = false;
+    m_tiled = true;
+    m_frameLimit = m_options.frames;
+    const unsigned int renders = (m_options.frames + m_layers - 1) / m_layers * m_subFrames;
+
+    for (unsigned int row = 0; row < rows; ++row)
+    {
+        for (unsigned int col = 0; col < cols; ++col)
+        {
+            // GL rows count from the bottom, file rows from the top
+            const unsigned int x = std::min(col * tileW, sensorW - tileW);
+            const unsigned int y = std::min(row * tileH, sensorH - tileH);
+            chain.setRegion(x, y, sensorW, sensorH);
+            viewer.getCamera()->setProjectionMatrixAsFrustum(
+                left   + (right - left) * x / sensorW,
+                left   + (right - left) * (x + tileW) / sensorW,
+                bottom + (top - bottom) * y / sensorH,
+                bottom + (top - bottom) * (y + tileH) / sensorH,
+                zNear, zFar);
+            m_tileX = x;
+            m_tileY = sensorH - tileH - y;
+
+            for (unsigned int s = 0; s < scenes.size(); ++s)
+            {
+                sceneSlot->removeChildren(0, sceneSlot->getNumChildren());
+                sceneSlot->addChild(scenes[s]);
+                viewer.getCameraManipulator()->setNode(scenes[s]);
+                viewer.getCameraManipulator()->home(0.0);
+
+                // As in run(), plus the same frame numbers for every tile
+                // of a scene so their temporal noise belongs to one frame
+                m_sceneIndex = s;
+                m_framesQueued = 0;
+                m_firstFrame = viewer.getFrameStamp()->getFrameNumber() + 1;
+                chain.restartExposure();
+                chain.setFrameNumber(static_cast<std::int32_t>(s * renders));
+
+                for (unsigned int i = 0; i < renders; ++i)
+                    viewer.frame();
+                flushReadback(viewer, chain);
+
+                if (m_framesQueued < m_options.frames)
+                {
+                    std::cerr << "[BatchRenderer] ERROR: Only " << m_framesQueued << " of "
+                              << m_options.frames << " frames read back for scene " << s
+                              << ", tile " << x << "," << m_tileY << ".\n";
+                    m_writers->finish();
+                    return 1;
+                }
+                totalWritten += m_framesQueued;
+            }
+        }
+    }
+
+    return finish(totalWritten, start);
+}
+
+// ============================================================================
+int BatchRenderer::runProfiles(const std::vector<SensorProfile>& profiles,
+                               const std::vector<osg::ref_ptr<osg::Node>>& scenes,
+                               const SensorProfileCache::Configure& configure)
+{
+    if (profiles.empty())
+        return run(scenes);
+    if (m_options.tileSize > 0 &&
+        (m_options.tileSize < m_options.width || m_options.tileSize < m_options.height))
+        std::cerr << "[BatchRenderer] WARNING: Tiles need a single profile; rendering untiled.\n";
+
+    // ── Every pipeline built before the first frame compiles them ───────
+    const unsigned int layers = m_options.layers;
+    SensorProfileCache cache(m_options.width, m_options.height, m_sim.getShaderDir(),
+        [&configure, layers](SensorNoiseSimulator& sim)
+        {
+            if (configure)
+                configure(sim);
+            sim.chain().setOffscreenOutput(true);
+            sim.chain().setLayerCount(layers);
+        });
+    for (const SensorProfile& profile : profiles)
+        cache.prepare(profile);
+    std::cout << "[BatchRenderer] " << profiles.size() << " profiles on "
+              << cache.getNumChains() << " chains\n";
+
+    PostProcessChain& first = cache.select(profiles.front()).chain();
+    osgViewer::Viewer viewer;
+    if (!setUp(viewer, cache.getRoot(), first, m_options.width, m_options.height))
+        return 1;
+    viewer.setCameraManipulator(new osgGA::TrackballManipulator);
+
+    std::vector<PostProcessChain*> attached = { &first };
+    for (const SensorProfile& profile : profiles)
+    {
+        PostProcessChain& chain = cache.prepare(profile).chain();
+        if (std::find(attached.begin(), attached.end(), &chain) != attached.end())
+            continue;
+        if (!attachReadback(chain, m_options.width, m_options.height))
+            return 1;
+        attached.push_back(&chain);
+    }
+
+    // ── Render every scene per profile ──────────────────────────────────
+    const osg::Timer_t start = osg::Timer::instance()->tick();
+    unsigned int totalWritten = 0;
+    m_sequence = false;
+    m_tiled = false;
+    m_frameLimit = m_options.frames;
+
+    for (const SensorProfile& profile : profiles)
+    {
+        // Each profile writes into its own subdirectory
+        m_subDir = "/" + profile.name;
+        if (!osgDB::makeDirectory(m_options.outputDir + m_subDir))
+        {
+            std::cerr << "[BatchRenderer] ERROR: Cannot create output directory: "
+                      << m_options.outputDir + m_subDir << "\n";
+            m_writers->finish();
+            return 1;
+        }
+
+        const osg::Timer_t switchStart = osg::Timer::instance()->tick();
+        PostProcessChain& chain = cache.select(profile).chain();
+        std::cout << "[BatchRenderer] Profile '" << profile.name << "': switched in "
+                  << osg::Timer::instance()->delta_m(switchStart, osg::Timer::instance()->tick())
+                  << " ms\n";
+        m_layers = chain.getBuiltLayerCount();
+        m_subFrames = chain.getSubFramesPerOutput();
+        const unsigned int renders = (m_options.frames + m_layers - 1) / m_layers * m_subFrames;
+
+        osg::Group* sceneSlot = cache.getSceneSlot();
+        for (unsigned int s = 0; s < scenes.size(); ++s)
+        {
+            sceneSlot->removeChildren(0, sceneSlot->getNumChildren());
+            sceneSlot->addChild(scenes[s]);
+            viewer.getCameraManipulator()->setNode(scenes[s]);
+            viewer.getCameraManipulator()->home(0.0);
+
+            // As in run(): each chain's ring is flushed before the next
+            // scene or profile
+            m_sceneIndex = s;
+            m_framesQueued = 0;
+            m_firstFrame = viewer.getFrameStamp()->getFrameNumber() + 1;
+            chain.restartExposure();
+
+            for (unsigned int i = 0; i < renders; ++i)
+                viewer.frame();
+            flushReadback(viewer, chain);
+
+            if (m_framesQueued < m_options.frames)
+            {
+                std::cerr << "[BatchRenderer] ERROR: Only " << m_framesQueued << " of "
+                          << m_options.frames << " frames read back for scene " << s
+                          << ", profile '" << profile.name << "'.\n";
+                m_writers->finish();
+                return 1;
+            }
+            totalWritten += m_framesQueued;
+        }
+    }
+    m_subDir.clear();
+
+    return finish(totalWritten, start);
+}
+
+// ============================================================================
+int BatchRenderer::runSequence(SequenceReader& reader)
+{
+    if (reader.getWidth() == 0)
+    {
+        std::cerr << "[BatchRenderer] ERROR: Sequence reader not started.\n";
+        return 1;
+    }
+
+    // ── Chain at the sequence's size, fed from the upload ───────────────
+    m_options.width  = reader.getWidth();
+    m_options.height = reader.getHeight();
+    PostProcessChain& chain = m_sim.chain();
+    chain.setOffscreenOutput(true);
+    chain.setLayerCount(m_options.layers);
+    chain.resize(m_options.width, m_options.height);
+
+    osg::ref_ptr<osg::Texture2D> input = RenderTargetPool::createTexture(
+        m_options.width, m_options.height, PboUpload::internalFormatFor(reader.getDataType()));
+
+    // Blocking source: every render consumes exactly one decoded frame
+    osg::ref_ptr<PboUpload> upload = new PboUpload(
+        input, m_options.width, m_options.height,
+        [&reader](osg::ref_ptr<osg::Image>& image)
+        {
+            SequenceReader::Frame frame;
+            if (!reader.next(frame, true))
+                return false;
+            image = frame.image;
+            return true;
+        },
+        reader.getPixelFormat(), reader.getDataType());
+
+    osg::ref_ptr<osg::Group> root = m_sim.applyToTexture(input);
+    root->addChild(PboUpload::createCamera(upload));
+
+    osgViewer::Viewer viewer;
+    if (!setUp(viewer, root, chain, m_options.width, m_options.height))
+        return 1;
+
+    // ── Render until the decoder runs dry, then flush the readback ──────
+    // Render i shows decoded frame i, so frame numbers map straight to
+    // output indices; the limit is known once the last frame is in.
+    const osg::Timer_t start = osg::Timer::instance()->tick();
+    m_sequence = true;
+    m_tiled = false;
+    m_sceneIndex = 0;
+    m_framesQueued = 0;
+    m_frameLimit = UINT_MAX;
+    m_firstFrame = viewer.getFrameStamp()->getFrameNumber() + 1;
+    chain.restartExposure();
+
+    do
+        viewer.frame();
+    while (!reader.isExhausted());
+    const unsigned int limit = upload->getNumUploaded() / m_subFrames * m_layers;
+    m_frameLimit = limit;
+    flushReadback(viewer, chain);
+    reader.stop();
+
+    if (m_framesQueued < limit)
+    {
+        std::cerr << "[BatchRenderer] ERROR: Only " << m_framesQueued << " of "
+                  << limit << " frames read back.\n";
+        m_writers->finish();
+        return 1;
+    }
+    if (reader.getNumFailed() > 0)
+        std::cerr << "[BatchRenderer] WARNING: " << reader.getNumFailed()
+                  << " input frames could not be used.\n";
+
+    const int status = finish(m_framesQueued, start);
+    return reader.getNumFailed() == 0 ? status : 1;
+}
+
+// ============================================================================
+int BatchRenderer::runSequenceCpu(SequenceReader& reader, unsigned int threads)
+{
+    if (reader.getWidth() == 0)
+    {
+        std::cerr << "[BatchRenderer] ERROR: Sequence reader not started.\n";
+        return 1;
+    }
+    if (!osgDB::makeDirectory(m_options.outputDir))
+    {
+        std::cerr << "[BatchRenderer] ERROR: Cannot create output directory: "
+                  << m_options.outputDir << "\n";
+        return 1;
+    }
+    m_writers.reset(new FrameWriterPool(m_options.extension,
+                                        m_options.writerThreads,
+                                        m_options.writerQueue));
+
+    // Same output as the GPU chain: raw in CFA mode, its pixel type, and
+    // layered frame numbers frame * layers + layer
+    PostProcessChain& chain = m_sim.chain();
+    CpuNoiseChain cpu(threads);
+    const bool   raw    = chain.getCfaPattern() != PostProcessChain::CfaPattern::None;
+    const GLenum type   = chain.getOutputDataType();
+    const unsigned int layers = std::max(1u, m_options.layers);
+    std::cout << "[BatchRenderer] CPU reference: " << cpu.getNumThreads() << " threads, "
+              << CpuKernels::simdName() << " kernels\n";
+
+    const osg::Timer_t start = osg::Timer::instance()->tick();
+    CpuNoiseChain::Planes input, planes;
+    SequenceReader::Frame frame;
+    unsigned int frames = 0, written = 0;
+    bool ok = true;
+    while (ok && reader.next(frame, true))
+    {
+        ok = CpuNoiseChain::fromImage(frame.image.get(), input);
+        for (unsigned int k = 0; k < layers && ok; ++k)
+        {
+            const unsigned int index = frames * layers + k;
+            planes = input;
+            ok = cpu.process(chain, planes, static_cast<int>(index));
+            if (!ok)
+                break;
+
+            osg::ref_ptr<osg::Image> image = CpuNoiseChain::toImage(planes, raw, type);
+            ReadbackFrame out;
+            out.frameNumber = index;
+            out.width  = planes.width;
+            out.height = planes.height;
+            out.format = image->getPixelFormat();
+            out.type   = type;
+            out.data.assign(image->data(), image->data() + image->getTotalSizeInBytes());
+
+            char name[32];
+            std::snprintf(name, sizeof(name), "/frame%06u", index);
+            m_writers->submit(std::move(out), m_options.outputDir + name);
+            ++written;
+        }
+        ++frames;
+    }
+    reader.stop();
+
+    if (!ok)
+    {
+        m_writers->finish();
+        return 1;
+    }
+    if (reader.getNumFailed() > 0)
+        std::cerr << "[BatchRenderer] WARNING: " << reader.getNumFailed()
+                  << " input frames could not be used.\n";
+
+    const int status = finish(written, start);
+    return reader.getNumFailed() == 0 ? status : 1;
+}
+
+// ============================================================================
+int BatchRenderer::finish(unsigned int totalWritten, osg::Timer_t start)
+{
+    PostProcessChain& chain = m_sim.chain();
+    const double renderSeconds = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+    m_writers->finish();
+    const double seconds = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+
+    std::cout << "[BatchRenderer] Rendered " << totalWritten << " frames in "
+              << renderSeconds << " s, written after " << seconds << " s ("
+              << (seconds > 0.0 ? totalWritten / seconds : 0.0) << " fps)\n";
+    m_writers->printStats(std::cout, seconds);
+
+    for (auto& t : chain.getPassTimings())
+        std::cout << "[BatchRenderer] GPU " << t.name << ": min " << t.minMs
+                  << " / avg " << t.avgMs << " / p99 " << t.p99Ms << " ms ("
+                  << t.samples << " samples)\n";
+
+    return m_writers->getStats().failed == 0 ? 0 : 1;
+}
+
+// ============================================================================
+void BatchRenderer::onFrameReadBack(ReadbackFrame&& frame)
+{
+    // Frames rendered before the current scene, or past the count
+    const unsigned int first = m_firstFrame;
+    if (frame.frameNumber < first)
+        return;
+
+    const unsigned int layers = std::max(1u, frame.layers);
+    const std::size_t  layerBytes = frame.data.size() / layers;
+
+    for (unsigned int k = 0; k < layers; ++k)
+    {
+        const unsigned int index = (frame.frameNumber - first) / m_subFrames * layers + k;
+        if (index >= m_frameLimit)
+            return;
+
+        char name[64];
+        if (m_sequence)
+            std::snprintf(name, sizeof(name), "/frame%06u", index);
+        else if (m_tiled)
+            std::snprintf(name, sizeof(name), "/scene%02u_frame%06u_x%05u_y%05u",
+                          m_sceneIndex.load(), index, m_tileX.load(), m_tileY.load());
+        else
+            std::snprintf(name, sizeof(name), "/scene%02u_frame%06u",
+                          m_sceneIndex.load(), index);
+
+        if (layers == 1)
+        {
+            m_writers->submit(std::move(frame), m_options.outputDir + m_subDir + name);
+        }
+        else
+        {
+            ReadbackFrame layer;
+            layer.frameNumber = frame.frameNumber;
+            layer.width  = frame.width;
+            layer.height = frame.height;
+            layer.format = frame.format;
+            layer.type   = frame.type;
+            layer.data.assign(frame.data.begin() + k * layerBytes,
+                              frame.data.begin() + (k + 1) * layerBytes);
+            m_writers->submit(std::move(layer), m_options.outputDir + m_subDir + name);
+        }
+        ++m_framesQueued;
+    }
+}
@@ -0,0 +1,140 @@
+#pragma once
+// ============================================================================
+//  BatchRenderer — Headless dataset generation for SensorNoiseSimulator
+// ============================================================================
+//  Renders into a pbuffer context (no window), runs the noise chain with an
+//  offscreen final target and streams that target back through a
+//  PboReadback ring.  Read-back frames go straight into a FrameWriterPool;
+//  encoding and disk I/O run on its worker threads, never on the draw
+//  thread.
+//
+//  runSequence() replaces the scene with a decoded image sequence: a
+//  SequenceReader thread decodes ahead, PboUpload streams each frame into
+//  the chain input, and the chain, readback and writers run as one
+//  pipeline with every stage on its own thread or queue.
+//  runSequenceCpu() does the same without any GL context, on the
+//  CpuNoiseChain reference backend.
+//
+//  With Options::tileSize, run() treats width x height as a virtual sensor
+//  and renders it tile by tile: the chain, the pbuffer and the readback
+//  ring are one tile large, each tile renders its window of the camera
+//  frustum and runs the chain with that chain region (setRegion()), and
+//  every tile is written as its own file.  Memory stays that of one tile
+//  however large the sensor, and the noise (fixed-pattern and temporal)
+//  continues across the seams.
+//
+//  runProfiles() renders the scenes once per sensor profile, switching
+//  between the built chains of a SensorProfileCache instead of
+//  rebuilding: one chain and one readback ring per pipeline, all
+//  compiled with the first frame.
+// ============================================================================
+
+#include "SensorNoiseSimulator.h"
+#include "SensorProfileCache.h"
+#include "PboReadback.h"
+#include "FrameWriter.h"
+#include "SequenceReader.h"
+
+#include <osg/GraphicsContext>
+#include <osg/Timer>
+#include <osgViewer/Viewer>
+#include <osg/Node>
+#include <osg/ref_ptr>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+class BatchRenderer
+{
+public:
+    struct Options
+    {
+        unsigned int width       = 1280;
+        unsigned int height      = 720;
+        unsigned int frames      = 100;      ///< frames per scene
+        std::string  outputDir   = "output";
+        std::string  extension   = "png";    ///< raw, tif, exr or any osgDB writer
+        unsigned int pboRingSize = 3;
+        unsigned int writerThreads = 0;      ///< 0 = hardware concurrency
+        unsigned int writerQueue   = 16;     ///< frames in flight to the writers
+        unsigned int layers      = 1;        ///< noise realisations per scene render
+        std::string  timingCsv;              ///< per-sample GPU timings (if timing is on)
+        unsigned int tileSize    = 0;        ///< > 0: render scenes in tiles of this size
+    };
+
+    BatchRenderer(SensorNoiseSimulator& simulator, const Options& options);
+
+    /// Render every scene for options.frames frames and write the chain
+    /// output to options.outputDir (tiled if options.tileSize is smaller
+    /// than the frame).  Returns 0 on success.
+    int run(const std::vector<osg::ref_ptr<osg::Node>>& scenes);
+
+    /// run() (untiled) for every profile in turn, into
+    /// options.outputDir/<profile name>.  Chains are built per pipeline
+    /// (SensorProfileCache) at options.width x height, each set up by
+    /// `configure` for what profiles do not hold, and switched between
+    /// in place.  Returns 0 on success.
+    int runProfiles(const std::vector<SensorProfile>& profiles,
+                    const std::vector<osg::ref_ptr<osg::Node>>& scenes,
+                    const SensorProfileCache::Configure& configure = SensorProfileCache::Configure());
+
+    /// Add noise to every frame of a started, non-looping `reader` at
+    /// its native size, writing frameNNNNNN files.  Returns 0 on success.
+    int runSequence(SequenceReader& reader);
+
+    /// runSequence() on the CPU (CpuNoiseChain with `threads` workers, 0 =
+    /// one per core): no GPU needed.  Returns 0 on success.
+    int runSequenceCpu(SequenceReader& reader, unsigned int threads = 0);
+
+private:
+    osg::ref_ptr<osg::GraphicsContext> createPbufferContext(unsigned int width,
+                                                            unsigned int height) const;
+
+    /// Shared set-up for the built, offscreen `chain` under `root`, which
+    /// renders width x height: output directory, writers, readback and the
+    /// pbuffer viewer.
+    bool setUp(osgViewer::Viewer& viewer, osg::Group* root, PostProcessChain& chain,
+               unsigned int width, unsigned int height);
+
+    /// Hand the output of a built, offscreen chain to onFrameReadBack()
+    /// and take its layer and sub-frame counts.
+    bool attachReadback(PostProcessChain& chain, unsigned int width, unsigned int height);
+
+    /// Collect the frames still in `chain`'s readback ring: the end of
+    /// every batch of renders, so no frames are rendered only to push
+    /// the last ones out.
+    void flushReadback(osgViewer::Viewer& viewer, PostProcessChain& chain);
+
+    /// run() for a sensor larger than one tile.  Tiles are the outer
+    /// loop, so each region's maps are baked once for all scenes; edge
+    /// tiles are shifted inwards to keep one tile size, and the pixels
+    /// they share with a neighbour come out identical.  Files are named
+    /// sceneSS_frameNNNNNN_xXXXXX_yYYYYY after the tile's top-left pixel
+    /// (rows from the top, as written).
+    int runTiled(const std::vector<osg::ref_ptr<osg::Node>>& scenes);
+
+    /// Drain the writers and print the summary; the exit code.
+    int finish(unsigned int totalWritten, osg::Timer_t start);
+
+    /// Readback sink (draw or flushing thread): hand frames of the current
+    /// scene to the writer pool, drop frames past the count.
+    void onFrameReadBack(ReadbackFrame&& frame);
+
+    SensorNoiseSimulator& m_sim;
+    Options               m_options;
+
+    std::unique_ptr<FrameWriterPool> m_writers;
+    std::atomic<unsigned int> m_sceneIndex{ 0 };
+    std::atomic<unsigned int> m_firstFrame{ 0 };
+    std::atomic<unsigned int> m_framesQueued{ 0 };
+    unsigned int              m_layers = 1;
+    unsigned int              m_subFrames = 1;   ///< renders per output (temporal stage)
+    std::atomic<unsigned int> m_frameLimit{ 0 };  ///< outputs wanted from the current run
+    bool                      m_sequence = false;
+    bool                      m_tiled = false;
+    std::atomic<unsigned int> m_tileX{ 0 };      ///< top-left of the current tile, rows from the top
+    std::atomic<unsigned int> m_tileY{ 0 };
+    std::string               m_subDir;          ///< prefix under outputDir ("/<profile>")
+};
@@ -0,0 +1,152 @@
+#pragma once
+// ============================================================================
+//  BoundedFrameQueue — Lock-free bounded MPMC queue
+// ============================================================================
+//  Fixed-capacity ring of sequence-stamped cells (Vyukov's bounded queue).
+//  Producers and consumers only ever CAS an index and publish a cell's
+//  sequence number, so the draw thread never takes a lock to hand off a
+//  frame.  tryPush / tryPop never block; pushWait / popWait retry them,
+//  yielding briefly and then sleeping, since there is no condition
+//  variable to wait on.
+// ============================================================================
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+template <typename T>
+class BoundedFrameQueue
+{
+public:
+    /// Capacity is rounded up to a power of two.
+    explicit BoundedFrameQueue(std::size_t capacity)
+    {
+        std::size_t n = 2;
+        while (n < capacity)
+            n <<= 1;
+        m_mask  = n - 1;
+        m_cells.reset(new Cell[n]);
+        for (std::size_t i = 0; i < n; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    BoundedFrameQueue(const BoundedFrameQueue&) = delete;
+    BoundedFrameQueue& operator=(const BoundedFrameQueue&) = delete;
+
+    /// Returns false (and leaves value untouched) if the queue is full.
+    bool tryPush(T& value)
+    {
+        Cell* cell;
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+            if (diff == 0)
+            {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns false if the queue is empty.
+    bool tryPop(T& value)
+    {
+        Cell* cell;
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell = &m_cells[pos & m_mask];
+            std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+            if (diff == 0)
+            {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+                return false;
+            else
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+        }
+        value = std::move(cell->value);
+        cell->value = T();
+        cell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// tryPush() until it succeeds or `stop()` returns true (then false,
+    /// leaving value untouched).
+    template <typename Stop>
+    bool pushWait(T& value, Stop stop)
+    {
+        for (unsigned int spins = 0; ; ++spins)
+        {
+            if (tryPush(value))
+                return true;
+            if (stop())
+                return false;
+            backOff(spins);
+        }
+    }
+
+    /// tryPop() until it succeeds or `stop()` returns true; an item pushed
+    /// just before the stop is still returned.  False once stopped and
+    /// empty.
+    template <typename Stop>
+    bool popWait(T& value, Stop stop)
+    {
+        for (unsigned int spins = 0; ; ++spins)
+        {
+            if (tryPop(value))
+                return true;
+            if (stop())
+                return tryPop(value);
+            backOff(spins);
+        }
+    }
+
+    /// Approximate number of queued items (exact when quiescent).
+    std::size_t size() const
+    {
+        std::size_t in  = m_enqueuePos.load(std::memory_order_relaxed);
+        std::size_t out = m_dequeuePos.load(std::memory_order_relaxed);
+        return in > out ? in - out : 0;
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    /// Spin briefly, then back off.
+    static void backOff(unsigned int spins)
+    {
+        if (spins < 64)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T                        value;
+    };
+
+    // Keep the two hot indices on separate cache lines.
+    alignas(64) std::unique_ptr<Cell[]>  m_cells;
+    std::size_t                          m_mask = 0;
+    alignas(64) std::atomic<std::size_t> m_enqueuePos{ 0 };
+    alignas(64) std::atomic<std::size_t> m_dequeuePos{ 0 };
+};
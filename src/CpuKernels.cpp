@@ -0,0 +1,394 @@
+// ============================================================================
+//  CpuKernels.cpp — CPU ports of the effect shaders
+// ============================================================================
+
+#include "CpuKernels.h"
+#include "NoiseMath.h"
+#include "PoissonTable.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// The whole build may target AVX2; otherwise GCC / Clang compile the
+// AVX2 hash on its own and select it at run time.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define SENSORNOISE_AVX2_DISPATCH 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using CpuKernels::LANES;
+using CpuKernels::Tile;
+
+// ── Helpers ─────────────────────────────────────────────────────────────────
+namespace
+{
+#if defined(__AVX2__) || defined(SENSORNOISE_AVX2_DISPATCH)
+    /// pcg4d() of LANES counters in AVX2 registers, v[component][lane].
+#if defined(SENSORNOISE_AVX2_DISPATCH)
+    __attribute__((target("avx2")))
+#endif
+    void pcg4dAvx2(uint32_t v[4][LANES])
+    {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v[0]));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v[1]));
+        __m256i z = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v[2]));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v[3]));
+        const __m256i mul = _mm256_set1_epi32(1664525), inc = _mm256_set1_epi32(1013904223);
+        x = _mm256_add_epi32(_mm256_mullo_epi32(x, mul), inc);
+        y = _mm256_add_epi32(_mm256_mullo_epi32(y, mul), inc);
+        z = _mm256_add_epi32(_mm256_mullo_epi32(z, mul), inc);
+        w = _mm256_add_epi32(_mm256_mullo_epi32(w, mul), inc);
+        for (int round = 0; round < 2; ++round)
+        {
+            if (round)
+            {
+                x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+                y = _mm256_xor_si256(y, _mm256_srli_epi32(y, 16));
+                z = _mm256_xor_si256(z, _mm256_srli_epi32(z, 16));
+                w = _mm256_xor_si256(w, _mm256_srli_epi32(w, 16));
+            }
+            x = _mm256_add_epi32(x, _mm256_mullo_epi32(y, w));
+            y = _mm256_add_epi32(y, _mm256_mullo_epi32(z, x));
+            z = _mm256_add_epi32(z, _mm256_mullo_epi32(x, y));
+            w = _mm256_add_epi32(w, _mm256_mullo_epi32(y, z));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v[0]), x);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v[1]), y);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v[2]), z);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(v[3]), w);
+    }
+#endif
+
+#if defined(SENSORNOISE_AVX2_DISPATCH)
+    bool hasAvx2()
+    {
+        static const bool supported = []
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+        }();
+        return supported;
+    }
+#endif
+
+    /// pcg4d() of LANES counters at once, v[component][lane].
+    inline void pcg4dLanes(uint32_t v[4][LANES])
+    {
+#if defined(__AVX2__)
+        pcg4dAvx2(v);
+#else
+#if defined(SENSORNOISE_AVX2_DISPATCH)
+        if (hasAvx2())
+        {
+            pcg4dAvx2(v);
+            return;
+        }
+#elif defined(__ARM_NEON)
+        for (unsigned int i = 0; i < LANES; i += 4)
+        {
+            const uint32x4_t inc = vdupq_n_u32(1013904223u);
+            uint32x4_t x = vmlaq_n_u32(inc, vld1q_u32(v[0] + i), 1664525u);
+            uint32x4_t y = vmlaq_n_u32(inc, vld1q_u32(v[1] + i), 1664525u);
+            uint32x4_t z = vmlaq_n_u32(inc, vld1q_u32(v[2] + i), 1664525u);
+            uint32x4_t w = vmlaq_n_u32(inc, vld1q_u32(v[3] + i), 1664525u);
+            for (int round = 0; round < 2; ++round)
+            {
+                if (round)
+                {
+                    x = veorq_u32(x, vshrq_n_u32(x, 16));
+                    y = veorq_u32(y, vshrq_n_u32(y, 16));
+                    z = veorq_u32(z, vshrq_n_u32(z, 16));
+                    w = veorq_u32(w, vshrq_n_u32(w, 16));
+                }
+                x = vmlaq_u32(x, y, w);
+                y = vmlaq_u32(y, z, x);
+                z = vmlaq_u32(z, x, y);
+                w = vmlaq_u32(w, y, z);
+            }
+            vst1q_u32(v[0] + i, x);
+            vst1q_u32(v[1] + i, y);
+            vst1q_u32(v[2] + i, z);
+            vst1q_u32(v[3] + i, w);
+        }
+        return;
+#endif
+        for (unsigned int i = 0; i < LANES; ++i)
+        {
+            uint32_t lane[4] = { v[0][i], v[1][i], v[2][i], v[3][i] };
+            NoiseMath::pcg4d(lane);
+            for (int c = 0; c < 4; ++c)
+                v[c][i] = lane[c];
+        }
+#endif
+    }
+
+    /// rng_stream() for pixels x .. x + LANES - 1 of row y, with the first
+    /// `blocks` (at most 2) blocks hashed ahead LANES at a time.  Further
+    /// blocks, only the Exact Poisson loop gets that far, are hashed lane
+    /// by lane on demand.
+    inline void streamLanes(NoiseMath::RngStream* s, unsigned int x, unsigned int y,
+                            const Tile& tile, unsigned int stream, bool fastNormals,
+                            unsigned int blocks)
+    {
+        for (unsigned int i = 0; i < LANES; ++i)
+        {
+            s[i] = NoiseMath::rngStream(tile.originX + x + i, tile.originY + y,
+                                        tile.frameNumber, stream, tile.seed);
+            s[i].fastNormals = fastNormals;
+        }
+
+        for (unsigned int b = 0; b < blocks; ++b)
+        {
+            uint32_t v[4][LANES];
+            for (unsigned int i = 0; i < LANES; ++i)
+                for (int c = 0; c < 4; ++c)
+                    v[c][i] = s[i].counter[c];
+            pcg4dLanes(v);
+            for (unsigned int i = 0; i < LANES; ++i)
+            {
+                for (int c = 0; c < 4; ++c)
+                    s[i].words[b * 4 + c] = v[c][i];
+                ++s[i].counter[2];
+                s[i].filled += 4;
+            }
+        }
+    }
+
+    /// Value of texel (x, y) of a single-channel map, normalised.
+    bool readTexel(const osg::Image* map, unsigned int x, unsigned int y, float& value)
+    {
+        const unsigned char* p = map->data(x, y);
+        switch (map->getDataType())
+        {
+        case GL_FLOAT:          value = *reinterpret_cast<const float*>(p); return true;
+        case GL_UNSIGNED_BYTE:  value = *p / 255.0f; return true;
+        case GL_UNSIGNED_SHORT: value = *reinterpret_cast<const unsigned short*>(p) / 65535.0f; return true;
+        default:                return false;
+        }
+    }
+
+    /// Plane pointers of a tile, .r only in CFA mode.
+    unsigned int planes(const Tile& tile, float* out[3])
+    {
+        out[0] = tile.r;
+        out[1] = tile.g;
+        out[2] = tile.b;
+        return tile.cfaPattern ? 1u : 3u;
+    }
+}
+
+// ============================================================================
+void CpuKernels::MapPlane::update(const osg::Image* map, unsigned int width,
+                                  unsigned int height, bool halfPrecision)
+{
+    if (map == m_source && map && map->getModifiedCount() == m_modified &&
+        width == m_width && height == m_height && halfPrecision == m_half)
+        return;
+
+    m_source   = map;
+    m_modified = map ? map->getModifiedCount() : ~0u;
+    m_width    = width;
+    m_height   = height;
+    m_half     = halfPrecision;
+    m_values.assign(std::size_t(width) * height, 0.0f);
+    if (!map || map->s() <= 0 || map->t() <= 0)
+        return;
+
+    // NEAREST at the pixel centre, as texture(map, map_coord(fragCoord))
+    const unsigned int mapW = map->s(), mapH = map->t();
+    bool supported = true;
+    float* out = m_values.data();
+    for (unsigned int y = 0; y < height && supported; ++y)
+    {
+        const unsigned int my = std::min(unsigned((y + 0.5) * mapH / height), mapH - 1);
+        for (unsigned int x = 0; x < width && supported; ++x)
+        {
+            const unsigned int mx = std::min(unsigned((x + 0.5) * mapW / width), mapW - 1);
+            float v = 0.0f;
+            supported = readTexel(map, mx, my, v);
+            *out++ = halfPrecision ? NoiseMath::roundToHalf(v) : v;
+        }
+    }
+    if (!supported)
+        std::cerr << "[CpuKernels] WARNING: Map pixel type 0x" << std::hex
+                  << map->getDataType() << std::dec << " not supported on the CPU.\n";
+}
+
+// ============================================================================
+void CpuKernels::cfaMosaic(const Tile& tile)
+{
+    for (unsigned int y = tile.y0; y < tile.y1; ++y)
+    {
+        // Rows counted from the top of the sensor
+        const int top = (tile.sensorHeight - 1 - (tile.originY + y)) & 1;
+        const std::size_t row = std::size_t(y) * tile.width;
+        for (unsigned int x = 0; x < tile.width; ++x)
+        {
+            const int site = top * 2 + int((tile.originX + x) & 1);
+            int c;
+            switch (tile.cfaPattern)
+            {
+            case 1:  c = site == 0 ? 0 : site == 3 ? 2 : 1; break;   // RGGB
+            case 2:  c = site == 0 ? 2 : site == 3 ? 0 : 1; break;   // BGGR
+            case 3:  c = site == 1 ? 0 : site == 2 ? 2 : 1; break;   // GRBG
+            default: c = site == 1 ? 2 : site == 2 ? 0 : 1; break;   // GBRG
+            }
+            if (c == 1)      tile.r[row + x] = tile.g[row + x];
+            else if (c == 2) tile.r[row + x] = tile.b[row + x];
+        }
+    }
+}
+
+// ============================================================================
+void CpuKernels::prnu(const Tile& tile, const MapPlane& gain)
+{
+    float* p[3];
+    const unsigned int channels = planes(tile, p);
+    for (unsigned int y = tile.y0; y < tile.y1; ++y)
+    {
+        const float* g   = gain.row(y);
+        const std::size_t row = std::size_t(y) * tile.width;
+        for (unsigned int c = 0; c < channels; ++c)
+        {
+            float* v = p[c] + row;
+            for (unsigned int x = 0; x < tile.width; ++x)
+                v[x] *= g[x];
+        }
+    }
+}
+
+// ============================================================================
+void CpuKernels::darkNoise(const Tile& tile, const MapPlane& dsnu, const MapPlane& hotPixels,
+                           float darkCurrent, float hotPixelStrength, unsigned int stream,
+                           bool fastNormals)
+{
+    float* p[3];
+    const unsigned int channels = planes(tile, p);
+    const unsigned char* table = PoissonTable::data();
+    for (unsigned int y = tile.y0; y < tile.y1; ++y)
+    {
+        const float* offset = dsnu.row(y);
+        const float* hot    = hotPixels.row(y);
+        const std::size_t row = std::size_t(y) * tile.width;
+
+        for (unsigned int x = 0; x < tile.width; x += LANES)
+        {
+            const unsigned int n = std::min(LANES, tile.width - x);
+            float lambda[LANES] = {};
+            for (unsigned int i = 0; i < n; ++i)
+            {
+                float darkContrib = darkCurrent + offset[x + i];
+                if (hot[x + i] > 0.5f)
+                    darkContrib += hotPixelStrength * darkCurrent;
+                darkContrib *= tile.exposure;
+                lambda[i] = darkContrib * 1000.0f;
+            }
+
+            NoiseMath::RngStream state[LANES];
+            streamLanes(state, x, y, tile, stream, fastNormals, 1);
+            for (unsigned int i = 0; i < n; ++i)
+            {
+                const int k = NoiseMath::samplePoisson(lambda[i], state[i], tile.poissonQuality, table);
+                for (unsigned int c = 0; c < channels; ++c)
+                    p[c][row + x + i] += float(k) / 1000.0f;
+            }
+        }
+    }
+}
+
+// ============================================================================
+void CpuKernels::photonNoise(const Tile& tile, float photonScale, unsigned int stream,
+                             bool fastNormals)
+{
+    float* p[3];
+    const unsigned int channels = planes(tile, p);
+    const float photons = photonScale * tile.exposure;
+    const unsigned char* table = PoissonTable::data();
+    // Up to two words per channel
+    const unsigned int blocks = (2 * channels + 3) / 4;
+    for (unsigned int y = tile.y0; y < tile.y1; ++y)
+    {
+        const std::size_t row = std::size_t(y) * tile.width;
+
+        for (unsigned int x = 0; x < tile.width; x += LANES)
+        {
+            const unsigned int n = std::min(LANES, tile.width - x);
+            NoiseMath::RngStream state[LANES];
+            streamLanes(state, x, y, tile, stream, fastNormals, blocks);
+
+            // One draw sequence per pixel: r, then g, then b
+            for (unsigned int i = 0; i < n; ++i)
+                for (unsigned int c = 0; c < channels; ++c)
+                {
+                    float& v = p[c][row + x + i];
+                    v = float(NoiseMath::samplePoisson(std::max(v, 0.0f) * photons, state[i],
+                                                       tile.poissonQuality, table)) / photonScale;
+                }
+        }
+    }
+}
+
+// ============================================================================
+void CpuKernels::readNoise(const Tile& tile, float sigma, unsigned int stream,
+                           bool fastNormals)
+{
+    float* p[3];
+    const unsigned int channels = planes(tile, p);
+    // Two words per normal in fast mode, per Box-Muller pair otherwise
+    const unsigned int blocks = fastNormals ? (2 * channels + 3) / 4 : 1;
+    for (unsigned int y = tile.y0; y < tile.y1; ++y)
+    {
+        const std::size_t row = std::size_t(y) * tile.width;
+
+        for (unsigned int x = 0; x < tile.width; x += LANES)
+        {
+            const unsigned int n = std::min(LANES, tile.width - x);
+            NoiseMath::RngStream state[LANES];
+            streamLanes(state, x, y, tile, stream, fastNormals, blocks);
+
+            for (unsigned int i = 0; i < n; ++i)
+                for (unsigned int c = 0; c < channels; ++c)
+                    p[c][row + x + i] += sigma * NoiseMath::randNormal(state[i]);
+        }
+    }
+}
+
+// ============================================================================
+void CpuKernels::adc(const Tile& tile, int bits, float gain, float blackLevel)
+{
+    float* p[3];
+    const unsigned int channels = planes(tile, p);
+    const float maxCode = std::exp2(float(bits)) - 1.0f;
+    for (unsigned int y = tile.y0; y < tile.y1; ++y)
+    {
+        const std::size_t row = std::size_t(y) * tile.width;
+        for (unsigned int c = 0; c < channels; ++c)
+        {
+            float* v = p[c] + row;
+            for (unsigned int x = 0; x < tile.width; ++x)
+            {
+                const float analog = std::min(std::max(v[x] * gain + blackLevel, 0.0f), 1.0f);
+                v[x] = std::floor(analog * maxCode + 0.5f) / maxCode;
+            }
+        }
+    }
+}
+
+// ============================================================================
+const char* CpuKernels::simdName()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(SENSORNOISE_AVX2_DISPATCH)
+    return hasAvx2() ? "AVX2" : "scalar";
+#elif defined(__ARM_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
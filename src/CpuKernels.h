@@ -0,0 +1,83 @@
+#pragma once
+// ============================================================================
+//  CpuKernels — CPU reference kernels of the noise effect shaders
+// ============================================================================
+//  One function per effect shader, over structure-of-arrays float planes
+//  (bottom row first, like the GL targets).  Pixels are processed in
+//  blocks of LANES: the pcg4d hashes of a block run as one SIMD operation
+//  (AVX2 when the CPU has it, chosen at run time with GCC / Clang; NEON on
+//  AArch64; plain C++ otherwise) while log / cos / exp stay scalar libm
+//  calls, so every value follows the GLSL expression it ports and the RNG
+//  streams are bit-exact.
+//
+//  A Tile is a band of full rows; CpuNoiseChain runs the tiles of a frame
+//  on several threads.  Kernels only touch the rows of their tile.
+// ============================================================================
+
+#include <osg/Image>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace CpuKernels
+{
+    /// Pixels per SIMD block.
+    const unsigned int LANES = 8;
+
+    struct Tile
+    {
+        float*       r = nullptr;   ///< planes of the whole frame
+        float*       g = nullptr;
+        float*       b = nullptr;
+        unsigned int width = 0;     ///< frame size (u_resolution)
+        unsigned int height = 0;
+        unsigned int y0 = 0;        ///< rows [y0, y1) belong to this tile
+        unsigned int y1 = 0;
+        unsigned int originX = 0;   ///< frame position on the sensor (u_tileOffset)
+        unsigned int originY = 0;
+        unsigned int sensorHeight = 0;  ///< u_sensorSize.y
+        int          frameNumber = 0;   ///< u_frameNumber
+        uint64_t     seed = 0;          ///< u_seed
+        float        exposure = 1.0f;   ///< u_exposure
+        int          poissonQuality = 1;   ///< POISSON_QUALITY
+        int          cfaPattern = 0;       ///< CFA_PATTERN; only .r is carried
+    };
+
+    /// A single-channel calibration map resampled to the frame size the
+    /// way the effect shader samples it (NEAREST), optionally rounded to
+    /// the R16F storage the GPU path keeps it in.  update() is cheap while
+    /// the image and size are unchanged.
+    class MapPlane
+    {
+    public:
+        void update(const osg::Image* map, unsigned int width, unsigned int height,
+                    bool halfPrecision);
+
+        const float* row(unsigned int y) const { return m_values.data() + std::size_t(y) * m_width; }
+
+    private:
+        std::vector<float> m_values;
+        const osg::Image*  m_source = nullptr;
+        unsigned int       m_modified = ~0u;
+        unsigned int       m_width = 0, m_height = 0;
+        bool               m_half = false;
+    };
+
+    /// Reduce an RGB tile to the photosite colours of `tile.cfaPattern`
+    /// (the chain's u_inputIsRaw == false step).
+    void cfaMosaic(const Tile& tile);
+
+    void prnu(const Tile& tile, const MapPlane& gain);
+    /// `stream` is the effect's RNG stream ID (INoiseEffect::getStreamId())
+    /// and `fastNormals` its INoiseEffect::getFastNormals().
+    void darkNoise(const Tile& tile, const MapPlane& dsnu, const MapPlane& hotPixels,
+                   float darkCurrent, float hotPixelStrength, unsigned int stream,
+                   bool fastNormals);
+    void photonNoise(const Tile& tile, float photonScale, unsigned int stream, bool fastNormals);
+    void readNoise(const Tile& tile, float sigma, unsigned int stream, bool fastNormals);
+    void adc(const Tile& tile, int bits, float gain, float blackLevel);
+
+    /// Name of the instruction set the hash kernel was built for.
+    const char* simdName();
+}
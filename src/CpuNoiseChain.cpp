@@ -0,0 +1,244 @@
+// ============================================================================
+//  CpuNoiseChain.cpp — Row-band thread pool around the CPU kernels
+// ============================================================================
+
+#include "CpuNoiseChain.h"
+#include "CpuKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// ============================================================================
+void CpuNoiseChain::Planes::resize(unsigned int w, unsigned int h)
+{
+    width  = w;
+    height = h;
+    r.resize(std::size_t(w) * h);
+    g.resize(std::size_t(w) * h);
+    b.resize(std::size_t(w) * h);
+}
+
+// ============================================================================
+CpuNoiseChain::CpuNoiseChain(unsigned int threads)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int i = 1; i < threads; ++i)
+        m_workers.emplace_back(&CpuNoiseChain::workerLoop, this);
+}
+
+// ============================================================================
+CpuNoiseChain::~CpuNoiseChain()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (auto& t : m_workers)
+        t.join();
+}
+
+// ============================================================================
+bool CpuNoiseChain::process(const PostProcessChain& chain, Planes& planes, int frameNumber)
+{
+    // Without a region the planes are the whole sensor
+    const unsigned int originX = chain.hasRegion() ? chain.getRegionX() : 0;
+    const unsigned int originY = chain.hasRegion() ? chain.getRegionY() : 0;
+    const unsigned int sensorW = chain.hasRegion() ? chain.getSensorWidth()  : planes.width;
+    const unsigned int sensorH = chain.hasRegion() ? chain.getSensorHeight() : planes.height;
+
+    std::vector<INoiseEffect*> effects;
+    for (auto& e : chain.getEffects())
+    {
+        if (!e->isEnabled())
+            continue;
+        e->setRegion(originX, originY, sensorW, sensorH);
+        if (!e->prepareCpu(planes.width, planes.height))
+        {
+            std::cerr << "[CpuNoiseChain] ERROR: " << e->getName()
+                      << " has no CPU implementation.\n";
+            return false;
+        }
+        effects.push_back(e.get());
+    }
+
+    CpuKernels::Tile frame;
+    frame.r = planes.r.data();
+    frame.g = planes.g.data();
+    frame.b = planes.b.data();
+    frame.width  = planes.width;
+    frame.height = planes.height;
+    frame.originX      = originX;
+    frame.originY      = originY;
+    frame.sensorHeight = sensorH;
+    frame.frameNumber    = frameNumber;
+    frame.seed           = chain.getSeed();
+    frame.exposure       = chain.getExposure();
+    frame.poissonQuality = static_cast<int>(chain.getPoissonQuality());
+    frame.cfaPattern     = static_cast<int>(chain.getCfaPattern());
+
+    if (frame.cfaPattern && chain.getDemosaicEnabled() && !m_warnedDemosaic)
+    {
+        std::cerr << "[CpuNoiseChain] WARNING: No CPU demosaic; the output stays raw.\n";
+        m_warnedDemosaic = true;
+    }
+
+    const unsigned int tiles = (planes.height + TILE_ROWS - 1) / TILE_ROWS;
+    parallelFor(tiles, [&](unsigned int i)
+    {
+        CpuKernels::Tile tile = frame;
+        tile.y0 = i * TILE_ROWS;
+        tile.y1 = std::min(tile.y0 + TILE_ROWS, planes.height);
+        if (tile.cfaPattern)
+            CpuKernels::cfaMosaic(tile);
+        for (INoiseEffect* e : effects)
+            e->processCpu(tile);
+    });
+    return true;
+}
+
+// ============================================================================
+void CpuNoiseChain::parallelFor(unsigned int count, const std::function<void(unsigned int)>& job)
+{
+    if (m_workers.empty() || count <= 1)
+    {
+        for (unsigned int i = 0; i < count; ++i)
+            job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job      = &job;
+        m_jobCount = count;
+        m_nextJob  = 0;
+        m_busy     = unsigned(m_workers.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    for (unsigned int i; (i = m_nextJob.fetch_add(1)) < count; )
+        job(i);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_busy == 0; });
+    m_job = nullptr;
+}
+
+// ============================================================================
+void CpuNoiseChain::workerLoop()
+{
+    unsigned int seen = 0;
+    for (;;)
+    {
+        const std::function<void(unsigned int)>* job;
+        unsigned int count;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_quit || m_generation != seen; });
+            if (m_quit)
+                return;
+            seen  = m_generation;
+            job   = m_job;
+            count = m_jobCount;
+        }
+
+        for (unsigned int i; (i = m_nextJob.fetch_add(1)) < count; )
+            (*job)(i);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0)
+            m_idle.notify_one();
+    }
+}
+
+// ============================================================================
+bool CpuNoiseChain::fromImage(const osg::Image* image, Planes& planes)
+{
+    const GLenum format = image->getPixelFormat();
+    const GLenum type   = image->getDataType();
+    const unsigned int components = osg::Image::computeNumComponents(format);
+    if ((type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_SHORT && type != GL_FLOAT) ||
+        components == 0 || image->s() <= 0 || image->t() <= 0)
+    {
+        std::cerr << "[CpuNoiseChain] ERROR: Unsupported input image (format 0x" << std::hex
+                  << format << ", type 0x" << type << std::dec << ").\n";
+        return false;
+    }
+
+    // Grey and grey-alpha inputs feed all three channels
+    const bool bgr = format == GL_BGR || format == GL_BGRA;
+    const unsigned int cr = components >= 3 ? (bgr ? 2 : 0) : 0;
+    const unsigned int cg = components >= 3 ? 1 : 0;
+    const unsigned int cb = components >= 3 ? (bgr ? 0 : 2) : 0;
+
+    planes.resize(image->s(), image->t());
+    std::size_t o = 0;
+    for (unsigned int y = 0; y < planes.height; ++y)
+    {
+        const unsigned char* row = image->data(0, y);
+        for (unsigned int x = 0; x < planes.width; ++x, ++o)
+        {
+            float v[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            for (unsigned int c = 0; c < std::min(components, 4u); ++c)
+            {
+                const std::size_t i = std::size_t(x) * components + c;
+                switch (type)
+                {
+                case GL_UNSIGNED_BYTE:  v[c] = row[i] / 255.0f; break;
+                case GL_UNSIGNED_SHORT: v[c] = reinterpret_cast<const unsigned short*>(row)[i] / 65535.0f; break;
+                default:                v[c] = reinterpret_cast<const float*>(row)[i]; break;
+                }
+            }
+            planes.r[o] = v[cr];
+            planes.g[o] = v[cg];
+            planes.b[o] = v[cb];
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Image> CpuNoiseChain::toImage(const Planes& planes, bool raw, GLenum type)
+{
+    const unsigned int components = raw ? 1u : 4u;
+    osg::ref_ptr<osg::Image> image = new osg::Image;
+    image->allocateImage(planes.width, planes.height, 1, raw ? GL_RED : GL_RGBA, type);
+
+    // Unsigned outputs convert like a UNORM render target
+    auto store = [type](unsigned char* row, std::size_t i, float v)
+    {
+        switch (type)
+        {
+        case GL_UNSIGNED_BYTE:
+            row[i] = static_cast<unsigned char>(std::lround(std::min(std::max(v, 0.0f), 1.0f) * 255.0f));
+            break;
+        case GL_UNSIGNED_SHORT:
+            reinterpret_cast<unsigned short*>(row)[i] =
+                static_cast<unsigned short>(std::lround(std::min(std::max(v, 0.0f), 1.0f) * 65535.0f));
+            break;
+        default:
+            reinterpret_cast<float*>(row)[i] = v;
+            break;
+        }
+    };
+
+    std::size_t o = 0;
+    for (unsigned int y = 0; y < planes.height; ++y)
+    {
+        unsigned char* row = image->data(0, y);
+        for (unsigned int x = 0; x < planes.width; ++x, ++o)
+        {
+            const std::size_t i = std::size_t(x) * components;
+            store(row, i, planes.r[o]);
+            if (raw)
+                continue;
+            store(row, i + 1, planes.g[o]);
+            store(row, i + 2, planes.b[o]);
+            store(row, i + 3, 1.0f);
+        }
+    }
+    return image;
+}
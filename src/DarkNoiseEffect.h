@@ -2,11 +2,18 @@
 // ============================================================================
 //  DarkNoiseEffect — Dark current + DSNU + hot pixels module
 // ============================================================================
+//  DSNU offsets and the hot pixel mask are baked once into R16F / R8
+//  textures and only re-baked when DSNU strength, hot pixel probability,
+//  the resolution or the region change.  Measured maps can be set
+//  instead.  Lookups whose parameters are zero are compiled out
+//  (getFeatureKeys()).
+// ============================================================================
 
 #include "INoiseEffect.h"
+#include "ProgramCache.h"
+#include "FixedPatternMaps.h"
+#include "CpuKernels.h"
 #include <osg/Uniform>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 
 class DarkNoiseEffect : public INoiseEffect
@@ -24,78 +31,158 @@ public:
         , m_hotPixelStrength(hotPixelStr)
     {
         m_uDarkCurrent  = new osg::Uniform("u_darkCurrent", m_darkCurrent);
-        m_uDSNU         = new osg::Uniform("u_dsnuStrength", m_dsnuStrength);
-        m_uHotPixelProb = new osg::Uniform("u_hotPixelProbability", m_hotPixelProbability);
         m_uHotPixelStr  = new osg::Uniform("u_hotPixelStrength", m_hotPixelStrength);
-        m_uFrameNumber  = new osg::Uniform("u_frameNumber", 0);
-        m_uResolution   = new osg::Uniform("u_resolution", osg::Vec2(1280, 720));
+        m_uDSNUMap      = new osg::Uniform("u_dsnuMap", int(FixedPatternMaps::DSNU_MAP_UNIT));
+        m_uHotPixelMask = new osg::Uniform("u_hotPixelMask", int(FixedPatternMaps::HOT_PIXEL_UNIT));
+        createStreamUniform("u_darkStream", DARK_STREAM);
+
+        m_dsnuImage = new osg::Image;
+        m_hotImage  = new osg::Image;
+        m_dsnuMap   = FixedPatternMaps::createMapTexture(GL_R16F);
+        m_hotMap    = FixedPatternMaps::createMapTexture(GL_R8);
     }
 
     std::string getName() const override { return "DarkNoise"; }
 
     std::string getFragmentSource() const override
     {
-        std::ifstream ifs(m_shaderDir + "/dark_noise.frag");
-        if (!ifs.is_open()) return {};
-        std::stringstream ss; ss << ifs.rdbuf();
-        return ss.str();
+        return ProgramCache::instance().source(m_shaderDir + "/dark_noise.frag");
+    }
+
+    std::string getApplyFunction() const override { return "apply_dark_noise"; }
+    /// DSNU and hot pixel lookups compile out while they cannot
+    /// contribute (zero strength and no measured map).
+    std::vector<std::string> getFeatureKeys() const override
+    {
+        std::vector<std::string> keys;
+        if (m_measuredDSNU.valid() || m_dsnuStrength > 0.0f)
+            keys.push_back("DARK_DSNU");
+        if ((m_measuredHot.valid() || m_hotPixelProbability > 0.0f) && m_hotPixelStrength > 0.0f)
+            keys.push_back("DARK_HOT_PIXELS");
+        if (m_fastNormals)
+            keys.push_back("DARK_FAST_NORMALS");
+        return keys;
     }
 
     void setupUniforms(osg::StateSet* ss) override
     {
         ss->addUniform(m_uDarkCurrent);
-        ss->addUniform(m_uDSNU);
-        ss->addUniform(m_uHotPixelProb);
         ss->addUniform(m_uHotPixelStr);
-        ss->addUniform(m_uFrameNumber);
-        ss->addUniform(m_uResolution);
+        ss->addUniform(m_uDSNUMap);
+        ss->addUniform(m_uHotPixelMask);
+        ss->addUniform(m_uStreamId);
+        ss->setTextureAttributeAndModes(FixedPatternMaps::DSNU_MAP_UNIT, m_dsnuMap,
+                                        osg::StateAttribute::ON);
+        ss->setTextureAttributeAndModes(FixedPatternMaps::HOT_PIXEL_UNIT, m_hotMap,
+                                        osg::StateAttribute::ON);
+        m_attached = true;
+        if (m_dirty) bakeMaps();
     }
 
-    osg::ref_ptr<osg::NodeCallback> createUpdateCallback() override;
-
     // ── Parameter access ────────────────────────────────────────────────
-    void  setDarkCurrent(float v)       { m_darkCurrent = std::max(0.f, v);          m_uDarkCurrent->set(m_darkCurrent); }
+    void  setDarkCurrent(float v)       { setIfChanged(m_uDarkCurrent.get(), m_darkCurrent, std::max(0.f, v)); }
     float getDarkCurrent() const        { return m_darkCurrent; }
 
-    void  setDSNUStrength(float v)      { m_dsnuStrength = std::max(0.f, v);         m_uDSNU->set(m_dsnuStrength); }
+    void  setDSNUStrength(float v)      { setMapParameter(m_dsnuStrength, std::max(0.f, v)); }
     float getDSNUStrength() const       { return m_dsnuStrength; }
 
-    void  setHotPixelProbability(float v){ m_hotPixelProbability = std::clamp(v,0.f,1.f); m_uHotPixelProb->set(m_hotPixelProbability); }
+    void  setHotPixelProbability(float v){ setMapParameter(m_hotPixelProbability, std::clamp(v,0.f,1.f)); }
     float getHotPixelProbability() const { return m_hotPixelProbability; }
 
-    void  setHotPixelStrength(float v)  { m_hotPixelStrength = std::max(0.f, v);     m_uHotPixelStr->set(m_hotPixelStrength); }
+    void  setHotPixelStrength(float v)  { setIfChanged(m_uHotPixelStr.get(), m_hotPixelStrength, std::max(0.f, v)); }
     float getHotPixelStrength() const   { return m_hotPixelStrength; }
 
-    void setResolution(float w, float h){ m_uResolution->set(osg::Vec2(w, h)); }
+    /// The CPU path reads the maps at their GPU precision (R16F, R8).
+    bool prepareCpu(unsigned int w, unsigned int h) override
+    {
+        setResolution(w, h);
+        if (m_dirty) bakeMaps();
+        m_cpuDSNU.update(m_dsnuMap->getImage(), w, h, true);
+        m_cpuHot.update(m_hotMap->getImage(), w, h, false);
+        return true;
+    }
+    void processCpu(const CpuKernels::Tile& tile) const override
+    {
+        CpuKernels::darkNoise(tile, m_cpuDSNU, m_cpuHot, m_darkCurrent, m_hotPixelStrength,
+                              m_streamId, m_fastNormals);
+    }
+
+    void setResolution(unsigned int w, unsigned int h) override
+    {
+        if (w == m_region.width && h == m_region.height) return;
+        m_region.width = w; m_region.height = h;
+        invalidate();
+    }
+
+    void setRegion(unsigned int x, unsigned int y, unsigned int sensorW, unsigned int sensorH) override
+    {
+        if (x == m_region.x && y == m_region.y &&
+            sensorW == m_region.sensorWidth && sensorH == m_region.sensorHeight) return;
+        m_region.x = x; m_region.y = y;
+        m_region.sensorWidth = sensorW; m_region.sensorHeight = sensorH;
+        invalidate();
+    }
+
+    /// Use measured calibration maps (single channel, bottom row first):
+    /// DSNU offset in normalised signal units, hot pixel mask > 0.5 = hot.
+    /// The matching synthetic parameters no longer apply while a map is
+    /// set.  Maps cover the whole sensor; a chain region samples its
+    /// part.  nullptr returns to the synthetic map.
+    void setDSNUMap(osg::Image* measured)
+    {
+        if (m_measuredDSNU == measured) return;
+        m_measuredDSNU = measured;
+        invalidate();
+    }
+    void setHotPixelMask(osg::Image* measured)
+    {
+        if (m_measuredHot == measured) return;
+        m_measuredHot = measured;
+        invalidate();
+    }
 
 private:
+    /// Baked parameter: re-bake only when the value actually changes.
+    void setMapParameter(float& member, float value)
+    {
+        if (member == value) return;
+        member = value;
+        invalidate();
+    }
+
+    /// Re-bake now if the maps are in use, otherwise on setupUniforms().
+    void invalidate()
+    {
+        m_dirty = true;
+        if (m_attached) bakeMaps();
+    }
+
+    /// Measured maps are only cut to the region, into the image their
+    /// synthetic counterpart would use.
+    void bakeMaps()
+    {
+        if (!m_measuredDSNU.valid() || !m_measuredHot.valid())
+            FixedPatternMaps::bakeDark(m_dsnuImage, m_hotImage, m_region,
+                                       m_dsnuStrength, m_hotPixelProbability);
+        FixedPatternMaps::assign(m_dsnuMap, m_measuredDSNU.valid()
+            ? FixedPatternMaps::window(m_measuredDSNU, m_dsnuImage, m_region) : m_dsnuImage.get());
+        FixedPatternMaps::assign(m_hotMap, m_measuredHot.valid()
+            ? FixedPatternMaps::window(m_measuredHot, m_hotImage, m_region) : m_hotImage.get());
+        m_dirty = false;
+    }
+
     std::string m_shaderDir;
     float m_darkCurrent, m_dsnuStrength, m_hotPixelProbability, m_hotPixelStrength;
+    FixedPatternMaps::Region m_region;
+    bool m_dirty = true, m_attached = false;
 
     osg::ref_ptr<osg::Uniform> m_uDarkCurrent;
-    osg::ref_ptr<osg::Uniform> m_uDSNU;
-    osg::ref_ptr<osg::Uniform> m_uHotPixelProb;
     osg::ref_ptr<osg::Uniform> m_uHotPixelStr;
-    osg::ref_ptr<osg::Uniform> m_uFrameNumber;
-    osg::ref_ptr<osg::Uniform> m_uResolution;
-};
+    osg::ref_ptr<osg::Uniform> m_uDSNUMap;
+    osg::ref_ptr<osg::Uniform> m_uHotPixelMask;
 
-// ── Frame counter callback ──────────────────────────────────────────────
-class DarkNoiseFrameCallback : public osg::NodeCallback
-{
-public:
-    DarkNoiseFrameCallback(osg::ref_ptr<osg::Uniform> u) : m_u(u), m_f(0) {}
-    void operator()(osg::Node* node, osg::NodeVisitor* nv) override
-    {
-        m_u->set(m_f++);
-        traverse(node, nv);
-    }
-private:
-    osg::ref_ptr<osg::Uniform> m_u;
-    int m_f;
+    osg::ref_ptr<osg::Image>     m_dsnuImage, m_hotImage;
+    osg::ref_ptr<osg::Image>     m_measuredDSNU, m_measuredHot;
+    osg::ref_ptr<osg::Texture2D> m_dsnuMap, m_hotMap;
+    CpuKernels::MapPlane         m_cpuDSNU, m_cpuHot;
 };
-
-inline osg::ref_ptr<osg::NodeCallback> DarkNoiseEffect::createUpdateCallback()
-{
-    return new DarkNoiseFrameCallback(m_uFrameNumber);
-}
@@ -0,0 +1,74 @@
+#include "DefaultScene.h"
+
+#include <osg/Geode>
+#include <osg/ShapeDrawable>
+#include <osg/Material>
+#include <osg/Light>
+#include <osg/LightSource>
+
+// ============================================================================
+osg::ref_ptr<osg::Group> createDefaultScene()
+{
+    osg::ref_ptr<osg::Group> root = new osg::Group;
+
+    // Sphere
+    {
+        auto sphere = new osg::Sphere(osg::Vec3(0, 0, 0), 1.0f);
+        auto drawable = new osg::ShapeDrawable(sphere);
+        drawable->setColor(osg::Vec4(0.8f, 0.3f, 0.2f, 1.0f));
+
+        osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+        geode->addDrawable(drawable);
+
+        auto mat = new osg::Material;
+        mat->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.8f, 0.3f, 0.2f, 1.0f));
+        mat->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(1, 1, 1, 1));
+        mat->setShininess(osg::Material::FRONT_AND_BACK, 64.0f);
+        geode->getOrCreateStateSet()->setAttributeAndModes(mat);
+        root->addChild(geode);
+    }
+
+    // Ground plane
+    {
+        auto box = new osg::Box(osg::Vec3(0, 0, -1.2f), 8.0f, 8.0f, 0.1f);
+        auto drawable = new osg::ShapeDrawable(box);
+        drawable->setColor(osg::Vec4(0.4f, 0.4f, 0.5f, 1.0f));
+
+        osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+        geode->addDrawable(drawable);
+        root->addChild(geode);
+    }
+
+    // Second sphere
+    {
+        auto sphere = new osg::Sphere(osg::Vec3(2.0f, 1.0f, -0.5f), 0.5f);
+        auto drawable = new osg::ShapeDrawable(sphere);
+        drawable->setColor(osg::Vec4(0.2f, 0.6f, 0.9f, 1.0f));
+
+        osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+        geode->addDrawable(drawable);
+
+        auto mat = new osg::Material;
+        mat->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.6f, 0.9f, 1.0f));
+        mat->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(1, 1, 1, 1));
+        mat->setShininess(osg::Material::FRONT_AND_BACK, 32.0f);
+        geode->getOrCreateStateSet()->setAttributeAndModes(mat);
+        root->addChild(geode);
+    }
+
+    // Light
+    {
+        auto light = new osg::Light;
+        light->setLightNum(0);
+        light->setPosition(osg::Vec4(5, 5, 10, 1));
+        light->setDiffuse(osg::Vec4(1.0f, 0.95f, 0.85f, 1.0f));
+        light->setAmbient(osg::Vec4(0.15f, 0.15f, 0.2f, 1.0f));
+        light->setSpecular(osg::Vec4(1, 1, 1, 1));
+
+        auto ls = new osg::LightSource;
+        ls->setLight(light);
+        root->addChild(ls);
+    }
+
+    return root;
+}
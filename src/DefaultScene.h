@@ -0,0 +1,12 @@
+#pragma once
+// ============================================================================
+//  DefaultScene — Built-in lit test scene
+// ============================================================================
+//  Two spheres over a ground plane with one light.  Used by the demo when
+//  no model is given and by the benchmark, so both render the same pixels.
+// ============================================================================
+
+#include <osg/Group>
+#include <osg/ref_ptr>
+
+osg::ref_ptr<osg::Group> createDefaultScene();
@@ -0,0 +1,34 @@
+#pragma once
+// ============================================================================
+//  DemosaicEffect — Bilinear reconstruction of RGB from a CFA raw frame
+// ============================================================================
+//  Not a noise source: PostProcessChain appends it after the effects when
+//  CFA mode and demosaicing are both on (setDemosaicEnabled), so the
+//  noise is still sampled once per photosite and only the final image is
+//  full colour.  Self-contained shader, always its own pass.
+// ============================================================================
+
+#include "INoiseEffect.h"
+#include "ProgramCache.h"
+
+class DemosaicEffect : public INoiseEffect
+{
+public:
+    explicit DemosaicEffect(const std::string& shaderDir = "shaders")
+        : m_shaderDir(shaderDir)
+    {
+    }
+
+    std::string getName() const override { return "Demosaic"; }
+
+    std::string getFragmentSource() const override
+    {
+        return ProgramCache::instance().source(m_shaderDir + "/demosaic.frag");
+    }
+
+    // Reads u_inputTexture only (bound by the chain)
+    void setupUniforms(osg::StateSet*) override {}
+
+private:
+    std::string m_shaderDir;
+};
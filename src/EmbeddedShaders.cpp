@@ -0,0 +1,36 @@
+#include "EmbeddedShaders.h"
+
+#ifdef SENSORNOISE_EMBED_SHADERS
+#include "EmbeddedShaderData.inc"
+#endif
+
+namespace EmbeddedShaders
+{
+
+// ============================================================================
+const Entry* find(const std::string& path)
+{
+#ifdef SENSORNOISE_EMBED_SHADERS
+    const std::size_t slash = path.find_last_of("/\\");
+    const std::string name  = slash == std::string::npos ? path : path.substr(slash + 1);
+
+    for (const Entry& entry : kEmbeddedShaders)
+        if (name == entry.name)
+            return &entry;
+#else
+    (void)path;
+#endif
+    return nullptr;
+}
+
+// ============================================================================
+std::size_t count()
+{
+#ifdef SENSORNOISE_EMBED_SHADERS
+    return sizeof(kEmbeddedShaders) / sizeof(kEmbeddedShaders[0]);
+#else
+    return 0;
+#endif
+}
+
+} // namespace EmbeddedShaders
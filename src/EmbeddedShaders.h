@@ -0,0 +1,29 @@
+#pragma once
+// ============================================================================
+//  EmbeddedShaders — GLSL compiled into the binary
+// ============================================================================
+//  The build turns every file in shaders/ into a constexpr table
+//  (cmake/EmbedShaders.cmake), so the chain needs no shader files at run
+//  time.  Built with EMBED_SHADERS=OFF the table is empty and every
+//  lookup misses, which makes ProgramCache read from disk.
+// ============================================================================
+
+#include <cstddef>
+#include <string>
+
+namespace EmbeddedShaders
+{
+    struct Entry
+    {
+        const char* name;     ///< file name inside shaders/, e.g. "prnu.frag"
+        const unsigned char* source;   ///< UTF-8 bytes, NUL-terminated
+        std::size_t length;
+    };
+
+    /// Source of an embedded file by name (directory part ignored), or
+    /// nullptr if it was not embedded.
+    const Entry* find(const std::string& path);
+
+    /// Number of embedded files (0 when built without embedding).
+    std::size_t count();
+}
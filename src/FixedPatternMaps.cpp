@@ -0,0 +1,110 @@
+// ============================================================================
+//  FixedPatternMaps.cpp — CPU bake of PRNU / DSNU / hot-pixel maps
+// ============================================================================
+
+#include "FixedPatternMaps.h"
+#include "NoiseMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// ============================================================================
+osg::ref_ptr<osg::Texture2D> FixedPatternMaps::createMapTexture(GLint internalFormat)
+{
+    osg::ref_ptr<osg::Texture2D> tex = new osg::Texture2D;
+    tex->setInternalFormat(internalFormat);
+    tex->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::NEAREST);
+    tex->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::NEAREST);
+    tex->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+    tex->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+    tex->setResizeNonPowerOfTwoHint(false);
+    tex->setUnRefImageDataAfterApply(false);
+    return tex;
+}
+
+// ============================================================================
+void FixedPatternMaps::bakeGain(osg::Image* image, const Region& region, float prnuStrength)
+{
+    image->allocateImage(region.width, region.height, 1, GL_RED, GL_FLOAT);
+    image->setInternalTextureFormat(GL_R16F);
+
+    float* out = reinterpret_cast<float*>(image->data());
+    for (unsigned int y = region.y; y < region.y + region.height; ++y)
+    {
+        for (unsigned int x = region.x; x < region.x + region.width; ++x)
+        {
+            uint32_t state = NoiseMath::seedSpatial(x, y);
+            *out++ = 1.0f + prnuStrength * NoiseMath::randNormal(state);
+        }
+    }
+    image->dirty();
+}
+
+// ============================================================================
+void FixedPatternMaps::bakeDark(osg::Image* dsnu, osg::Image* hotPixels, const Region& region,
+                                float dsnuStrength, float hotPixelProbability)
+{
+    dsnu->allocateImage(region.width, region.height, 1, GL_RED, GL_FLOAT);
+    dsnu->setInternalTextureFormat(GL_R16F);
+    hotPixels->allocateImage(region.width, region.height, 1, GL_RED, GL_UNSIGNED_BYTE);
+    hotPixels->setInternalTextureFormat(GL_R8);
+
+    float*         offset = reinterpret_cast<float*>(dsnu->data());
+    unsigned char* hot    = hotPixels->data();
+    for (unsigned int y = region.y; y < region.y + region.height; ++y)
+    {
+        for (unsigned int x = region.x; x < region.x + region.width; ++x)
+        {
+            // Same draw order as the old per-pixel shader code
+            uint32_t state = NoiseMath::seedSpatial(x, y);
+            *offset++ = std::fabs(dsnuStrength * NoiseMath::randNormal(state));
+            *hot++    = NoiseMath::randFloat(state) < hotPixelProbability ? 255 : 0;
+        }
+    }
+    dsnu->dirty();
+    hotPixels->dirty();
+}
+
+// ============================================================================
+osg::Image* FixedPatternMaps::window(osg::Image* measured, osg::Image* window,
+                                     const Region& region)
+{
+    if (region.isWholeSensor() || measured->s() <= 0 || measured->t() <= 0)
+        return measured;
+
+    window->allocateImage(region.width, region.height, 1,
+                          measured->getPixelFormat(), measured->getDataType());
+    window->setInternalTextureFormat(measured->getInternalTextureFormat());
+
+    // Texel of sensor pixel p: floor((p + 0.5) / sensorSize * mapSize)
+    const unsigned int mapW = measured->s(), mapH = measured->t();
+    const unsigned int bytes = measured->getPixelSizeInBits() / 8;
+    for (unsigned int y = 0; y < region.height; ++y)
+    {
+        const double sy = (region.y + y + 0.5) / region.sensorHeight;
+        const unsigned int my = std::min(static_cast<unsigned int>(sy * mapH), mapH - 1);
+        unsigned char* out = window->data(0, y);
+        for (unsigned int x = 0; x < region.width; ++x, out += bytes)
+        {
+            const double sx = (region.x + x + 0.5) / region.sensorWidth;
+            const unsigned int mx = std::min(static_cast<unsigned int>(sx * mapW), mapW - 1);
+            std::memcpy(out, measured->data(mx, my), bytes);
+        }
+    }
+    window->dirty();
+    return window;
+}
+
+// ============================================================================
+void FixedPatternMaps::assign(osg::Texture2D* texture, osg::Image* image)
+{
+    if (texture->getImage() == image &&
+        texture->getTextureWidth()  == image->s() &&
+        texture->getTextureHeight() == image->t())
+        return;   // same storage; image->dirty() is enough
+
+    texture->setImage(image);
+    texture->setTextureSize(image->s(), image->t());
+    texture->dirtyTextureObject();
+}
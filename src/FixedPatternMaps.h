@@ -0,0 +1,76 @@
+#pragma once
+// ============================================================================
+//  FixedPatternMaps — Baked per-pixel sensor calibration maps
+// ============================================================================
+//  PRNU gain, DSNU offset and the hot-pixel mask never change between
+//  frames, so they are generated once on the CPU (NoiseMath, same RNG and
+//  seeds as the shader used to run per pixel) and sampled as textures.
+//
+//  Maps are single-channel, bottom row first (GL convention):
+//    gain  R16F   1 + sigma * N(0,1)
+//    dsnu  R16F   |sigma * N(0,1)|
+//    hot   R8     255 = hot pixel, 0 = normal
+//
+//  Measured calibration maps from a real sensor can be dropped into the same
+//  textures; they are sampled with normalised coordinates and NEAREST
+//  filtering, so they need not match the render resolution.
+//
+//  A chain that renders one tile of a larger sensor gets the maps of its
+//  Region only: synthetic maps are baked from the sensor coordinates, so
+//  neighbouring tiles join without a seam, and measured maps (which cover
+//  the whole sensor) are cut to the tile by window().
+// ============================================================================
+
+#include <osg/Image>
+#include <osg/Texture2D>
+#include <osg/ref_ptr>
+
+namespace FixedPatternMaps
+{
+    /// Texture units used by the effects.  Unit 0 is the chain input; the
+    /// units are distinct so effects can share a fused pass.
+    enum TextureUnit : unsigned int
+    {
+        GAIN_MAP_UNIT  = 1,
+        DSNU_MAP_UNIT  = 2,
+        HOT_PIXEL_UNIT = 3
+    };
+
+    /// The part of the sensor a chain renders: width x height pixels from
+    /// (x, y) of a sensorWidth x sensorHeight sensor, rows bottom first.
+    struct Region
+    {
+        unsigned int x = 0, y = 0;
+        unsigned int width = 1280, height = 720;
+        unsigned int sensorWidth = 1280, sensorHeight = 720;
+
+        bool isWholeSensor() const
+        {
+            return x == 0 && y == 0 && width == sensorWidth && height == sensorHeight;
+        }
+    };
+
+    /// NEAREST, CLAMP_TO_EDGE map texture.  The image is kept after upload so
+    /// it can be regenerated in place.
+    osg::ref_ptr<osg::Texture2D> createMapTexture(GLint internalFormat);
+
+    /// Fill `image` (reallocated to the region size, GL_RED / GL_FLOAT)
+    /// with PRNU gain.
+    void bakeGain(osg::Image* image, const Region& region, float prnuStrength);
+
+    /// Fill the DSNU offset map (GL_RED / GL_FLOAT) and the hot-pixel mask
+    /// (GL_RED / GL_UNSIGNED_BYTE).  Both come from one RNG stream per pixel
+    /// and are always baked together.
+    void bakeDark(osg::Image* dsnu, osg::Image* hotPixels, const Region& region,
+                  float dsnuStrength, float hotPixelProbability);
+
+    /// The texels of a whole-sensor `measured` map that `region` samples,
+    /// NEAREST at the pixel centres, copied into `window` at the region
+    /// size (same pixel format).  Returns `measured` itself when the
+    /// region is the whole sensor, `window` otherwise.
+    osg::Image* window(osg::Image* measured, osg::Image* window, const Region& region);
+
+    /// Point `texture` at `image`.  Forces a full re-upload when the size
+    /// changed, otherwise the next apply subloads the dirty image.
+    void assign(osg::Texture2D* texture, osg::Image* image);
+}
@@ -0,0 +1,405 @@
+#include "FrameWriter.h"
+
+#include <osg/Image>
+#include <osg/Timer>
+#include <osgDB/WriteFile>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// ── Pixel access helpers ────────────────────────────────────────────────────
+static unsigned int numComponents(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RED:
+    case GL_LUMINANCE: return 1;
+    case GL_RG:        return 2;
+    case GL_RGB:       return 3;
+    default:           return 4;
+    }
+}
+
+// Channels written to disk: colour frames drop alpha, mono stays mono.
+static unsigned int numOutputChannels(const ReadbackFrame& f)
+{
+    return numComponents(f.format) >= 3 ? 3u : 1u;
+}
+
+// Component c of pixel (x, y) in top-down row order, normalised to [0,1]
+// for integer types and passed through for float types.
+static float sample(const ReadbackFrame& f, unsigned int x, unsigned int y, unsigned int c)
+{
+    const unsigned int comps = numComponents(f.format);
+    const std::size_t  index = (std::size_t(f.height - 1 - y) * f.width + x) * comps + c;
+
+    switch (f.type)
+    {
+    case GL_UNSIGNED_SHORT:
+        return reinterpret_cast<const std::uint16_t*>(f.data.data())[index] / 65535.0f;
+    case GL_FLOAT:
+        return reinterpret_cast<const float*>(f.data.data())[index];
+    default:
+        return f.data[index] / 255.0f;
+    }
+}
+
+static std::uint16_t toUnorm16(float v)
+{
+    v = std::min(std::max(v, 0.0f), 1.0f);
+    return static_cast<std::uint16_t>(v * 65535.0f + 0.5f);
+}
+
+// IEEE 754 binary32 -> binary16, round to nearest even.
+static std::uint16_t toHalf(float value)
+{
+    std::uint32_t f;
+    std::memcpy(&f, &value, 4);
+    std::uint32_t sign = (f >> 16) & 0x8000u;
+    std::int32_t  exp  = std::int32_t((f >> 23) & 0xFFu) - 127 + 15;
+    std::uint32_t mant = f & 0x7FFFFFu;
+
+    if (((f >> 23) & 0xFFu) == 0xFFu)                 // Inf / NaN
+        return std::uint16_t(sign | 0x7C00u | (mant ? 0x200u : 0u));
+    if (exp >= 31)                                    // overflow
+        return std::uint16_t(sign | 0x7C00u);
+    if (exp <= 0)                                     // subnormal / zero
+    {
+        if (exp < -10)
+            return std::uint16_t(sign);
+        mant |= 0x800000u;
+        std::uint32_t shift = std::uint32_t(14 - exp);
+        std::uint32_t half  = mant >> shift;
+        std::uint32_t rem   = mant & ((1u << shift) - 1u);
+        std::uint32_t mid   = 1u << (shift - 1);
+        if (rem > mid || (rem == mid && (half & 1u)))
+            ++half;
+        return std::uint16_t(sign | half);
+    }
+
+    std::uint32_t half = sign | (std::uint32_t(exp) << 10) | (mant >> 13);
+    std::uint32_t rem  = mant & 0x1FFFu;
+    if (rem > 0x1000u || (rem == 0x1000u && (half & 1u)))
+        ++half;                                       // may carry into exponent
+    return std::uint16_t(half);
+}
+
+// ── Little-endian stream writers ────────────────────────────────────────────
+static void put16(std::vector<char>& b, std::uint16_t v)
+{
+    b.push_back(char(v & 0xFF));
+    b.push_back(char(v >> 8));
+}
+static void put32(std::vector<char>& b, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        b.push_back(char((v >> (8 * i)) & 0xFF));
+}
+static void put64(std::vector<char>& b, std::uint64_t v)
+{
+    for (int i = 0; i < 8; ++i)
+        b.push_back(char((v >> (8 * i)) & 0xFF));
+}
+static void putString(std::vector<char>& b, const char* s)
+{
+    b.insert(b.end(), s, s + std::strlen(s) + 1);
+}
+
+static bool writeBuffer(const std::string& path, const std::vector<char>& buffer)
+{
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.is_open())
+        return false;
+    ofs.write(buffer.data(), std::streamsize(buffer.size()));
+    return bool(ofs);
+}
+
+// ── Encoders ────────────────────────────────────────────────────────────────
+static bool writeRaw16(const ReadbackFrame& f, const std::string& path)
+{
+    const unsigned int ch = numOutputChannels(f);
+    std::vector<std::uint16_t> out(std::size_t(f.width) * f.height * ch);
+
+    std::size_t i = 0;
+    for (unsigned int y = 0; y < f.height; ++y)
+        for (unsigned int x = 0; x < f.width; ++x)
+            for (unsigned int c = 0; c < ch; ++c)
+                out[i++] = toUnorm16(sample(f, x, y, c));
+
+    std::ofstream ofs(path, std::ios::binary);
+    if (!ofs.is_open())
+        return false;
+    ofs.write(reinterpret_cast<const char*>(out.data()),
+              std::streamsize(out.size() * sizeof(std::uint16_t)));
+    return bool(ofs);
+}
+
+static bool writeTiff16(const ReadbackFrame& f, const std::string& path)
+{
+    const unsigned int ch        = numOutputChannels(f);
+    const std::uint32_t dataSize = f.width * f.height * ch * 2;
+    const std::uint16_t numTags  = 10;
+    const std::uint32_t ifdSize  = 2 + numTags * 12 + 4;
+    const std::uint32_t bpsOffset  = 8 + ifdSize;            // BitsPerSample[3]
+    const std::uint32_t dataOffset = bpsOffset + 8;
+
+    std::vector<char> b;
+    b.reserve(dataOffset + dataSize);
+
+    // Header: little endian, magic 42, first IFD at 8
+    b.push_back('I'); b.push_back('I');
+    put16(b, 42);
+    put32(b, 8);
+
+    auto tag = [&b](std::uint16_t id, std::uint16_t type, std::uint32_t count, std::uint32_t value)
+    {
+        put16(b, id); put16(b, type); put32(b, count);
+        if (type == 3 && count == 1) { put16(b, std::uint16_t(value)); put16(b, 0); }
+        else                         put32(b, value);
+    };
+    const std::uint16_t SHORT = 3, LONG = 4;
+
+    put16(b, numTags);
+    tag(256, LONG,  1, f.width);                       // ImageWidth
+    tag(257, LONG,  1, f.height);                      // ImageLength
+    if (ch == 1) tag(258, SHORT, 1, 16);               // BitsPerSample
+    else         tag(258, SHORT, ch, bpsOffset);
+    tag(259, SHORT, 1, 1);                             // Compression: none
+    tag(262, SHORT, 1, ch == 1 ? 1 : 2);               // BlackIsZero / RGB
+    tag(273, LONG,  1, dataOffset);                    // StripOffsets
+    tag(277, SHORT, 1, ch);                            // SamplesPerPixel
+    tag(278, LONG,  1, f.height);                      // RowsPerStrip
+    tag(279, LONG,  1, dataSize);                      // StripByteCounts
+    tag(284, SHORT, 1, 1);                             // PlanarConfig: chunky
+    put32(b, 0);                                       // no next IFD
+
+    for (int i = 0; i < 4; ++i)
+        put16(b, 16);
+
+    for (unsigned int y = 0; y < f.height; ++y)
+        for (unsigned int x = 0; x < f.width; ++x)
+            for (unsigned int c = 0; c < ch; ++c)
+                put16(b, toUnorm16(sample(f, x, y, c)));
+
+    return writeBuffer(path, b);
+}
+
+static bool writeExr16(const ReadbackFrame& f, const std::string& path)
+{
+    const unsigned int ch = numOutputChannels(f);
+
+    // Channels must be listed (and stored) in alphabetical order.
+    const char*  names[3]  = { "B", "G", "R" };
+    const unsigned int src[3] = { 2, 1, 0 };
+    if (ch == 1)
+        names[0] = "Y";
+
+    std::vector<char> b;
+    put32(b, 20000630);                        // magic
+    put32(b, 2);                               // version 2, scanline
+
+    auto attr = [&b](const char* name, const char* type, std::uint32_t size)
+    {
+        putString(b, name); putString(b, type); put32(b, size);
+    };
+
+    attr("channels", "chlist", ch * 18 + 1);
+    for (unsigned int c = 0; c < ch; ++c)
+    {
+        putString(b, names[c]);
+        put32(b, 1);                           // HALF
+        put32(b, 0);                           // pLinear + reserved
+        put32(b, 1);                           // xSampling
+        put32(b, 1);                           // ySampling
+    }
+    b.push_back(0);
+
+    attr("compression", "compression", 1);  b.push_back(0);       // NO_COMPRESSION
+    attr("dataWindow", "box2i", 16);
+    put32(b, 0); put32(b, 0); put32(b, f.width - 1); put32(b, f.height - 1);
+    attr("displayWindow", "box2i", 16);
+    put32(b, 0); put32(b, 0); put32(b, f.width - 1); put32(b, f.height - 1);
+    attr("lineOrder", "lineOrder", 1);      b.push_back(0);       // INCREASING_Y
+    float one = 1.0f, zero = 0.0f;
+    std::uint32_t oneBits, zeroBits;
+    std::memcpy(&oneBits, &one, 4);
+    std::memcpy(&zeroBits, &zero, 4);
+    attr("pixelAspectRatio", "float", 4);   put32(b, oneBits);
+    attr("screenWindowCenter", "v2f", 8);   put32(b, zeroBits); put32(b, zeroBits);
+    attr("screenWindowWidth", "float", 4);  put32(b, oneBits);
+    b.push_back(0);                            // end of header
+
+    // Offset table, then one scanline per block
+    const std::uint32_t lineBytes = f.width * ch * 2;
+    const std::uint64_t tableEnd  = b.size() + std::uint64_t(f.height) * 8;
+    for (unsigned int y = 0; y < f.height; ++y)
+        put64(b, tableEnd + std::uint64_t(y) * (8 + lineBytes));
+
+    for (unsigned int y = 0; y < f.height; ++y)
+    {
+        put32(b, y);
+        put32(b, lineBytes);
+        for (unsigned int c = 0; c < ch; ++c)
+            for (unsigned int x = 0; x < f.width; ++x)
+                put16(b, toHalf(sample(f, x, y, ch == 1 ? 0 : src[c])));
+    }
+
+    return writeBuffer(path, b);
+}
+
+static bool writeOsgDB(const ReadbackFrame& f, const std::string& path)
+{
+    // osgDB plugins expect OSG's bottom-up image layout, which is what
+    // the readback delivers.  They know mono frames as luminance.
+    const GLenum format = f.format == GL_RED ? GL_LUMINANCE : f.format;
+    osg::ref_ptr<osg::Image> image = new osg::Image;
+    image->setImage(f.width, f.height, 1, format, format, f.type,
+                    const_cast<unsigned char*>(f.data.data()), osg::Image::NO_DELETE);
+    return osgDB::writeImageFile(*image, path);
+}
+
+// ============================================================================
+FrameWriterPool::FrameWriterPool(const std::string& extension, unsigned int threads,
+                                 std::size_t capacity)
+    : m_extension(extension)
+    , m_format(formatForExtension(extension))
+    , m_queue(capacity)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    m_numThreads = threads;
+    for (unsigned int i = 0; i < threads; ++i)
+        m_threads.emplace_back(&FrameWriterPool::workerLoop, this);
+}
+
+// ============================================================================
+FrameWriterPool::~FrameWriterPool()
+{
+    finish();
+}
+
+// ============================================================================
+FrameWriterPool::Format FrameWriterPool::formatForExtension(const std::string& extension)
+{
+    std::string ext = extension;
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == "raw")                 return Format::Raw16;
+    if (ext == "tif" || ext == "tiff") return Format::Tiff16;
+    if (ext == "exr")                 return Format::Exr16;
+    return Format::OsgDB;
+}
+
+// ============================================================================
+void FrameWriterPool::submit(ReadbackFrame&& frame, const std::string& basePath)
+{
+    Job job{ std::move(frame), basePath };
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+
+    if (!m_queue.tryPush(job))
+    {
+        // Queue full: the writers are behind.  Wait, and account for it.
+        const osg::Timer_t start = osg::Timer::instance()->tick();
+        m_stalls.fetch_add(1, std::memory_order_relaxed);
+        m_queue.pushWait(job, [] { return false; });
+        const double us = osg::Timer::instance()->delta_u(start, osg::Timer::instance()->tick());
+        m_stallUs.fetch_add(std::uint64_t(us), std::memory_order_relaxed);
+    }
+
+    std::size_t depth = m_queue.size();
+    std::size_t prev  = m_maxDepth.load(std::memory_order_relaxed);
+    while (depth > prev && !m_maxDepth.compare_exchange_weak(prev, depth, std::memory_order_relaxed))
+        ;
+}
+
+// ============================================================================
+void FrameWriterPool::finish()
+{
+    m_stop.store(true, std::memory_order_release);
+    for (auto& t : m_threads)
+        if (t.joinable())
+            t.join();
+    m_threads.clear();
+}
+
+// ============================================================================
+void FrameWriterPool::workerLoop()
+{
+    osg::Timer* timer = osg::Timer::instance();
+    Job job;
+
+    for (;;)
+    {
+        const osg::Timer_t waitStart = timer->tick();
+        const bool got = m_queue.popWait(job, [this] { return m_stop.load(std::memory_order_acquire); });
+        const osg::Timer_t encodeStart = timer->tick();
+        m_idleUs.fetch_add(std::uint64_t(timer->delta_u(waitStart, encodeStart)),
+                           std::memory_order_relaxed);
+
+        // Stop only once the queue has drained.
+        if (!got)
+            return;
+
+        bool ok = encode(job);
+        (ok ? m_written : m_failed).fetch_add(1, std::memory_order_relaxed);
+        if (!ok)
+            std::cerr << "[FrameWriter] ERROR: Cannot write "
+                      << job.basePath << "." << m_extension << "\n";
+
+        m_encodeUs.fetch_add(std::uint64_t(timer->delta_u(encodeStart, timer->tick())),
+                             std::memory_order_relaxed);
+        job = Job();
+    }
+}
+
+// ============================================================================
+bool FrameWriterPool::encode(const Job& job) const
+{
+    const std::string path = job.basePath + "." + m_extension;
+    switch (m_format)
+    {
+    case Format::Raw16:  return writeRaw16(job.frame, path);
+    case Format::Tiff16: return writeTiff16(job.frame, path);
+    case Format::Exr16:  return writeExr16(job.frame, path);
+    default:             return writeOsgDB(job.frame, path);
+    }
+}
+
+// ============================================================================
+FrameWriterPool::Stats FrameWriterPool::getStats() const
+{
+    Stats s;
+    s.submitted = m_submitted.load();
+    s.written   = m_written.load();
+    s.failed    = m_failed.load();
+    s.stalls    = m_stalls.load();
+    s.stallMs   = m_stallUs.load()  / 1000.0;
+    s.encodeMs  = m_encodeUs.load() / 1000.0;
+    s.idleMs    = m_idleUs.load()   / 1000.0;
+    s.maxDepth  = m_maxDepth.load();
+    return s;
+}
+
+// ============================================================================
+void FrameWriterPool::printStats(std::ostream& os, double wallSeconds) const
+{
+    Stats s = getStats();
+    const double wallMs = wallSeconds * 1000.0;
+    const double busy   = s.encodeMs + s.idleMs > 0.0
+                        ? s.encodeMs / (s.encodeMs + s.idleMs) : 0.0;
+
+    os << "[FrameWriter] " << s.written << "/" << s.submitted << " frames written ("
+       << s.failed << " failed) by " << m_numThreads << " threads\n"
+       << "[FrameWriter] Queue high-water " << s.maxDepth << "/" << m_queue.capacity()
+       << ", producer stalls " << s.stalls << " (" << s.stallMs << " ms)\n"
+       << "[FrameWriter] Encoder utilisation " << (busy * 100.0) << " %, "
+       << (s.written ? s.encodeMs / s.written : 0.0) << " ms/frame\n";
+
+    if (wallMs > 0.0 && s.stallMs > 0.05 * wallMs)
+        os << "[FrameWriter] Bottleneck: writers (disk/encode) -- add threads or a cheaper format\n";
+    else if (busy < 0.5)
+        os << "[FrameWriter] Bottleneck: rendering/readback (writers mostly idle)\n";
+}
@@ -0,0 +1,94 @@
+#pragma once
+// ============================================================================
+//  FrameWriter — Encoder thread pool for dataset export
+// ============================================================================
+//  Read-back frames are handed over through a lock-free BoundedFrameQueue
+//  and encoded by a pool of worker threads, so PNG compression and disk
+//  I/O never run on the OSG draw thread.
+//
+//  Formats (chosen by extension):
+//    raw           16-bit unsigned, interleaved, top-down, host byte order
+//    tif / tiff    uncompressed 16-bit baseline TIFF
+//    exr           uncompressed half-float OpenEXR (scanline)
+//    anything else osgDB image writer (png, jpg, ...; 8-bit)
+//
+//  Backpressure: when the queue is full, submit() spins and the time is
+//  counted as a producer stall.  Stalls mean the writers (disk/encode)
+//  are the bottleneck; idle writers mean the GPU is.
+// ============================================================================
+
+#include "BoundedFrameQueue.h"
+#include "PboReadback.h"
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FrameWriterPool
+{
+public:
+    enum class Format { OsgDB, Tiff16, Exr16, Raw16 };
+
+    struct Stats
+    {
+        std::uint64_t submitted = 0;
+        std::uint64_t written   = 0;
+        std::uint64_t failed    = 0;
+        std::uint64_t stalls    = 0;    ///< submits that found the queue full
+        double        stallMs   = 0.0;  ///< producer time spent waiting
+        double        encodeMs  = 0.0;  ///< summed over all workers
+        double        idleMs    = 0.0;  ///< summed over all workers
+        std::size_t   maxDepth  = 0;    ///< queue high-water mark
+    };
+
+    /// @param extension  Output format, see above (without the dot)
+    /// @param threads    Encoder threads; 0 = hardware concurrency
+    /// @param capacity   Queue slots (frames in flight)
+    FrameWriterPool(const std::string& extension, unsigned int threads = 0,
+                    std::size_t capacity = 16);
+    ~FrameWriterPool();
+
+    static Format formatForExtension(const std::string& extension);
+
+    /// Queue a frame for encoding to basePath + "." + extension.
+    /// Safe to call from the draw thread; waits only while the queue is full.
+    void submit(ReadbackFrame&& frame, const std::string& basePath);
+
+    /// Block until every submitted frame is written, then stop the workers.
+    void finish();
+
+    Stats getStats() const;
+    void  printStats(std::ostream& os, double wallSeconds) const;
+
+    unsigned int getNumThreads() const { return m_numThreads; }
+
+private:
+    struct Job
+    {
+        ReadbackFrame frame;
+        std::string   basePath;
+    };
+
+    void workerLoop();
+    bool encode(const Job& job) const;
+
+    std::string m_extension;
+    Format      m_format;
+
+    BoundedFrameQueue<Job>   m_queue;
+    std::vector<std::thread> m_threads;
+    unsigned int             m_numThreads = 0;
+    std::atomic<bool>        m_stop{ false };
+
+    std::atomic<std::uint64_t> m_submitted{ 0 };
+    std::atomic<std::uint64_t> m_written{ 0 };
+    std::atomic<std::uint64_t> m_failed{ 0 };
+    std::atomic<std::uint64_t> m_stalls{ 0 };
+    std::atomic<std::uint64_t> m_stallUs{ 0 };
+    std::atomic<std::uint64_t> m_encodeUs{ 0 };
+    std::atomic<std::uint64_t> m_idleUs{ 0 };
+    std::atomic<std::size_t>   m_maxDepth{ 0 };
+};
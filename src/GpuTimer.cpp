@@ -0,0 +1,182 @@
+#include "GpuTimer.h"
+
+#include <osg/GLExtensions>
+#include <osg/State>
+
+#include <algorithm>
+#include <iostream>
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+
+// Forwards a camera's pre/post draw to the timer.
+class GpuTimerCallback : public osg::Camera::DrawCallback
+{
+public:
+    GpuTimerCallback(GpuTimer* timer, unsigned int index, bool begin)
+        : m_timer(timer), m_index(index), m_begin(begin) {}
+
+    void operator()(osg::RenderInfo& renderInfo) const override
+    {
+        if (m_begin) m_timer->begin(m_index, renderInfo);
+        else         m_timer->end(m_index, renderInfo);
+    }
+
+private:
+    osg::ref_ptr<GpuTimer> m_timer;
+    unsigned int           m_index;
+    bool                   m_begin;
+};
+
+// ============================================================================
+GpuTimer::GpuTimer(unsigned int ringSize, unsigned int window)
+    : m_ringSize(ringSize < 2 ? 2 : ringSize)
+    , m_window(window < 1 ? 1 : window)
+{
+}
+
+// ============================================================================
+void GpuTimer::attach(osg::Camera* camera, const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const unsigned int index = static_cast<unsigned int>(m_timed.size());
+    Timed t;
+    t.name = name;
+    t.ring.resize(m_ringSize);
+    m_timed.push_back(std::move(t));
+
+    camera->setPreDrawCallback(new GpuTimerCallback(this, index, true));
+    camera->setPostDrawCallback(new GpuTimerCallback(this, index, false));
+}
+
+// ============================================================================
+void GpuTimer::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& t : m_timed)
+        t.samples.clear();
+}
+
+// ============================================================================
+bool GpuTimer::openCsv(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_csv.open(path);
+    if (!m_csv.is_open())
+    {
+        std::cerr << "[GpuTimer] ERROR: Cannot open " << path << "\n";
+        return false;
+    }
+    m_csv << "frame,pass,ms\n";
+    return true;
+}
+
+// ============================================================================
+void GpuTimer::begin(unsigned int index, osg::RenderInfo& renderInfo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_supported || index >= m_timed.size())
+        return;
+
+    osg::State* state = renderInfo.getState();
+    const osg::GLExtensions* ext = state->get<osg::GLExtensions>();
+    if (!ext->isTimerQuerySupported && !ext->isARBTimerQuerySupported)
+    {
+        std::cerr << "[GpuTimer] WARNING: Timer queries not supported; GPU timing disabled.\n";
+        m_supported = false;
+        return;
+    }
+
+    Timed& t = m_timed[index];
+    if (t.ring[0].id == 0)
+        for (auto& q : t.ring)
+            ext->glGenQueries(1, &q.id);
+
+    collect(t, ext);
+
+    // A slot still in flight after a full ring is dropped, never waited on
+    Query& q = t.ring[t.next];
+    q.pending = false;
+    q.frameNumber = state->getFrameStamp()
+                  ? state->getFrameStamp()->getFrameNumber() : 0;
+    ext->glBeginQuery(GL_TIME_ELAPSED, q.id);
+}
+
+// ============================================================================
+void GpuTimer::end(unsigned int index, osg::RenderInfo& renderInfo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_supported || index >= m_timed.size())
+        return;
+
+    Timed& t = m_timed[index];
+    if (t.ring[0].id == 0)
+        return;   // begin() has not run
+
+    const osg::GLExtensions* ext = renderInfo.getState()->get<osg::GLExtensions>();
+    ext->glEndQuery(GL_TIME_ELAPSED);
+    t.ring[t.next].pending = true;
+    t.next = (t.next + 1) % t.ring.size();
+}
+
+// ============================================================================
+void GpuTimer::collect(Timed& t, const osg::GLExtensions* ext)
+{
+    // Oldest first, starting at the slot about to be reused
+    for (size_t n = 0; n < t.ring.size(); ++n)
+    {
+        Query& q = t.ring[(t.next + n) % t.ring.size()];
+        if (!q.pending)
+            continue;
+
+        GLint available = 0;
+        ext->glGetQueryObjectiv(q.id, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;   // later queries cannot be done either
+
+        GLuint64 ns = 0;
+        ext->glGetQueryObjectui64v(q.id, GL_QUERY_RESULT, &ns);
+        q.pending = false;
+
+        const double ms = ns * 1e-6;
+        t.samples.push_back(ms);
+        if (t.samples.size() > m_window)
+            t.samples.pop_front();
+
+        if (m_csv.is_open())
+            m_csv << q.frameNumber << ',' << t.name << ',' << ms << '\n';
+    }
+}
+
+// ============================================================================
+std::vector<GpuTimer::Timing> GpuTimer::getTimings() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<Timing> result;
+    result.reserve(m_timed.size());
+    for (auto& t : m_timed)
+    {
+        Timing timing;
+        timing.name = t.name;
+        timing.samples = static_cast<unsigned int>(t.samples.size());
+        if (!t.samples.empty())
+        {
+            std::vector<double> sorted(t.samples.begin(), t.samples.end());
+            std::sort(sorted.begin(), sorted.end());
+
+            double sum = 0.0;
+            for (double ms : sorted)
+                sum += ms;
+
+            timing.minMs = sorted.front();
+            timing.avgMs = sum / sorted.size();
+            timing.p99Ms = sorted[std::min(sorted.size() - 1,
+                                           static_cast<size_t>(sorted.size() * 0.99))];
+        }
+        result.push_back(timing);
+    }
+    return result;
+}
@@ -0,0 +1,88 @@
+#pragma once
+// ============================================================================
+//  GpuTimer — GL_TIME_ELAPSED instrumentation for RTT cameras
+// ============================================================================
+//  attach() wraps a camera's draw in a GL_TIME_ELAPSED query from its
+//  pre-draw to its post-draw callback (the final-draw slot stays free for
+//  readback).  Each camera owns a small ring of queries; a result is only
+//  read once GL_QUERY_RESULT_AVAILABLE says so, so the CPU never waits on
+//  the GPU.  Results land a few frames late; a query still in flight when
+//  its slot comes round again is dropped rather than waited for.
+//
+//  getTimings() reports min / avg / p99 over the last `window` samples
+//  per camera name.  Optionally every sample is appended to a CSV file
+//  (frame,pass,ms).  One GL context only.
+// ============================================================================
+
+#include <osg/Camera>
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class GpuTimer : public osg::Referenced
+{
+public:
+    struct Timing
+    {
+        std::string  name;
+        double       minMs = 0.0;
+        double       avgMs = 0.0;
+        double       p99Ms = 0.0;
+        unsigned int samples = 0;
+    };
+
+    GpuTimer(unsigned int ringSize = 4, unsigned int window = 240);
+
+    /// Time every draw of `camera` under `name`.  Call before the first
+    /// frame; replaces the camera's pre- and post-draw callbacks.
+    void attach(osg::Camera* camera, const std::string& name);
+
+    /// Rolling statistics, one entry per attached camera, in attach order.
+    std::vector<Timing> getTimings() const;
+
+    /// Forget collected samples (e.g. after warm-up).  Queries in flight
+    /// still land.
+    void reset();
+
+    /// Append every resolved sample to `path`.  Returns false if the file
+    /// cannot be opened.
+    bool openCsv(const std::string& path);
+
+    /// Called by the draw callbacks (draw thread).
+    void begin(unsigned int index, osg::RenderInfo& renderInfo);
+    void end(unsigned int index, osg::RenderInfo& renderInfo);
+
+protected:
+    ~GpuTimer() override = default;
+
+private:
+    struct Query
+    {
+        GLuint       id = 0;
+        bool         pending = false;
+        unsigned int frameNumber = 0;
+    };
+
+    struct Timed
+    {
+        std::string          name;
+        std::vector<Query>   ring;
+        unsigned int         next = 0;
+        std::deque<double>   samples;   ///< ms, newest at the back
+    };
+
+    /// Read back every finished query of `t` without blocking.
+    void collect(Timed& t, const osg::GLExtensions* ext);
+
+    unsigned int       m_ringSize;
+    unsigned int       m_window;
+    bool               m_supported = true;
+    std::vector<Timed> m_timed;
+    std::ofstream      m_csv;
+    mutable std::mutex m_mutex;
+};
@@ -3,13 +3,17 @@
 //  INoiseEffect — Interface for modular noise effects
 // ============================================================================
 //  Each noise type implements this interface.  The PostProcessChain uses
-//  it to build a multi-pass pipeline.
+//  it to build either a multi-pass pipeline or a single fused pass.
 // ============================================================================
 
 #include <osg/StateSet>
 #include <osg/NodeCallback>
+#include <osg/Uniform>
 #include <osg/ref_ptr>
 #include <string>
+#include <vector>
+
+namespace CpuKernels { struct Tile; }
 
 class INoiseEffect
 {
@@ -18,15 +22,96 @@ public:
 
     /// Return the fragment shader source (without #version or noise_utils).
     /// The chain will prepend #version and noise_utils.glsl automatically.
+    /// If getApplyFunction() is non-empty the source only declares the
+    /// effect's own uniforms plus that function; the chain supplies the
+    /// shared inputs (v_texCoord, u_inputTexture and the NoiseChainBlock
+    /// members u_resolution, u_frameNumber, u_exposure, u_time, u_seed,
+    /// u_tileOffset, u_sensorSize) and generates main().  Self-contained
+    /// shaders get the block too and must not declare those names
+    /// themselves.
     virtual std::string getFragmentSource() const = 0;
 
+    /// Name of the GLSL function defined by getFragmentSource(), with the
+    /// signature  vec3 fn(vec3 color, vec2 fragCoord),  fragCoord being the
+    /// pixel centre on the sensor (u_tileOffset added for tiles).
+    /// Effects that provide one can be fused with their neighbours into a
+    /// single pass.  Return an empty string for a self-contained shader
+    /// with its own main() (multi-pass only).
+    virtual std::string getApplyFunction() const { return {}; }
+
+    /// Feature keys of the current parameters: macros the chain defines
+    /// (as 1) in front of the effect's source, so sub-features that are
+    /// off compile out instead of being branched around.  Fused effects
+    /// share one program, so keys carry the effect's name
+    /// (DARK_HOT_PIXELS, READ_FAST_NORMALS, ...).  The chain rechecks the
+    /// keys every update traversal and swaps in the matching permutation,
+    /// compiled on first use and cached from then on.
+    virtual std::vector<std::string> getFeatureKeys() const { return {}; }
+
     /// Attach effect-specific uniforms to the given StateSet.
     virtual void setupUniforms(osg::StateSet* ss) = 0;
 
-    /// Optional per-frame update callback (e.g. frame counter).
-    /// Return nullptr if not needed.
+    /// Optional per-frame update callback.  Return nullptr if not needed;
+    /// the frame number and time come from the chain's uniform block.
+    /// It runs in the update traversal, which in the threaded viewer
+    /// models overlaps the previous frame's draw: it may change the
+    /// uniforms and textures added in setupUniforms() (the chain marks
+    /// them DYNAMIC), but must not touch other state the draw reads.
+    /// Parameter setters follow the same rule: call them from the viewer
+    /// thread (update or event handlers), never from another thread.
     virtual osg::ref_ptr<osg::NodeCallback> createUpdateCallback() { return nullptr; }
 
+    /// Size of the chain the effect runs in, set by the chain on build.
+    /// Effects with per-pixel maps re-bake them when it changes.
+    virtual void setResolution(unsigned int /*width*/, unsigned int /*height*/) {}
+
+    /// Where that frame lies on the sensor: its pixels start at (x, y) of
+    /// a sensorWidth x sensorHeight sensor (PostProcessChain::setRegion()).
+    /// Set by the chain on build and whenever it changes; effects with
+    /// per-pixel maps line them up with it.
+    virtual void setRegion(unsigned int /*x*/, unsigned int /*y*/,
+                           unsigned int /*sensorWidth*/, unsigned int /*sensorHeight*/) {}
+
+    /// Texture unit of u_historyTexture for temporal stages.
+    static const unsigned int HISTORY_UNIT = 5;
+
+    /// Temporal stages merge getSubFrames() consecutive frames into one
+    /// output.  The chain keeps the stage's previous output on
+    /// HISTORY_UNIT, calls beginSubFrame() every frame and runs the passes
+    /// after the stage only once the last sub-frame has been merged.
+    /// Self-contained shader only (never fused).
+    virtual bool         isTemporal() const   { return false; }
+    virtual unsigned int getSubFrames() const { return 1; }
+    virtual void         beginSubFrame(unsigned int /*index*/) {}
+
+    /// CPU reference path (CpuNoiseChain).  prepareCpu() runs on the
+    /// calling thread before each frame and returns false if the effect
+    /// has none; processCpu() then runs once per row band, several bands
+    /// at a time, and must only read the effect's state.
+    virtual bool prepareCpu(unsigned int /*width*/, unsigned int /*height*/) { return false; }
+    virtual void processCpu(const CpuKernels::Tile& /*tile*/) const {}
+
+    /// Default RNG stream IDs of the built-in effects with temporal draws.
+    enum StreamId : unsigned int { PHOTON_STREAM = 1, DARK_STREAM = 2, READ_STREAM = 3 };
+
+    /// Stream of the effect's temporal draws (rng_stream(), 0-255).  Two
+    /// instances of the same effect in one chain need different IDs, or
+    /// they draw the same numbers.  Effects without draws ignore it.
+    void setStreamId(unsigned int id)
+    {
+        m_streamId = id & 0xFFu;
+        if (m_uStreamId.valid()) m_uStreamId->set(m_streamId);
+    }
+    unsigned int getStreamId() const { return m_streamId; }
+
+    /// Draw the effect's normals with the transcendental-free
+    /// approximation (rand_normal_fast(): exact mean and variance, tails
+    /// cut at 3.46 sigma) instead of Box-Muller.  A feature key: the
+    /// chain recompiles on its next update.  Effects without normal draws
+    /// ignore it.
+    void setFastNormals(bool on) { m_fastNormals = on; }
+    bool getFastNormals() const  { return m_fastNormals; }
+
     /// Human-readable name for logging.
     virtual std::string getName() const = 0;
 
@@ -35,5 +120,28 @@ public:
     void setEnabled(bool on) { m_enabled = on; }
 
 protected:
+    /// Store `value` and upload it only if it differs, so unchanged
+    /// parameters never dirty their uniform.  Returns whether it changed.
+    template<typename T>
+    static bool setIfChanged(osg::Uniform* uniform, T& member, T value)
+    {
+        if (member == value) return false;
+        member = value;
+        uniform->set(value);
+        return true;
+    }
+
+    /// The uint uniform `name` carrying the stream ID, starting at `id`;
+    /// effects with temporal draws add it in setupUniforms().
+    osg::Uniform* createStreamUniform(const char* name, unsigned int id)
+    {
+        m_streamId  = id;
+        m_uStreamId = new osg::Uniform(name, id);
+        return m_uStreamId.get();
+    }
+
     bool m_enabled = true;
+    bool m_fastNormals = false;
+    unsigned int m_streamId = 0;
+    osg::ref_ptr<osg::Uniform> m_uStreamId;
 };
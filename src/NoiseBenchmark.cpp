@@ -0,0 +1,610 @@
+// ============================================================================
+//  NoiseBenchmark — Headless throughput benchmark for the noise chain
+// ============================================================================
+//  Runs SensorNoiseSimulator offscreen over a matrix of resolutions and
+//  effect mixes for a fixed number of frames and writes one JSON document:
+//  GPU ms/frame (sum of the chain's pass timer queries), CPU ms/frame
+//  (wall time per viewer frame) and Mpixel/s.
+//
+//  Every configuration gets a fresh chain and context, the built-in scene
+//  and a fixed camera, so runs are comparable across builds and drivers.
+//
+//  --validate instead renders flat-field and dark-frame inputs through one
+//  stage at a time and checks the pooled mean and variance of the output
+//  against the photon transfer expectation of its parameters (shot noise
+//  L / photonScale, read noise sigma^2 with exact and fast normals, dark
+//  current, PRNU and DSNU spread, read-noise-limited SNR of accumulated
+//  exposures), for every mode, signal format and Poisson sampler asked
+//  for.  "cpu" runs the CpuNoiseChain reference without a GL context.
+//  Each check also records Mpixel/s; the exit code is 1 if any check
+//  fails, so faster samplers and fused paths can be gated on it.  ctest
+//  runs it as noise_validation (all modes, needs a GPU) and
+//  noise_validation_cpu (--modes cpu, no GL context).
+//
+//  Usage:
+//    NoiseBenchmark [--frames N] [--warmup N] [--resolutions 720p,1080p,4k,8k]
+//                   [--modes multipass,fused,compute] [--json FILE]
+//    (default FILE noise_benchmark.json; the chain logs to stdout)
+//    NoiseBenchmark --validate [--frames N] [--size N]
+//                   [--modes multipass,fused,compute,cpu] [--signals half,float]
+//                   [--poisson fast,table,exact] [--json FILE]
+//    (default 16 frames of 512x512, FILE noise_validation.json)
+// ============================================================================
+
+#include "SensorNoiseSimulator.h"
+#include "DefaultScene.h"
+#include "PboReadback.h"
+#include "CpuNoiseChain.h"
+
+#include <osg/ArgumentParser>
+#include <osg/Timer>
+#include <osgViewer/Viewer>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct Resolution
+{
+    const char*  name;
+    unsigned int width;
+    unsigned int height;
+};
+
+static const Resolution kResolutions[] = {
+    { "720p",  1280,  720  },
+    { "1080p", 1920,  1080 },
+    { "4k",    3840,  2160 },
+    { "8k",    7680,  4320 },
+};
+
+/// Which modules are on: PRNU, dark, photon, read, ADC.
+struct EffectMix
+{
+    const char* name;
+    bool        on[5];
+};
+
+static const EffectMix kMixes[] = {
+    { "prnu",   { true,  false, false, false, false } },
+    { "dark",   { false, true,  false, false, false } },
+    { "photon", { false, false, true,  false, false } },
+    { "read",   { false, false, false, true,  false } },
+    { "adc",    { false, false, false, false, true  } },
+    { "all",    { true,  true,  true,  true,  true  } },
+};
+
+struct Result
+{
+    std::string  resolution;
+    unsigned int width = 0, height = 0;
+    std::string  mix;
+    std::string  mode;
+    double       gpuMs = 0.0, gpuP99Ms = 0.0, cpuMs = 0.0, mpixPerSec = 0.0;
+    bool         ok = false;
+};
+
+// Comma-separated list as individual entries.
+static std::vector<std::string> splitList(const std::string& s)
+{
+    std::vector<std::string> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ','))
+        if (!item.empty())
+            out.push_back(item);
+    return out;
+}
+
+// ── Small pbuffer; all chain passes render into FBOs of the real size ────
+static osg::ref_ptr<osg::GraphicsContext> createContext()
+{
+    osg::ref_ptr<osg::GraphicsContext::Traits> traits = new osg::GraphicsContext::Traits;
+    traits->width  = 64;
+    traits->height = 64;
+    traits->windowDecoration = false;
+    traits->doubleBuffer = false;
+    traits->pbuffer = true;
+
+    osg::ref_ptr<osg::GraphicsContext> gc =
+        osg::GraphicsContext::createGraphicsContext(traits.get());
+    if (!gc || !gc->valid())
+        return nullptr;
+    return gc;
+}
+
+// ============================================================================
+static Result runConfig(const Resolution& res, const EffectMix& mix, const std::string& mode,
+                        osg::Node* scene, unsigned int warmup, unsigned int frames)
+{
+    Result r;
+    r.resolution = res.name;
+    r.width  = res.width;
+    r.height = res.height;
+    r.mix    = mix.name;
+    r.mode   = mode;
+
+    osg::ref_ptr<osg::GraphicsContext> gc = createContext();
+    if (!gc)
+    {
+        std::cerr << "[NoiseBenchmark] ERROR: Could not create pbuffer context.\n";
+        return r;
+    }
+
+    SensorNoiseSimulator simulator(res.width, res.height, "shaders",
+                                   mode == "compute" ? PostProcessChain::Backend::Compute
+                                                     : PostProcessChain::Backend::Raster);
+    simulator.setBuildMode(mode == "multipass" ? PostProcessChain::BuildMode::MultiPass
+                                               : PostProcessChain::BuildMode::Fused);
+    simulator.prnu()->setEnabled(mix.on[0]);
+    simulator.darkNoise()->setEnabled(mix.on[1]);
+    simulator.photonNoise()->setEnabled(mix.on[2]);
+    simulator.readNoise()->setEnabled(mix.on[3]);
+    simulator.adc()->setEnabled(mix.on[4]);
+
+    PostProcessChain& chain = simulator.chain();
+    chain.setOffscreenOutput(true);
+    chain.setGpuTimingEnabled(true);
+    osg::ref_ptr<osg::Group> root = simulator.apply(scene);
+
+    // ── Fixed camera ────────────────────────────────────────────────────
+    osgViewer::Viewer viewer;
+    viewer.setThreadingModel(osgViewer::Viewer::SingleThreaded);
+    viewer.getCamera()->setGraphicsContext(gc);
+    viewer.getCamera()->setViewport(0, 0, 64, 64);
+    viewer.getCamera()->setProjectionMatrixAsPerspective(
+        45.0, double(res.width) / res.height, 0.1, 100.0);
+    viewer.getCamera()->setViewMatrixAsLookAt(
+        osg::Vec3d(0.0, -8.0, 3.0), osg::Vec3d(0.0, 0.0, 0.0), osg::Vec3d(0.0, 0.0, 1.0));
+    viewer.setSceneData(root);
+    viewer.realize();
+
+    for (unsigned int i = 0; i < warmup; ++i)
+        viewer.frame();
+    chain.getGpuTimer()->reset();
+
+    const osg::Timer_t start = osg::Timer::instance()->tick();
+    for (unsigned int i = 0; i < frames; ++i)
+        viewer.frame();
+    const double seconds = osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+
+    // Let the last queries land (not timed)
+    for (unsigned int i = 0; i < 4; ++i)
+        viewer.frame();
+
+    unsigned int samples = 0;
+    for (auto& t : chain.getPassTimings())
+    {
+        r.gpuMs    += t.avgMs;
+        r.gpuP99Ms += t.p99Ms;
+        samples = std::max(samples, t.samples);
+    }
+    r.cpuMs      = frames ? seconds * 1000.0 / frames : 0.0;
+    r.mpixPerSec = seconds > 0.0 ? double(res.width) * res.height * frames / seconds / 1e6 : 0.0;
+    r.ok         = samples > 0;
+
+    if (!r.ok)
+        std::cerr << "[NoiseBenchmark] WARNING: No GPU timings for "
+                  << r.resolution << " " << r.mix << " " << r.mode << ".\n";
+    return r;
+}
+
+// ============================================================================
+static void writeJson(std::ostream& os, const std::vector<Result>& results,
+                      unsigned int warmup, unsigned int frames)
+{
+    os << "{\n"
+       << "  \"benchmark\": \"noise_chain\",\n"
+       << "  \"warmup_frames\": " << warmup << ",\n"
+       << "  \"frames\": " << frames << ",\n"
+       << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result& r = results[i];
+        os << "    { \"resolution\": \"" << r.resolution << "\""
+           << ", \"width\": " << r.width << ", \"height\": " << r.height
+           << ", \"effects\": \"" << r.mix << "\""
+           << ", \"mode\": \"" << r.mode << "\""
+           << ", \"gpu_ms\": " << r.gpuMs
+           << ", \"gpu_p99_ms\": " << r.gpuP99Ms
+           << ", \"cpu_ms\": " << r.cpuMs
+           << ", \"mpix_per_s\": " << r.mpixPerSec
+           << ", \"ok\": " << (r.ok ? "true" : "false") << " }"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+// ── Validation ──────────────────────────────────────────────────────────────
+/// One stage (or a stage pair) on a flat input with its expected moments.
+struct Check
+{
+    const char* name;
+    float       level;          ///< flat-field input, 0 = dark frame
+    bool        poisson;        ///< run once per Poisson sampler
+    bool        fixedPattern;   ///< one realisation per pixel, not per frame
+    std::function<void(SensorNoiseSimulator&)> configure;
+    double      mean;
+    double      variance;
+    bool        multiPassOnly = false;   ///< temporal stages run in multi-pass chains only
+};
+
+struct CheckResult
+{
+    std::string  check, mode, signal, poisson;
+    double       mean = 0.0, variance = 0.0, expectedMean = 0.0, expectedVariance = 0.0;
+    double       mpixPerSec = 0.0;
+    std::size_t  samples = 0;
+    bool         ok = false;
+};
+
+/// Pooled first and second moments of the red channel.
+struct Moments
+{
+    double       sum = 0.0, sumSq = 0.0;
+    std::size_t  count = 0;
+    unsigned int frames = 0;
+
+    void add(double v) { sum += v; sumSq += v * v; ++count; }
+    double mean() const     { return count ? sum / count : 0.0; }
+    double variance() const { return count ? sumSq / count - mean() * mean() : 0.0; }
+};
+
+static std::vector<Check> makeChecks()
+{
+    const double pi = 3.14159265358979;
+    auto only = [](SensorNoiseSimulator& sim, INoiseEffect* on, INoiseEffect* also = nullptr)
+    {
+        INoiseEffect* all[] = { sim.prnu().get(), sim.darkNoise().get(), sim.photonNoise().get(),
+                                sim.readNoise().get(), sim.adc().get() };
+        for (INoiseEffect* e : all)
+            e->setEnabled(e == on || e == also);
+    };
+
+    std::vector<Check> checks;
+    // Shot noise: Poisson(L * P) / P, in the table range and above it
+    checks.push_back({ "photon_small", 0.2f, true, false, [=](SensorNoiseSimulator& sim) {
+        only(sim, sim.photonNoise().get());
+        sim.photonNoise()->setPhotonScale(100.0f);
+    }, 0.2, 0.2 / 100.0 });
+    checks.push_back({ "photon_large", 0.5f, true, false, [=](SensorNoiseSimulator& sim) {
+        only(sim, sim.photonNoise().get());
+        sim.photonNoise()->setPhotonScale(400.0f);
+    }, 0.5, 0.5 / 400.0 });
+    // Read noise: L + N(0, sigma^2)
+    checks.push_back({ "read", 0.5f, false, false, [=](SensorNoiseSimulator& sim) {
+        only(sim, sim.readNoise().get());
+        sim.readNoise()->setReadNoise(0.01f);
+    }, 0.5, 0.01 * 0.01 });
+    checks.push_back({ "read_fast", 0.5f, false, false, [=](SensorNoiseSimulator& sim) {
+        only(sim, sim.readNoise().get());
+        sim.readNoise()->setReadNoise(0.01f);
+        sim.readNoise()->setFastNormals(true);
+    }, 0.5, 0.01 * 0.01 });
+    // Dark frame: Poisson(dc * 1000) / 1000
+    checks.push_back({ "dark_current", 0.0f, true, false, [=](SensorNoiseSimulator& sim) {
+        only(sim, sim.darkNoise().get());
+        sim.darkNoise()->setDarkCurrent(0.005f);
+        sim.darkNoise()->setDSNUStrength(0.0f);
+        sim.darkNoise()->setHotPixelProbability(0.0f);
+    }, 0.005, 0.005 / 1000.0 });
+    // DSNU: half-normal offsets |s N| feeding the dark Poisson draw
+    const double s = 0.003, dsnuMean = s * std::sqrt(2.0 / pi);
+    checks.push_back({ "dsnu", 0.0f, true, true, [=](SensorNoiseSimulator& sim) {
+        only(sim, sim.darkNoise().get());
+        sim.darkNoise()->setDarkCurrent(0.0f);
+        sim.darkNoise()->setDSNUStrength(float(s));
+        sim.darkNoise()->setHotPixelProbability(0.0f);
+    }, dsnuMean, s * s * (1.0 - 2.0 / pi) + dsnuMean / 1000.0 });
+    // PRNU: L * (1 + s N), fixed per pixel
+    checks.push_back({ "prnu", 0.5f, false, true, [=](SensorNoiseSimulator& sim) {
+        only(sim, sim.prnu().get());
+        sim.prnu()->setPRNUStrength(0.02f);
+    }, 0.5, (0.5 * 0.02) * (0.5 * 0.02) });
+    // Photon transfer curve: shot plus read variance at two levels
+    for (float level : { 0.1f, 0.4f })
+        checks.push_back({ level < 0.2f ? "ptc_0.1" : "ptc_0.4", level, true, false,
+            [=](SensorNoiseSimulator& sim) {
+                only(sim, sim.photonNoise().get(), sim.readNoise().get());
+                sim.photonNoise()->setPhotonScale(200.0f);
+                sim.readNoise()->setReadNoise(0.01f);
+            }, level, level / 200.0 + 0.01 * 0.01 });
+    // Read-noise-limited exposure of N sub-frames: the signal sums to N L
+    // while read noise is added once, so SNR grows as N (a mean of the
+    // sub-frames would keep it flat)
+    for (unsigned int n : { 2u, 8u })
+        checks.push_back({ n == 2 ? "accum_snr_2" : "accum_snr_8", 0.05f, false, false,
+            [=](SensorNoiseSimulator& sim) {
+                only(sim, sim.photonNoise().get(), sim.readNoise().get());
+                sim.enableAccumulation(n);
+                sim.photonNoise()->setPhotonScale(100000.0f);
+                sim.readNoise()->setReadNoise(0.01f);
+            }, n * 0.05, n * 0.05 / 100000.0 + 0.01 * 0.01, true });
+    return checks;
+}
+
+/// Flat input texture: every sample returns `level`.
+static osg::ref_ptr<osg::Texture2D> createFlatTexture(float level)
+{
+    osg::ref_ptr<osg::Image> image = new osg::Image;
+    image->allocateImage(1, 1, 1, GL_RGBA, GL_FLOAT);
+    float* p = reinterpret_cast<float*>(image->data());
+    p[0] = p[1] = p[2] = level;
+    p[3] = 1.0f;
+
+    osg::ref_ptr<osg::Texture2D> tex = new osg::Texture2D(image);
+    tex->setInternalFormat(GL_RGBA32F_ARB);
+    tex->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::NEAREST);
+    tex->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::NEAREST);
+    return tex;
+}
+
+/// Render `frames` frames of the configured chain on the GPU and pool
+/// the output moments.  Returns the wall time, or a negative value.
+static double measureGpu(SensorNoiseSimulator& simulator, float level, unsigned int size,
+                         unsigned int frames, Moments& moments)
+{
+    osg::ref_ptr<osg::GraphicsContext> gc = createContext();
+    if (!gc)
+    {
+        std::cerr << "[NoiseBenchmark] ERROR: Could not create pbuffer context.\n";
+        return -1.0;
+    }
+
+    PostProcessChain& chain = simulator.chain();
+    chain.setOffscreenOutput(true);
+    osg::ref_ptr<osg::Group> root = simulator.applyToTexture(createFlatTexture(level));
+    if (!chain.getOutputCamera())
+        return -1.0;
+
+    // The output is RGBA16; pool the red channel of every frame
+    osg::ref_ptr<PboReadback> readback = new PboReadback(
+        chain.getOutputTexture(), size, size,
+        [&moments, frames](ReadbackFrame&& frame)
+        {
+            if (moments.frames >= frames)
+                return;
+            const unsigned short* p = reinterpret_cast<const unsigned short*>(frame.data.data());
+            const std::size_t pixels = std::size_t(frame.width) * frame.height;
+            for (std::size_t i = 0; i < pixels; ++i)
+                moments.add(p[i * 4] / 65535.0);
+            ++moments.frames;
+        },
+        3, GL_RGBA, GL_UNSIGNED_SHORT);
+    chain.getOutputCamera()->setFinalDrawCallback(readback);
+
+    osgViewer::Viewer viewer;
+    viewer.setThreadingModel(osgViewer::Viewer::SingleThreaded);
+    viewer.getCamera()->setGraphicsContext(gc);
+    viewer.getCamera()->setViewport(0, 0, 64, 64);
+    viewer.setSceneData(root);
+    viewer.realize();
+
+    // A temporal stage reads back once per exposure
+    const unsigned int renders = (frames + 8) * chain.getSubFramesPerOutput();
+    const osg::Timer_t start = osg::Timer::instance()->tick();
+    for (unsigned int i = 0; moments.frames < frames && i < renders; ++i)
+        viewer.frame();
+    return osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+}
+
+/// CpuNoiseChain counterpart of measureGpu(); output values unquantised.
+static double measureCpu(SensorNoiseSimulator& simulator, float level, unsigned int size,
+                         unsigned int frames, Moments& moments)
+{
+    CpuNoiseChain cpu;
+    CpuNoiseChain::Planes input, planes;
+    input.resize(size, size);
+    std::fill(input.r.begin(), input.r.end(), level);
+    std::fill(input.g.begin(), input.g.end(), level);
+    std::fill(input.b.begin(), input.b.end(), level);
+
+    double seconds = 0.0;
+    for (unsigned int f = 0; f < frames; ++f)
+    {
+        planes = input;
+        const osg::Timer_t start = osg::Timer::instance()->tick();
+        if (!cpu.process(simulator.chain(), planes, int(f)))
+            return -1.0;
+        seconds += osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+        for (float v : planes.r)
+            moments.add(v);
+        ++moments.frames;
+    }
+    return seconds;
+}
+
+static CheckResult runCheck(const Check& check, const std::string& mode,
+                            const std::string& signal, const std::string& poisson,
+                            unsigned int size, unsigned int frames)
+{
+    CheckResult r;
+    r.check   = check.name;
+    r.mode    = mode;
+    r.signal  = signal;
+    r.poisson = poisson;
+    r.expectedMean     = check.mean;
+    r.expectedVariance = check.variance;
+
+    SensorNoiseSimulator simulator(size, size, "shaders",
+                                   mode == "compute" ? PostProcessChain::Backend::Compute
+                                                     : PostProcessChain::Backend::Raster);
+    simulator.setBuildMode(mode == "multipass" ? PostProcessChain::BuildMode::MultiPass
+                                               : PostProcessChain::BuildMode::Fused);
+    simulator.setSignalFormat(signal == "float" ? PostProcessChain::SignalFormat::Float32
+                                                : PostProcessChain::SignalFormat::Float16);
+    simulator.setPoissonQuality(poisson == "fast"  ? PostProcessChain::PoissonQuality::Fast
+                              : poisson == "exact" ? PostProcessChain::PoissonQuality::Exact
+                                                   : PostProcessChain::PoissonQuality::Table);
+    check.configure(simulator);
+
+    Moments moments;
+    const double seconds = mode == "cpu" ? measureCpu(simulator, check.level, size, frames, moments)
+                                         : measureGpu(simulator, check.level, size, frames, moments);
+    if (seconds < 0.0 || moments.frames < frames)
+    {
+        std::cerr << "[NoiseBenchmark] ERROR: " << check.name << " " << mode
+                  << ": only " << moments.frames << " of " << frames << " frames.\n";
+        return r;
+    }
+
+    r.mean       = moments.mean();
+    r.variance   = moments.variance();
+    r.samples    = moments.count;
+    r.mpixPerSec = seconds > 0.0 ? double(moments.count) / seconds / 1e6 : 0.0;
+
+    // Five standard errors plus a model allowance for the approximate
+    // samplers (Gaussian / table) and 16-bit storage.  A fixed pattern
+    // is one sample per pixel however many frames are pooled.
+    const double n = double(check.fixedPattern ? moments.count / moments.frames : moments.count);
+    const double meanTol = 5.0 * std::sqrt(check.variance / n) + 0.01 * check.mean;
+    const double varTol  = 5.0 * check.variance * std::sqrt(2.0 / n) + 0.03 * check.variance;
+    r.ok = std::fabs(r.mean - check.mean) <= meanTol &&
+           std::fabs(r.variance - check.variance) <= varTol;
+    return r;
+}
+
+static void writeValidationJson(std::ostream& os, const std::vector<CheckResult>& results,
+                                unsigned int size, unsigned int frames)
+{
+    os << "{\n"
+       << "  \"benchmark\": \"noise_validation\",\n"
+       << "  \"size\": " << size << ",\n"
+       << "  \"frames\": " << frames << ",\n"
+       << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const CheckResult& r = results[i];
+        os << "    { \"check\": \"" << r.check << "\""
+           << ", \"mode\": \"" << r.mode << "\""
+           << ", \"signal\": \"" << r.signal << "\""
+           << ", \"poisson\": \"" << r.poisson << "\""
+           << ", \"mean\": " << r.mean
+           << ", \"expected_mean\": " << r.expectedMean
+           << ", \"variance\": " << r.variance
+           << ", \"expected_variance\": " << r.expectedVariance
+           << ", \"samples\": " << r.samples
+           << ", \"mpix_per_s\": " << r.mpixPerSec
+           << ", \"ok\": " << (r.ok ? "true" : "false") << " }"
+           << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+static int validate(osg::ArgumentParser& arguments)
+{
+    unsigned int frames = 16;
+    unsigned int size = 512;
+    std::string modes = "multipass,fused,compute,cpu";
+    std::string signals = "half,float";
+    std::string samplers = "fast,table,exact";
+    std::string jsonPath = "noise_validation.json";
+    arguments.read("--frames", frames);
+    arguments.read("--size", size);
+    arguments.read("--modes", modes);
+    arguments.read("--signals", signals);
+    arguments.read("--poisson", samplers);
+    arguments.read("--json", jsonPath);
+
+    std::vector<CheckResult> results;
+    unsigned int failed = 0;
+    for (const Check& check : makeChecks())
+        for (const std::string& mode : splitList(modes))
+            for (const std::string& signal : splitList(signals))
+                for (const std::string& poisson : splitList(check.poisson ? samplers : "table"))
+                {
+                    // The CPU reference always computes in float
+                    if (mode == "cpu" && signal != splitList(signals).front())
+                        continue;
+                    if (check.multiPassOnly && mode != "multipass")
+                        continue;
+                    CheckResult r = runCheck(check, mode, signal, poisson, size, frames);
+                    std::cout << "[NoiseBenchmark] " << (r.ok ? "PASS " : "FAIL ") << r.check
+                              << " " << mode << " " << signal << " " << poisson
+                              << ": mean " << r.mean << " (" << r.expectedMean << "), var "
+                              << r.variance << " (" << r.expectedVariance << "), "
+                              << r.mpixPerSec << " Mpix/s\n";
+                    failed += r.ok ? 0 : 1;
+                    results.push_back(r);
+                }
+
+    std::ofstream ofs(jsonPath);
+    if (!ofs.is_open())
+    {
+        std::cerr << "[NoiseBenchmark] ERROR: Cannot write " << jsonPath << "\n";
+        return 1;
+    }
+    writeValidationJson(ofs, results, size, frames);
+    std::cerr << "[NoiseBenchmark] " << results.size() - failed << " of " << results.size()
+              << " checks passed; wrote " << jsonPath << "\n";
+    return failed == 0 ? 0 : 1;
+}
+
+// ============================================================================
+int main(int argc, char** argv)
+{
+    osg::ArgumentParser arguments(&argc, argv);
+    if (arguments.read("--validate"))
+        return validate(arguments);
+
+    unsigned int frames = 200;
+    unsigned int warmup = 30;
+    std::string resolutions = "720p,1080p,4k,8k";
+    std::string modes = "multipass,fused,compute";
+    std::string jsonPath = "noise_benchmark.json";
+    arguments.read("--frames", frames);
+    arguments.read("--warmup", warmup);
+    arguments.read("--resolutions", resolutions);
+    arguments.read("--modes", modes);
+    arguments.read("--json", jsonPath);
+
+    osg::ref_ptr<osg::Group> scene = createDefaultScene();
+
+    std::vector<Result> results;
+    for (const std::string& resName : splitList(resolutions))
+    {
+        const Resolution* res = nullptr;
+        for (auto& r : kResolutions)
+            if (resName == r.name)
+                res = &r;
+        if (!res)
+        {
+            std::cerr << "[NoiseBenchmark] WARNING: Unknown resolution " << resName << "\n";
+            continue;
+        }
+
+        for (auto& mix : kMixes)
+        {
+            for (const std::string& mode : splitList(modes))
+            {
+                if (mode != "multipass" && mode != "fused" && mode != "compute")
+                    continue;
+
+                std::cerr << "[NoiseBenchmark] " << res->name << " " << mix.name
+                          << " " << mode << "\n";
+                results.push_back(runConfig(*res, mix, mode,
+                                            scene, warmup, frames));
+            }
+        }
+    }
+
+    std::ofstream ofs(jsonPath);
+    if (!ofs.is_open())
+    {
+        std::cerr << "[NoiseBenchmark] ERROR: Cannot write " << jsonPath << "\n";
+        return 1;
+    }
+    writeJson(ofs, results, warmup, frames);
+    std::cerr << "[NoiseBenchmark] Wrote " << results.size() << " results to "
+              << jsonPath << "\n";
+
+    for (auto& r : results)
+        if (!r.ok)
+            return 1;
+    return 0;
+}
@@ -0,0 +1,240 @@
+#pragma once
+// ============================================================================
+//  NoiseMath — CPU port of the noise_utils.glsl RNG
+// ============================================================================
+//  Bit-exact PCG hash, spatial seeding and counter-based streams, so
+//  patterns baked on the CPU land on the same pixels as the shader would
+//  have produced and the CPU backend repeats the shader's temporal draws.
+//  The float helpers follow the GLSL expressions; results agree to float
+//  precision.
+//
+//  The samplers take either RNG state (a spatial uint or an RngStream) and
+//  consume it exactly like their GLSL counterparts (0 or 2 draws for Fast /
+//  Table, one per step for Exact), so a pixel's later draws stay in step
+//  with the shader.
+// ============================================================================
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace NoiseMath
+{
+
+// ── PCG Hash ────────────────────────────────────────────────────────────────
+inline uint32_t pcgHash(uint32_t inputState)
+{
+    uint32_t state = inputState * 747796405u + 2891336453u;
+    uint32_t word  = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+    return (word >> 22u) ^ word;
+}
+
+// ── Seeding ─────────────────────────────────────────────────────────────────
+/// rng_seed_spatial() for integer pixel coordinates.
+inline uint32_t seedSpatial(uint32_t x, uint32_t y)
+{
+    return pcgHash(x * 1664525u + pcgHash(y * 1013904223u + 374761393u));
+}
+
+// ── Counter-based streams ───────────────────────────────────────────────────
+/// pcg4d() in place on v[0..3].
+inline void pcg4d(uint32_t* v)
+{
+    for (int i = 0; i < 4; ++i)
+        v[i] = v[i] * 1664525u + 1013904223u;
+    v[0] += v[1] * v[3];  v[1] += v[2] * v[0];  v[2] += v[0] * v[1];  v[3] += v[1] * v[2];
+    for (int i = 0; i < 4; ++i)
+        v[i] ^= v[i] >> 16u;
+    v[0] += v[1] * v[3];  v[1] += v[2] * v[0];  v[2] += v[0] * v[1];  v[3] += v[1] * v[2];
+}
+
+/// RngStream of noise_utils.glsl.  Holds up to two blocks, so callers can
+/// fill the first blocks of several streams ahead in one SIMD pass.
+struct RngStream
+{
+    uint32_t     counter[4];   ///< counter of the next block to hash
+    uint32_t     words[8];     ///< hashed words not yet returned
+    unsigned int used = 0;
+    unsigned int filled = 0;
+    float        spare = 0.0f;        ///< second Box-Muller output, if hasSpare
+    bool         hasSpare = false;
+    bool         fastNormals = false;
+};
+
+/// rng_stream() for integer pixel coordinates and the chain seed.
+inline RngStream rngStream(uint32_t x, uint32_t y, int frame, uint32_t stream, uint64_t seed)
+{
+    RngStream s;
+    s.counter[0] = x | (y << 16u);
+    s.counter[1] = static_cast<uint32_t>(frame);
+    s.counter[2] = stream << 24u;
+    s.counter[3] = static_cast<uint32_t>(seed) ^ pcgHash(static_cast<uint32_t>(seed >> 32));
+    return s;
+}
+
+inline uint32_t rngNext(RngStream& s)
+{
+    if (s.used == s.filled)
+    {
+        std::memcpy(s.words, s.counter, sizeof(s.counter));
+        pcg4d(s.words);
+        ++s.counter[2];
+        s.used   = 0;
+        s.filled = 4;
+    }
+    return s.words[s.used++];
+}
+
+// ── Random number generators ────────────────────────────────────────────────
+inline float randFloat(uint32_t& state)
+{
+    state = pcgHash(state);
+    return static_cast<float>(state) / 4294967296.0f;
+}
+
+inline float randFloat(RngStream& s)
+{
+    return static_cast<float>(rngNext(s)) / 4294967296.0f;
+}
+
+/// rand_float() of an already hashed state.
+inline float toUnitFloat(uint32_t hashed)
+{
+    return static_cast<float>(hashed) / 4294967296.0f;
+}
+
+/// The Box-Muller step of rand_normal() for its two uniform draws.
+inline float boxMuller(float u1, float u2)
+{
+    return std::sqrt(-2.0f * std::log(std::max(u1, 1e-10f))) * std::cos(6.28318530718f * u2);
+}
+
+template<class State>
+inline float randNormal(State& state)
+{
+    float u1 = randFloat(state);
+    float u2 = randFloat(state);
+    return boxMuller(u1, u2);
+}
+
+/// rand_normal2(): both Box-Muller outputs, in n[0] and n[1].
+inline void randNormal2(RngStream& s, float* n)
+{
+    float u1 = std::max(randFloat(s), 1e-10f);
+    float u2 = randFloat(s);
+    float r  = std::sqrt(-2.0f * std::log(u1));
+    float a  = 6.28318530718f * u2;
+    n[0] = r * std::cos(a);
+    n[1] = r * std::sin(a);
+}
+
+/// rand_normal_fast(): Irwin-Hall sum of four 16-bit uniforms.
+inline float randNormalFast(RngStream& s)
+{
+    uint32_t a = rngNext(s);
+    uint32_t b = rngNext(s);
+    float sum = float(a & 0xFFFFu) + float(a >> 16u) + float(b & 0xFFFFu) + float(b >> 16u);
+    return ((sum + 2.0f) / 65536.0f - 2.0f) * 1.73205080757f;
+}
+
+/// rand_normal() of a stream: pairs, or the fast approximation.
+inline float randNormal(RngStream& s)
+{
+    if (s.fastNormals)
+        return randNormalFast(s);
+    if (s.hasSpare)
+    {
+        s.hasSpare = false;
+        return s.spare;
+    }
+    float n[2];
+    randNormal2(s, n);
+    s.spare    = n[1];
+    s.hasSpare = true;
+    return n[0];
+}
+
+// ── Poisson Sampling ────────────────────────────────────────────────────────
+/// Must match POISSON_TABLE_* in noise_utils.glsl (and PoissonTable.h).
+const float        POISSON_TABLE_LAMBDA_MAX = 30.0f;
+const unsigned int POISSON_TABLE_COLUMNS    = 128;
+const unsigned int POISSON_TABLE_ROWS       = 512;
+
+template<class State>
+inline int poissonSmall(float lambda, State& state)
+{
+    float L = std::exp(-lambda);
+    float p = 1.0f;
+    int   k = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        p *= randFloat(state);
+        if (p <= L) break;
+        k++;
+    }
+    return k;
+}
+
+/// poisson_large() for the standard normal draw `n`.
+inline int poissonLargeFromNormal(float lambda, float n)
+{
+    float result = lambda + std::sqrt(lambda) * n;
+    return std::max(0, static_cast<int>(std::round(result)));
+}
+
+template<class State>
+inline int poissonLarge(float lambda, State& state)
+{
+    return poissonLargeFromNormal(lambda, randNormal(state));
+}
+
+/// The lookup of poisson_table() for its two uniform draws, on the CPU
+/// copy of the table (PoissonTable::data()).
+inline int poissonTableLookup(float lambda, float u1, float u2, const unsigned char* table)
+{
+    float t   = lambda * (float(POISSON_TABLE_COLUMNS - 1) / POISSON_TABLE_LAMBDA_MAX);
+    int   col = static_cast<int>(t) + int(u1 < t - std::floor(t));
+    int   row = std::min(static_cast<int>(u2 * float(POISSON_TABLE_ROWS)),
+                         int(POISSON_TABLE_ROWS) - 1);
+    col = std::min(col, int(POISSON_TABLE_COLUMNS) - 1);
+    return table[row * POISSON_TABLE_COLUMNS + col];
+}
+
+template<class State>
+inline int poissonTable(float lambda, State& state, const unsigned char* table)
+{
+    float u1 = randFloat(state);
+    float u2 = randFloat(state);
+    return poissonTableLookup(lambda, u1, u2, table);
+}
+
+/// sample_poisson() for POISSON_QUALITY `quality` (0 Fast, 1 Table,
+/// 2 Exact); `table` is only read for quality 1.
+template<class State>
+inline int samplePoisson(float lambda, State& state, int quality,
+                         const unsigned char* table)
+{
+    if (lambda < 0.001f)
+        return 0;
+    if (quality == 0 || lambda >= 30.0f)
+        return poissonLarge(lambda, state);
+    return quality == 1 ? poissonTable(lambda, state, table)
+                        : poissonSmall(lambda, state);
+}
+
+// ── Storage precision ───────────────────────────────────────────────────────
+/// The value a GL_R16F texture stores for `v` (round to nearest even).
+/// Exponents outside the half range are not clamped; the calibration maps
+/// stay well inside it.
+inline float roundToHalf(float v)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    bits += 0x0FFFu + ((bits >> 13) & 1u);
+    bits &= 0xFFFFE000u;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+} // namespace NoiseMath
@@ -2,11 +2,16 @@
 // ============================================================================
 //  PRNUEffect — Photo-Response Non-Uniformity module
 // ============================================================================
+//  The per-pixel gain map is baked once into an R16F texture and only
+//  re-baked when the strength, resolution or region changes.  setGainMap()
+//  swaps in a measured calibration map instead.
+// ============================================================================
 
 #include "INoiseEffect.h"
+#include "ProgramCache.h"
+#include "FixedPatternMaps.h"
+#include "CpuKernels.h"
 #include <osg/Uniform>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 
 class PRNUEffect : public INoiseEffect
@@ -17,36 +22,115 @@ public:
         : m_shaderDir(shaderDir), m_prnuStrength(prnuStrength)
     {
         m_uPRNU       = new osg::Uniform("u_prnuStrength", m_prnuStrength);
-        m_uResolution = new osg::Uniform("u_resolution", osg::Vec2(1280, 720));
+        m_uGainMap    = new osg::Uniform("u_prnuGainMap", int(FixedPatternMaps::GAIN_MAP_UNIT));
+
+        m_gainImage = new osg::Image;
+        m_gainMap   = FixedPatternMaps::createMapTexture(GL_R16F);
     }
 
     std::string getName() const override { return "PRNU"; }
 
     std::string getFragmentSource() const override
     {
-        std::ifstream ifs(m_shaderDir + "/prnu.frag");
-        if (!ifs.is_open()) return {};
-        std::stringstream ss; ss << ifs.rdbuf();
-        return ss.str();
+        return ProgramCache::instance().source(m_shaderDir + "/prnu.frag");
     }
 
+    std::string getApplyFunction() const override { return "apply_prnu"; }
+
     void setupUniforms(osg::StateSet* ss) override
     {
         ss->addUniform(m_uPRNU);
-        ss->addUniform(m_uResolution);
+        ss->addUniform(m_uGainMap);
+        ss->setTextureAttributeAndModes(FixedPatternMaps::GAIN_MAP_UNIT, m_gainMap,
+                                        osg::StateAttribute::ON);
+        m_attached = true;
+        if (m_dirty) bakeMap();
     }
 
     // PRNU has no temporal component — no update callback needed.
 
+    /// The CPU path reads the map at the R16F precision the GPU stores.
+    bool prepareCpu(unsigned int w, unsigned int h) override
+    {
+        setResolution(w, h);
+        if (m_dirty) bakeMap();
+        m_cpuGain.update(m_gainMap->getImage(), w, h, true);
+        return true;
+    }
+    void processCpu(const CpuKernels::Tile& tile) const override
+    {
+        CpuKernels::prnu(tile, m_cpuGain);
+    }
+
     // ── Parameter access ────────────────────────────────────────────────
-    void  setPRNUStrength(float v) { m_prnuStrength = std::max(0.f, v); m_uPRNU->set(m_prnuStrength); }
+    void  setPRNUStrength(float v)
+    {
+        if (setIfChanged(m_uPRNU.get(), m_prnuStrength, std::max(0.f, v)))
+            invalidate();
+    }
     float getPRNUStrength() const  { return m_prnuStrength; }
 
-    void setResolution(float w, float h) { m_uResolution->set(osg::Vec2(w, h)); }
+    void setResolution(unsigned int w, unsigned int h) override
+    {
+        if (w == m_region.width && h == m_region.height) return;
+        m_region.width = w; m_region.height = h;
+        invalidate();
+    }
+
+    void setRegion(unsigned int x, unsigned int y, unsigned int sensorW, unsigned int sensorH) override
+    {
+        if (x == m_region.x && y == m_region.y &&
+            sensorW == m_region.sensorWidth && sensorH == m_region.sensorHeight) return;
+        m_region.x = x; m_region.y = y;
+        m_region.sensorWidth = sensorW; m_region.sensorHeight = sensorH;
+        invalidate();
+    }
+
+    /// Use a measured gain map (single channel, gain ~1.0, bottom row
+    /// first) instead of the synthetic one.  The strength no longer
+    /// applies while it is set.  It covers the whole sensor; a chain
+    /// region samples its part.  nullptr returns to the synthetic map.
+    void setGainMap(osg::Image* measured)
+    {
+        if (m_measured == measured) return;
+        m_measured = measured;
+        invalidate();
+    }
 
 private:
+    /// Re-bake now if the map is in use, otherwise on setupUniforms().
+    void invalidate()
+    {
+        m_dirty = true;
+        if (m_attached) bakeMap();
+    }
+
+    /// A measured map is only cut to the region; m_gainImage holds the cut.
+    void bakeMap()
+    {
+        if (m_measured.valid())
+        {
+            FixedPatternMaps::assign(m_gainMap,
+                                     FixedPatternMaps::window(m_measured, m_gainImage, m_region));
+        }
+        else
+        {
+            FixedPatternMaps::bakeGain(m_gainImage, m_region, m_prnuStrength);
+            FixedPatternMaps::assign(m_gainMap, m_gainImage);
+        }
+        m_dirty = false;
+    }
+
     std::string m_shaderDir;
     float m_prnuStrength;
+    FixedPatternMaps::Region m_region;
+    bool m_dirty = true, m_attached = false;
+
     osg::ref_ptr<osg::Uniform> m_uPRNU;
-    osg::ref_ptr<osg::Uniform> m_uResolution;
+    osg::ref_ptr<osg::Uniform> m_uGainMap;
+
+    osg::ref_ptr<osg::Image>     m_gainImage;
+    osg::ref_ptr<osg::Image>     m_measured;
+    osg::ref_ptr<osg::Texture2D> m_gainMap;
+    CpuKernels::MapPlane         m_cpuGain;
 };
@@ -0,0 +1,127 @@
+#include "PboReadback.h"
+
+#include <osg/GLExtensions>
+#include <osg/BufferObject>
+#include <osg/Image>
+#include <osg/State>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// ============================================================================
+PboReadback::PboReadback(osg::Texture* texture, unsigned int width, unsigned int height,
+                         Sink sink, unsigned int ringSize,
+                         GLenum format, GLenum type)
+    : m_texture(texture), m_width(width), m_height(height), m_layers(1)
+    , m_format(format), m_type(type), m_sink(std::move(sink))
+    , m_slots(ringSize < 2 ? 2 : ringSize)
+{
+    if (auto* array = dynamic_cast<osg::Texture2DArray*>(texture))
+        m_layers = std::max(1, array->getTextureDepth());
+}
+
+// ============================================================================
+std::size_t PboReadback::getFrameBytes() const
+{
+    return std::size_t(m_width) * m_height * m_layers
+         * osg::Image::computePixelSizeInBits(m_format, m_type) / 8;
+}
+
+// ============================================================================
+void PboReadback::operator()(osg::RenderInfo& renderInfo) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    osg::State* state = renderInfo.getState();
+    const osg::GLExtensions* ext = state->get<osg::GLExtensions>();
+    if (!ext->isPBOSupported)
+    {
+        std::cerr << "[PboReadback] ERROR: Pixel buffer objects not supported.\n";
+        return;
+    }
+
+    osg::Texture::TextureObject* to = m_texture->getTextureObject(state->getContextID());
+    if (!to)
+        return;   // target not allocated yet (first frame)
+
+    const std::size_t bytes = getFrameBytes();
+
+    if (m_slots[0].pbo == 0)
+    {
+        for (auto& slot : m_slots)
+        {
+            ext->glGenBuffers(1, &slot.pbo);
+            ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, slot.pbo);
+            ext->glBufferData(GL_PIXEL_PACK_BUFFER_ARB, bytes, nullptr, GL_STREAM_READ);
+        }
+    }
+
+    // ── Kick off this frame's copy into the next buffer ─────────────────
+    Slot& write = m_slots[m_next];
+    unsigned int frameNumber = state->getFrameStamp()
+                             ? state->getFrameStamp()->getFrameNumber() : 0;
+
+    // Bind behind OSG's back on unit 0, then tell the State so the next
+    // pass re-applies its own texture instead of trusting a stale cache.
+    state->setActiveTextureUnit(0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, write.pbo);
+    const GLenum target = m_texture->getTextureTarget();
+    glBindTexture(target, to->id());
+    glGetTexImage(target, 0, m_format, m_type, nullptr);
+    glBindTexture(target, 0);
+    state->haveAppliedTextureAttribute(0, osg::StateAttribute::TEXTURE);
+    write.pending = true;
+    write.frameNumber = frameNumber;
+
+    // ── Collect the oldest buffer; its transfer has had N-1 frames ──────
+    m_next = (m_next + 1) % m_slots.size();
+    collect(m_slots[m_next], ext);
+
+    ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+}
+
+// ============================================================================
+void PboReadback::flush(osg::State& state) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    const osg::GLExtensions* ext = state.get<osg::GLExtensions>();
+    if (!ext->isPBOSupported || m_slots[0].pbo == 0)
+        return;
+
+    // m_next is the slot written next, so the oldest pending one follows it
+    for (std::size_t i = 1; i <= m_slots.size(); ++i)
+        collect(m_slots[(m_next + i) % m_slots.size()], ext);
+
+    ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+}
+
+// ============================================================================
+void PboReadback::collect(Slot& slot, const osg::GLExtensions* ext) const
+{
+    if (!slot.pending)
+        return;
+
+    const std::size_t bytes = getFrameBytes();
+    ext->glBindBuffer(GL_PIXEL_PACK_BUFFER_ARB, slot.pbo);
+    const void* src = ext->glMapBuffer(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+    if (src)
+    {
+        ReadbackFrame frame;
+        frame.frameNumber = slot.frameNumber;
+        frame.width  = m_width;
+        frame.height = m_height;
+        frame.format = m_format;
+        frame.type   = m_type;
+        frame.layers = m_layers;
+        frame.data.resize(bytes);
+        std::memcpy(frame.data.data(), src, bytes);
+        ext->glUnmapBuffer(GL_PIXEL_PACK_BUFFER_ARB);
+
+        if (m_sink)
+            m_sink(std::move(frame));
+    }
+    slot.pending = false;
+}
@@ -0,0 +1,84 @@
+#pragma once
+// ============================================================================
+//  PboReadback — Asynchronous texture readback through a pixel-pack ring
+// ============================================================================
+//  Installed as a camera final-draw callback.  Each frame the texture is
+//  copied into the next pixel-pack buffer (glGetTexImage returns at once,
+//  the transfer runs on the GPU) and the buffer written N-1 frames earlier
+//  is mapped and handed to the sink.  The CPU copy therefore overlaps the
+//  following frames' rendering instead of stalling the pipeline.
+//
+//  Frames arrive with a latency of (ringSize - 1) frames; the recorded
+//  frameNumber is the one the pixels were rendered in.  flush() collects
+//  the frames still in the ring, e.g. after the last frame of a run.  One
+//  GL context only.  Buffers are released with the context.
+//
+//  A Texture2DArray is read back whole: the frame then holds `layers`
+//  consecutive images.
+// ============================================================================
+
+#include <osg/Camera>
+#include <osg/GLExtensions>
+#include <osg/Texture2D>
+#include <osg/Texture2DArray>
+#include <osg/ref_ptr>
+
+#include <functional>
+#include <vector>
+#include <mutex>
+
+struct ReadbackFrame
+{
+    unsigned int frameNumber = 0;
+    unsigned int width  = 0;
+    unsigned int height = 0;
+    GLenum       format = GL_RGBA;
+    GLenum       type   = GL_UNSIGNED_BYTE;
+    unsigned int layers = 1;
+    std::vector<unsigned char> data;   ///< bottom-up rows, tightly packed, layer after layer
+};
+
+class PboReadback : public osg::Camera::DrawCallback
+{
+public:
+    /// Called on the draw thread; take ownership of the frame and return
+    /// quickly (queue it, do not encode it here).
+    using Sink = std::function<void(ReadbackFrame&&)>;
+
+    /// `texture` is a Texture2D or a Texture2DArray.
+    PboReadback(osg::Texture* texture, unsigned int width, unsigned int height,
+                Sink sink, unsigned int ringSize = 3,
+                GLenum format = GL_RGBA, GLenum type = GL_UNSIGNED_BYTE);
+
+    void operator()(osg::RenderInfo& renderInfo) const override;
+
+    /// Hand every pending frame to the sink, oldest first, without
+    /// waiting for further draws.  Needs the context current (draw
+    /// thread, or the caller's thread after makeCurrent()).
+    void flush(osg::State& state) const;
+
+    unsigned int getRingSize() const { return static_cast<unsigned int>(m_slots.size()); }
+
+    /// Bytes per frame (all layers) for the configured format/type.
+    std::size_t getFrameBytes() const;
+
+private:
+    struct Slot
+    {
+        GLuint       pbo = 0;
+        bool         pending = false;
+        unsigned int frameNumber = 0;
+    };
+
+    /// Map a pending slot and hand its frame to the sink (m_mutex held).
+    void collect(Slot& slot, const osg::GLExtensions* ext) const;
+
+    osg::ref_ptr<osg::Texture> m_texture;
+    unsigned int m_width, m_height, m_layers;
+    GLenum       m_format, m_type;
+    Sink         m_sink;
+
+    mutable std::mutex        m_mutex;
+    mutable std::vector<Slot> m_slots;
+    mutable unsigned int      m_next = 0;
+};
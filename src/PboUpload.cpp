@@ -0,0 +1,110 @@
+#include "PboUpload.h"
+
+#include <osg/GLExtensions>
+#include <osg/BufferObject>
+#include <osg/State>
+
+#include <cstring>
+#include <iostream>
+
+// ============================================================================
+PboUpload::PboUpload(osg::Texture2D* texture, unsigned int width, unsigned int height,
+                     Source source, GLenum format, GLenum type)
+    : m_texture(texture), m_width(width), m_height(height)
+    , m_format(format), m_type(type), m_source(std::move(source))
+{
+}
+
+// ============================================================================
+GLint PboUpload::internalFormatFor(GLenum type)
+{
+    switch (type)
+    {
+    case GL_UNSIGNED_SHORT: return GL_RGBA16;
+    case GL_HALF_FLOAT:     return GL_RGBA16F_ARB;
+    case GL_FLOAT:          return GL_RGBA32F_ARB;
+    default:                return GL_RGBA;
+    }
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Camera> PboUpload::createCamera(PboUpload* upload)
+{
+    // Nothing to draw and nothing to clear; the camera only orders the
+    // callback before the chain's passes.
+    osg::ref_ptr<osg::Camera> camera = new osg::Camera;
+    camera->setClearMask(0);
+    camera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
+    camera->setRenderOrder(osg::Camera::PRE_RENDER, 0);
+    camera->setViewport(0, 0, 1, 1);
+    camera->setCullingActive(false);
+    camera->setInitialDrawCallback(upload);
+    return camera;
+}
+
+// ============================================================================
+void PboUpload::operator()(osg::RenderInfo& renderInfo) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    osg::State* state = renderInfo.getState();
+    const osg::GLExtensions* ext = state->get<osg::GLExtensions>();
+    if (!ext->isPBOSupported)
+    {
+        std::cerr << "[PboUpload] ERROR: Pixel buffer objects not supported.\n";
+        return;
+    }
+
+    osg::ref_ptr<osg::Image> image;
+    if (!m_source || !m_source(image) || !image)
+        return;
+    if (static_cast<unsigned int>(image->s()) != m_width ||
+        static_cast<unsigned int>(image->t()) != m_height ||
+        image->getPixelFormat() != m_format || image->getDataType() != m_type)
+    {
+        std::cerr << "[PboUpload] ERROR: Frame does not match the input texture; skipped.\n";
+        return;
+    }
+
+    // First use allocates the texture storage (no image attached)
+    state->setActiveTextureUnit(0);
+    m_texture->apply(*state);
+    osg::Texture::TextureObject* to = m_texture->getTextureObject(state->getContextID());
+    if (!to)
+        return;
+
+    const std::size_t bytes = image->getTotalSizeInBytes();
+    if (m_pbos[0] == 0)
+    {
+        for (GLuint& pbo : m_pbos)
+        {
+            ext->glGenBuffers(1, &pbo);
+            ext->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo);
+            ext->glBufferData(GL_PIXEL_UNPACK_BUFFER_ARB, bytes, nullptr, GL_STREAM_DRAW);
+        }
+    }
+
+    // ── Fill this frame's buffer; its last transfer was two frames ago ──
+    const GLuint pbo = m_pbos[m_next];
+    m_next ^= 1u;
+    ext->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, pbo);
+    void* dst = ext->glMapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+    if (dst)
+    {
+        std::memcpy(dst, image->data(), bytes);
+        ext->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER_ARB);
+
+        // ── Texture <- buffer; returns before the transfer completes ────
+        glPixelStorei(GL_UNPACK_ALIGNMENT, image->getPacking());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, image->getRowLength());
+        glBindTexture(GL_TEXTURE_2D, to->id());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, m_format, m_type, nullptr);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        m_uploaded.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Bound behind OSG's back on unit 0; make the next pass re-apply
+    glBindTexture(GL_TEXTURE_2D, 0);
+    state->haveAppliedTextureAttribute(0, osg::StateAttribute::TEXTURE);
+    ext->glBindBuffer(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+}
@@ -0,0 +1,60 @@
+#pragma once
+// ============================================================================
+//  PboUpload — Streaming texture upload through double-buffered PBOs
+// ============================================================================
+//  Counterpart of PboReadback for the input side.  Installed on an empty
+//  PRE_RENDER camera that draws before the chain (createCamera()), it
+//  takes the next image from its source every frame, copies it into one
+//  of two pixel-unpack buffers and updates the chain's input texture from
+//  it.  glTexSubImage2D from a PBO returns at once, and the buffer written
+//  this frame is not touched again until the one after next, so the CPU
+//  copy of frame N+1 never waits for the transfer of frame N.
+//
+//  When the source has nothing new the texture keeps its last frame.
+//  One GL context only.  Buffers are released with the context.
+// ============================================================================
+
+#include <osg/Camera>
+#include <osg/Image>
+#include <osg/Texture2D>
+#include <osg/ref_ptr>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+class PboUpload : public osg::Camera::DrawCallback
+{
+public:
+    /// Called on the draw thread; set `image` to the next frame and
+    /// return true, or return false to keep the current one.
+    using Source = std::function<bool(osg::ref_ptr<osg::Image>& image)>;
+
+    /// Images must be `width` x `height` in `format` / `type`.
+    PboUpload(osg::Texture2D* texture, unsigned int width, unsigned int height,
+              Source source, GLenum format = GL_RGBA, GLenum type = GL_UNSIGNED_BYTE);
+
+    void operator()(osg::RenderInfo& renderInfo) const override;
+
+    /// Frames uploaded so far.
+    unsigned int getNumUploaded() const { return m_uploaded.load(std::memory_order_relaxed); }
+
+    /// Texture storage for images of pixel type `type`: RGBA8, RGBA16 or
+    /// a float format, so the source precision reaches the chain.
+    static GLint internalFormatFor(GLenum type);
+
+    /// Empty PRE_RENDER camera (order 0, before every chain pass) that
+    /// runs `upload` each frame.
+    static osg::ref_ptr<osg::Camera> createCamera(PboUpload* upload);
+
+private:
+    osg::ref_ptr<osg::Texture2D> m_texture;
+    unsigned int m_width, m_height;
+    GLenum       m_format, m_type;
+    Source       m_source;
+
+    mutable std::mutex   m_mutex;
+    mutable GLuint       m_pbos[2] = { 0, 0 };
+    mutable unsigned int m_next = 0;
+    mutable std::atomic<unsigned int> m_uploaded{ 0 };
+};
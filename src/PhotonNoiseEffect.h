@@ -4,10 +4,10 @@
 // ============================================================================
 
 #include "INoiseEffect.h"
+#include "ProgramCache.h"
+#include "CpuKernels.h"
 #include <osg/Uniform>
-#include <fstream>
-#include <sstream>
-#include <iostream>
+#include <algorithm>
 
 class PhotonNoiseEffect : public INoiseEffect
 {
@@ -17,59 +17,52 @@ public:
         : m_shaderDir(shaderDir), m_photonScale(photonScale)
     {
         m_uniformPhotonScale = new osg::Uniform("u_photonScale", m_photonScale);
-        m_uniformFrameNumber = new osg::Uniform("u_frameNumber", 0);
-        m_uniformResolution  = new osg::Uniform("u_resolution", osg::Vec2(1280, 720));
+        createStreamUniform("u_photonStream", PHOTON_STREAM);
     }
 
     std::string getName() const override { return "PhotonNoise"; }
 
     std::string getFragmentSource() const override
     {
-        std::ifstream ifs(m_shaderDir + "/photon_noise.frag");
-        if (!ifs.is_open()) return {};
-        std::stringstream ss; ss << ifs.rdbuf();
-        return ss.str();
+        return ProgramCache::instance().source(m_shaderDir + "/photon_noise.frag");
+    }
+
+    std::string getApplyFunction() const override { return "apply_photon_noise"; }
+    /// At this photon scale every signal of one 16-bit code or more has
+    /// lambda >= 30 (at nominal exposure), so PHOTON_GAUSSIAN compiles
+    /// the small-lambda sampler out and keeps the Gaussian approximation.
+    static constexpr float GAUSSIAN_PHOTON_SCALE = 30.0f * 65535.0f;
+
+    std::vector<std::string> getFeatureKeys() const override
+    {
+        std::vector<std::string> keys;
+        if (m_photonScale >= GAUSSIAN_PHOTON_SCALE) keys.push_back("PHOTON_GAUSSIAN");
+        if (m_fastNormals)                          keys.push_back("PHOTON_FAST_NORMALS");
+        return keys;
     }
 
     void setupUniforms(osg::StateSet* ss) override
     {
         ss->addUniform(m_uniformPhotonScale);
-        ss->addUniform(m_uniformFrameNumber);
-        ss->addUniform(m_uniformResolution);
+        ss->addUniform(m_uStreamId);
     }
 
-    osg::ref_ptr<osg::NodeCallback> createUpdateCallback() override;
+    bool prepareCpu(unsigned int, unsigned int) override { return true; }
+    void processCpu(const CpuKernels::Tile& tile) const override
+    {
+        // PHOTON_GAUSSIAN samples like POISSON_QUALITY 0
+        CpuKernels::Tile t = tile;
+        if (m_photonScale >= GAUSSIAN_PHOTON_SCALE)
+            t.poissonQuality = 0;
+        CpuKernels::photonNoise(t, m_photonScale, m_streamId, m_fastNormals);
+    }
 
     // ── Parameter access ────────────────────────────────────────────────
-    void setPhotonScale(float s)  { m_photonScale = std::max(1.0f, s); m_uniformPhotonScale->set(m_photonScale); }
+    void setPhotonScale(float s)  { setIfChanged(m_uniformPhotonScale.get(), m_photonScale, std::max(1.0f, s)); }
     float getPhotonScale() const  { return m_photonScale; }
 
-    void setResolution(float w, float h) { m_uniformResolution->set(osg::Vec2(w, h)); }
-
 private:
     std::string m_shaderDir;
     float m_photonScale;
     osg::ref_ptr<osg::Uniform> m_uniformPhotonScale;
-    osg::ref_ptr<osg::Uniform> m_uniformFrameNumber;
-    osg::ref_ptr<osg::Uniform> m_uniformResolution;
-};
-
-// ── Frame counter callback ──────────────────────────────────────────────
-class PhotonNoiseFrameCallback : public osg::NodeCallback
-{
-public:
-    PhotonNoiseFrameCallback(osg::ref_ptr<osg::Uniform> u) : m_u(u), m_f(0) {}
-    void operator()(osg::Node* node, osg::NodeVisitor* nv) override
-    {
-        m_u->set(m_f++);
-        traverse(node, nv);
-    }
-private:
-    osg::ref_ptr<osg::Uniform> m_u;
-    int m_f;
 };
-
-inline osg::ref_ptr<osg::NodeCallback> PhotonNoiseEffect::createUpdateCallback()
-{
-    return new PhotonNoiseFrameCallback(m_uniformFrameNumber);
-}
@@ -0,0 +1,59 @@
+// ============================================================================
+//  PoissonTable.cpp — CPU build of the Poisson inverse-CDF table
+// ============================================================================
+
+#include "PoissonTable.h"
+
+#include <osg/Image>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+// ============================================================================
+const unsigned char* PoissonTable::data()
+{
+    static const std::vector<unsigned char> table = []
+    {
+        std::vector<unsigned char> t(std::size_t(COLUMNS) * ROWS);
+        for (unsigned int c = 0; c < COLUMNS; ++c)
+        {
+            const double lambda = c * double(LAMBDA_MAX) / (COLUMNS - 1);
+
+            // Walk the CDF once per column; rows are increasing quantiles.
+            double pmf = std::exp(-lambda);
+            double cdf = pmf;
+            unsigned int k = 0;
+            for (unsigned int r = 0; r < ROWS; ++r)
+            {
+                const double u = (r + 0.5) / ROWS;
+                while (cdf < u && k < 255)
+                {
+                    ++k;
+                    pmf *= lambda / k;
+                    cdf += pmf;
+                }
+                t[std::size_t(r) * COLUMNS + c] = static_cast<unsigned char>(k);
+            }
+        }
+        return t;
+    }();
+    return table.data();
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Texture2D> PoissonTable::createTexture()
+{
+    osg::ref_ptr<osg::Image> image = new osg::Image;
+    image->allocateImage(COLUMNS, ROWS, 1, GL_RED, GL_UNSIGNED_BYTE);
+    image->setInternalTextureFormat(GL_R8);
+    std::memcpy(image->data(), data(), std::size_t(COLUMNS) * ROWS);
+
+    osg::ref_ptr<osg::Texture2D> tex = new osg::Texture2D(image);
+    tex->setInternalFormat(GL_R8);
+    tex->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::NEAREST);
+    tex->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::NEAREST);
+    tex->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+    tex->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+    tex->setResizeNonPowerOfTwoHint(false);
+    return tex;
+}
@@ -0,0 +1,35 @@
+#pragma once
+// ============================================================================
+//  PoissonTable — Inverse-CDF lookup texture for small-lambda Poisson draws
+// ============================================================================
+//  Column c holds Poisson(lambda_c), lambda_c = c * LAMBDA_MAX / (COLUMNS-1).
+//  Row r holds the smallest k with CDF(k) >= (r + 0.5) / ROWS, stored as
+//  k / 255 in an R8 texture.  noise_utils.glsl (POISSON_QUALITY 1) picks a
+//  column by stochastic rounding of lambda, which keeps the mean exact, and
+//  a row from one uniform draw: two rand_float calls and one texelFetch per
+//  sample regardless of lambda.
+//
+//  The constants here must match the POISSON_TABLE_* defines in
+//  noise_utils.glsl.
+// ============================================================================
+
+#include <osg/Texture2D>
+#include <osg/ref_ptr>
+
+namespace PoissonTable
+{
+    const float        LAMBDA_MAX = 30.0f;
+    const unsigned int COLUMNS    = 128;
+    const unsigned int ROWS       = 512;
+
+    /// Texture unit the chain binds the table to (0 is the pass input,
+    /// 1-3 are the fixed-pattern maps).
+    const unsigned int TEXTURE_UNIT = 4;
+
+    /// The table, ROWS x COLUMNS values k, row r at data() + r * COLUMNS.
+    /// Built on first use; shared by the texture and the CPU reference.
+    const unsigned char* data();
+
+    /// Build the table texture (NEAREST, CLAMP_TO_EDGE, R8).
+    osg::ref_ptr<osg::Texture2D> createTexture();
+}
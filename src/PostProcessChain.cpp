@@ -1,32 +1,204 @@
 #include "PostProcessChain.h"
+#include "ProgramCache.h"
+#include "DemosaicEffect.h"
 
 #include <osg/Geode>
 #include <osg/Vec3>
 #include <osg/Vec2>
+#include <osg/NodeCallback>
+#include <osg/DispatchCompute>
+#include <osg/BindImageTexture>
+#include <osg/GLExtensions>
+#include <osg/FrameStamp>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 
 // ── Helper ──────────────────────────────────────────────────────────────────
 static std::string readFile(const std::string& path)
 {
-    std::ifstream ifs(path);
-    if (!ifs.is_open())
+    return ProgramCache::instance().source(path);
+}
+
+// Split "#version ..." off the top of a shader source.
+static void splitVersionLine(const std::string& src,
+                             std::string& versionLine, std::string& body)
+{
+    auto versionPos = src.find("#version");
+    if (versionPos == std::string::npos)
+    {
+        versionLine = "#version 330 core\n";
+        body = src;
+        return;
+    }
+    auto lineEnd = src.find('\n', versionPos);
+    if (lineEnd == std::string::npos)
+        lineEnd = src.size() - 1;
+    versionLine = src.substr(versionPos, lineEnd - versionPos + 1);
+    body = src.substr(lineEnd + 1);
+}
+
+// Per-frame values shared by every pass of a chain: one std140 block
+// (layout mirrored by PostProcessChain::FrameBlock), uploaded once per
+// frame instead of one uniform per effect.
+static const std::string kFrameBlock =
+    "layout(std140) uniform NoiseChainBlock\n"
+    "{\n"
+    "    vec2  u_resolution;\n"
+    "    int   u_frameNumber;\n"
+    "    float u_exposure;\n"
+    "    float u_time;\n"
+    "    uvec2 u_seed;\n"
+    "    vec2  u_tileOffset;\n"
+    "    vec2  u_sensorSize;\n"
+    "};\n";
+
+// Declarations shared by every generated pass.  Effects that provide an
+// apply function rely on these instead of declaring their own.
+static const std::string kChainPreamble =
+    "in  vec2 v_texCoord;\n"
+    "out vec4 fragColor;\n"
+    "\n"
+    "uniform sampler2D u_inputTexture;\n"
+    + kFrameBlock;
+
+// Layered mode: inputs come from layered_quad.geom, and every use of
+// u_frameNumber (macros do not expand recursively) becomes a distinct
+// per-layer frame index.
+static const std::string kLayeredPreamble =
+    "in  vec2 g_texCoord;\n"
+    "flat in int g_layer;\n"
+    "out vec4 fragColor;\n"
+    "#define v_texCoord g_texCoord\n"
+    "\n"
+    "uniform sampler2D u_inputTexture;\n"
+    + kFrameBlock
+    + "#define u_frameNumber (u_frameNumber * CHAIN_LAYERS + g_layer)\n";
+
+// CFA mode: the first generated pass a signal reaches keeps the
+// photosite's colour; later passes see u_inputIsRaw and use .r as is.
+static const std::string kCfaDecl = "uniform bool      u_inputIsRaw;\n";
+static const std::string kCfaMosaic =
+    "    if (!u_inputIsRaw)\n"
+    "        color = vec3(cfa_sample(color, fragCoord), 0.0, 0.0);\n";
+
+// An effect's feature keys as the #define lines in front of its source.
+static std::string featureDefines(const INoiseEffect& effect)
+{
+    std::string defines;
+    for (const std::string& key : effect.getFeatureKeys())
+        defines += "#define " + key + " 1\n";
+    return defines;
+}
+
+// Feature defines of every effect of a pass: the part of its source that
+// parameters can change.
+static std::string passFeatures(const std::vector<std::shared_ptr<INoiseEffect>>& effects)
+{
+    std::string features;
+    for (auto& e : effects)
+        features += featureDefines(*e);
+    return features;
+}
+
+// Compute backend: 16x16 tiles; must match local_size in the generated
+// compute shader.
+static const unsigned int kComputeTile = 16;
+
+// Image format qualifier for an imageStore() target.
+static const char* imageFormatQualifier(GLint internalFormat)
+{
+    switch (internalFormat)
     {
-        std::cerr << "[PostProcessChain] ERROR: Cannot open file: "
-                  << path << "\n";
-        return {};
+    case GL_RGBA16F_ARB:          return "rgba16f";
+    case GL_RGBA32F_ARB:          return "rgba32f";
+    case GL_R11F_G11F_B10F_EXT:   return "r11f_g11f_b10f";
+    case GL_RGBA16:               return "rgba16";
+    case GL_R16F:                 return "r16f";
+    case GL_R32F:                 return "r32f";
+    case GL_R16:                  return "r16";
+    case GL_R8:                   return "r8";
+    default:                      return "rgba8";
     }
-    std::stringstream ss;
-    ss << ifs.rdbuf();
-    return ss.str();
 }
 
+// glBindImageTexture needs a sized format; GL_RGBA targets are RGBA8.
+static GLenum sizedImageFormat(GLint internalFormat)
+{
+    return internalFormat == GL_RGBA ? GL_RGBA8 : static_cast<GLenum>(internalFormat);
+}
+
+// Pass state changes in the update traversal, which with DrawThreadPerContext
+// overlaps the previous frame's draw.  A DYNAMIC StateSet makes OSG hold the
+// next update back until the draw thread has applied it; its uniforms are
+// marked too, as effect setters change them from any update or event handler.
+static void markDynamic(osg::StateSet* ss)
+{
+    ss->setDataVariance(osg::Object::DYNAMIC);
+    for (auto& u : ss->getUniformList())
+        u.second.first->setDataVariance(osg::Object::DYNAMIC);
+}
+
+// Dispatch followed by the barrier that makes the imageStore() writes
+// visible to the next pass's texture fetch and to glGetTexImage readback.
+class BarrierDispatchCompute : public osg::DispatchCompute
+{
+public:
+    BarrierDispatchCompute(GLint groupsX, GLint groupsY)
+        : osg::DispatchCompute(groupsX, groupsY, 1) {}
+
+    void drawImplementation(osg::RenderInfo& renderInfo) const override
+    {
+        osg::DispatchCompute::drawImplementation(renderInfo);
+        renderInfo.getState()->get<osg::GLExtensions>()->glMemoryBarrier(
+            GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT |
+            GL_PIXEL_BUFFER_BARRIER_BIT);
+    }
+};
+
+// Entry camera: program binaries and the hot-reload compile context.
+class ChainEntryDrawCallback : public osg::Camera::DrawCallback
+{
+public:
+    ChainEntryDrawCallback(ShaderHotReload* hotReload) : m_hotReload(hotReload) {}
+    void operator()(osg::RenderInfo& renderInfo) const override
+    {
+        ProgramCache::instance().processBinaries(renderInfo);
+        osg::ref_ptr<ShaderHotReload> hotReload;
+        if (m_hotReload.lock(hotReload))
+            hotReload->onDraw(renderInfo);
+    }
+private:
+    osg::observer_ptr<ShaderHotReload> m_hotReload;
+};
+
+// The chain's one per-frame callback: render size, frame block, the
+// effects' enabled flags, the temporal stage's sub-frame, the effects'
+// feature keys and, with hot reload, the shader directory.
+class ChainUpdateCallback : public osg::NodeCallback
+{
+public:
+    ChainUpdateCallback(PostProcessChain* chain) : m_chain(chain) {}
+    void operator()(osg::Node* node, osg::NodeVisitor* nv) override
+    {
+        m_chain->updateDynamicResolution(nv->getFrameStamp());
+        m_chain->updateFrame(nv->getFrameStamp());
+        m_chain->updateBypass();
+        m_chain->updateTemporal();
+        m_chain->updateSpecialization();
+        m_chain->updateHotReload();
+        traverse(node, nv);
+    }
+private:
+    PostProcessChain* m_chain;
+};
+
 // ============================================================================
 PostProcessChain::PostProcessChain(unsigned int width, unsigned int height,
                                    const std::string& shaderDir)
-    : m_width(width), m_height(height), m_shaderDir(shaderDir)
+    : m_width(width), m_height(height),
+      m_baseWidth(width), m_baseHeight(height), m_shaderDir(shaderDir)
 {
     loadCommonSources();
 }
@@ -50,98 +222,762 @@ void PostProcessChain::addEffect(std::shared_ptr<INoiseEffect> effect)
 }
 
 // ============================================================================
-osg::ref_ptr<osg::Group> PostProcessChain::build(osg::ref_ptr<osg::Node> scene)
+void PostProcessChain::insertEffect(std::size_t index, std::shared_ptr<INoiseEffect> effect)
 {
-    osg::ref_ptr<osg::Group> root = new osg::Group;
-
-    // ── Scene RTT camera (renders 3D scene to texture) ──────────────────
-    osg::ref_ptr<osg::Texture2D> sceneTexture = new osg::Texture2D;
-    sceneTexture->setTextureSize(m_width, m_height);
-    sceneTexture->setInternalFormat(GL_RGBA);
-    sceneTexture->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::LINEAR);
-    sceneTexture->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::LINEAR);
-    sceneTexture->setWrap(osg::Texture2D::WRAP_S, osg::Texture2D::CLAMP_TO_EDGE);
-    sceneTexture->setWrap(osg::Texture2D::WRAP_T, osg::Texture2D::CLAMP_TO_EDGE);
+    index = std::min(index, m_effects.size());
+    m_effects.insert(m_effects.begin() + static_cast<std::ptrdiff_t>(index), std::move(effect));
+}
 
+// ============================================================================
+osg::ref_ptr<osg::Camera> PostProcessChain::createSceneCamera(osg::ref_ptr<osg::Node> scene,
+                                                              osg::Texture2D* target)
+{
     osg::ref_ptr<osg::Camera> sceneCamera = new osg::Camera;
     sceneCamera->setClearColor(osg::Vec4(0.1f, 0.1f, 0.15f, 1.0f));
     sceneCamera->setClearMask(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     sceneCamera->setRenderOrder(osg::Camera::PRE_RENDER, 0);
     sceneCamera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
-    sceneCamera->setViewport(0, 0, m_width, m_height);
-    sceneCamera->attach(osg::Camera::COLOR_BUFFER0, sceneTexture);
+    sceneCamera->setViewport(0, 0, target->getTextureWidth(), target->getTextureHeight());
+    sceneCamera->attach(osg::Camera::COLOR_BUFFER0, target);
     sceneCamera->setReferenceFrame(osg::Transform::RELATIVE_RF);
     sceneCamera->addChild(scene);
+    return sceneCamera;
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Group> PostProcessChain::build(osg::ref_ptr<osg::Node> scene)
+{
+    // ── Scene RTT camera (renders 3D scene to texture) ──────────────────
+    osg::ref_ptr<osg::Texture2D> sceneTexture = RenderTargetPool::createTexture(
+        sceneDimension(m_width), sceneDimension(m_height), getSignalInternalFormat());
+    osg::ref_ptr<osg::Camera> sceneCamera = createSceneCamera(scene, sceneTexture);
 
+    osg::ref_ptr<osg::Group> root = new osg::Group;
     root->addChild(sceneCamera);
+    m_sceneCamera = sceneCamera;
+    buildPasses(root, sceneTexture, sceneCamera);
+    return root;
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Group> PostProcessChain::buildFromTexture(osg::ref_ptr<osg::Texture2D> input)
+{
+    osg::ref_ptr<osg::Group> root = new osg::Group;
+    m_sceneCamera = nullptr;
+    buildPasses(root, input, nullptr);
+    return root;
+}
 
-    // ── Filter out disabled effects ─────────────────────────────────────
-    std::vector<std::shared_ptr<INoiseEffect>> activeEffects;
+// ============================================================================
+void PostProcessChain::buildPasses(osg::Group* root, osg::ref_ptr<osg::Texture2D> sceneTexture,
+                                   osg::Camera* entryCamera)
+{
+    m_hotReload = nullptr;
+    if (m_hotReloadEnabled && !ProgramCache::instance().isReadingFromDisk())
+        std::cerr << "[PostProcessChain] WARNING: Hot reload needs shaders read from disk; "
+                     "disabled.\n";
+    else if (m_hotReloadEnabled)
+        m_hotReload = new ShaderHotReload(m_shaderDir);
+
+    m_sceneTexture = sceneTexture;
+    m_passes.clear();
+    m_temporalPass = -1;
+    m_subFrame     = 0;
+
+    // ── Shared per-frame block; effects learn the chain size ────────────
+    FrameBlock block = {};
+    block.resolution[0] = static_cast<float>(m_width);
+    block.resolution[1] = static_cast<float>(m_height);
+    block.exposure      = m_exposure;
+    block.seed[0]       = static_cast<std::uint32_t>(m_seed);
+    block.seed[1]       = static_cast<std::uint32_t>(m_seed >> 32);
+    m_frameCount   = 0;
+    m_frameBlock   = new osg::BufferTemplate<FrameBlock>;
+    m_frameBlock->setData(block);
+    m_frameBlock->setDataVariance(osg::Object::DYNAMIC);
+    m_frameBlock->setBufferObject(new osg::UniformBufferObject);
+    m_frameBinding = new osg::UniformBufferBinding(FRAME_BLOCK_BINDING, m_frameBlock.get(),
+                                                   0, sizeof(FrameBlock));
+    for (auto& e : m_effects)
+        e->setResolution(m_width, m_height);
+    applyRegion();
+    m_gpuTimer = m_gpuTiming ? new GpuTimer : nullptr;
+    if (!m_pool)
+        m_pool = std::make_shared<RenderTargetPool>();
+
+    // ── Layered mode needs an offscreen target and a single fused pass ──
+    m_builtLayers = std::max(1u, std::min(m_layerCount, MAX_LAYERS));
+    if (m_builtLayers > 1 && !m_offscreenOutput)
+    {
+        std::cerr << "[PostProcessChain] WARNING: Layered mode needs offscreen output; "
+                     "rendering one layer.\n";
+        m_builtLayers = 1;
+    }
     for (auto& e : m_effects)
     {
-        if (e->isEnabled())
-            activeEffects.push_back(e);
+        if (m_builtLayers > 1 && e->getApplyFunction().empty())
+        {
+            std::cerr << "[PostProcessChain] WARNING: " << e->getName()
+                      << " cannot be fused; rendering one layer.\n";
+            m_builtLayers = 1;
+        }
+    }
+    if (m_builtLayers > 1 && m_layeredGeometrySource.empty())
+    {
+        m_layeredGeometrySource = readFile(m_shaderDir + "/layered_quad.geom");
+        if (m_layeredGeometrySource.empty())
+            m_builtLayers = 1;
+    }
+
+    // ── CFA demosaic: an extra final pass, so not with layers ───────────
+    m_demosaic = nullptr;
+    if (m_demosaicEnabled && m_cfaPattern == CfaPattern::None)
+        std::cerr << "[PostProcessChain] WARNING: Demosaic needs a CFA pattern; skipped.\n";
+    else if (m_demosaicEnabled && m_builtLayers > 1)
+        std::cerr << "[PostProcessChain] WARNING: No demosaic in layered mode; "
+                     "writing raw layers.\n";
+    else if (m_demosaicEnabled)
+        m_demosaic = std::make_shared<DemosaicEffect>(m_shaderDir);
+
+    // The offscreen target is read back by the caller, so it is never pooled.
+    // It holds quantised output, so 16-bit unorm is enough for any ADC; a
+    // CFA raw frame has a single channel.
+    const bool  unorm8 = m_signalFormat == SignalFormat::UNorm8;
+    const GLint outputFormat = rawOutput() ? (unorm8 ? GL_R8 : GL_R16)
+                                           : (unorm8 ? GL_RGBA : GL_RGBA16);
+    m_outputTexture = nullptr;
+    m_outputArray   = nullptr;
+    if (m_builtLayers > 1)
+    {
+        m_outputArray = new osg::Texture2DArray;
+        m_outputArray->setTextureSize(m_width, m_height, m_builtLayers);
+        m_outputArray->setInternalFormat(outputFormat);
+        if (outputFormat != GL_RGBA)
+        {
+            m_outputArray->setSourceFormat(rawOutput() ? GL_RED : GL_RGBA);
+            m_outputArray->setSourceType(unorm8 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT);
+        }
+        m_outputArray->setFilter(osg::Texture::MIN_FILTER, osg::Texture::LINEAR);
+        m_outputArray->setFilter(osg::Texture::MAG_FILTER, osg::Texture::LINEAR);
+        m_outputArray->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+        m_outputArray->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+    }
+    else if (m_offscreenOutput)
+    {
+        m_outputTexture = RenderTargetPool::createTexture(m_width, m_height, outputFormat);
+        // Shown as grey wherever it is sampled (e.g. a rig mosaic); the
+        // swizzle does not affect readback.
+        if (rawOutput())
+            m_outputTexture->setSwizzle(osg::Vec4i(GL_RED, GL_RED, GL_RED, GL_ONE));
+    }
+    if (m_poissonQuality == PoissonQuality::Table && !m_poissonTable)
+        m_poissonTable = PoissonTable::createTexture();
+    m_passthroughProgram = createProgram("Passthrough",
+                                         assembleFragmentSource({}, false));
+
+    if (m_effects.empty())
+    {
+        std::cerr << "[PostProcessChain] WARNING: No effects.\n";
+        return;
+    }
+
+    // ── Group effects into passes ───────────────────────────────────────
+    // Multi-pass: one effect per pass.  Fused: everything in one pass,
+    // provided every effect exposes an apply function.  Disabled effects
+    // are built too so they can be switched on without a rebuild.
+    std::vector<std::vector<std::shared_ptr<INoiseEffect>>> passGroups;
+
+    bool fuse = (m_buildMode == BuildMode::Fused) || m_builtLayers > 1;
+    if (fuse)
+    {
+        for (auto& e : m_effects)
+        {
+            if (e->getApplyFunction().empty())
+            {
+                std::cerr << "[PostProcessChain] WARNING: " << e->getName()
+                          << " has no apply function; falling back to multi-pass.\n";
+                fuse = false;
+                break;
+            }
+        }
+    }
+
+    bool compute = (m_backend == Backend::Compute);
+    if (compute)
+    {
+        for (auto& e : m_effects)
+            if (e->getApplyFunction().empty())
+                compute = false;
+        if (m_builtLayers > 1)
+            compute = false;
+        if (!compute)
+            std::cerr << "[PostProcessChain] WARNING: Compute backend needs fused-capable "
+                         "effects and no layers; using raster passes.\n";
+    }
+
+    if (compute)
+    {
+        // One dispatch; on screen, an empty passthrough pass presents it
+        fuse = true;
+        passGroups.push_back(m_effects);
+        if (!m_offscreenOutput)
+            passGroups.push_back({});
+    }
+    else if (fuse)
+        passGroups.push_back(m_effects);
+    else
+    {
+        bool temporal = false;
+        for (auto& e : m_effects)
+        {
+            if (e->isTemporal() && temporal)
+            {
+                std::cerr << "[PostProcessChain] WARNING: Only one temporal stage per chain; "
+                          << e->getName() << " skipped.\n";
+                continue;
+            }
+            temporal = temporal || e->isTemporal();
+            passGroups.push_back({ e });
+        }
+        // The stage writes its own target, so something must present it
+        if (!passGroups.empty() && passGroups.back().size() == 1 &&
+            passGroups.back()[0]->isTemporal())
+            passGroups.push_back({});
     }
 
-    if (activeEffects.empty())
+    // Demosaic ends the chain, presenting in place of a passthrough
+    if (m_demosaic)
     {
-        std::cerr << "[PostProcessChain] WARNING: No enabled effects.\n";
-        return root;
+        if (!passGroups.empty() && passGroups.back().empty())
+            passGroups.back() = { m_demosaic };
+        else
+            passGroups.push_back({ m_demosaic });
     }
 
     // ── Build effect passes ─────────────────────────────────────────────
+    // Passes after a temporal stage run once per exposure, so they get
+    // their own pool slots (2, 3) that the sub-frame passes never touch.
     osg::ref_ptr<osg::Texture2D> currentInput = sceneTexture;
+    unsigned int slotBase = 0;
 
-    for (size_t i = 0; i < activeEffects.size(); ++i)
+    for (size_t i = 0; i < passGroups.size(); ++i)
     {
-        bool isFinal = (i == activeEffects.size() - 1);
-        Pass pass = createPass(currentInput, activeEffects[i], isFinal);
-
-        // Set render order: intermediate passes are PRE_RENDER with
-        // increasing order index; the final pass is POST_RENDER.
-        if (!isFinal)
+        bool isFinal = (i == passGroups.size() - 1);
+        const bool temporal = passGroups[i].size() == 1 && passGroups[i][0]->isTemporal();
+        osg::ref_ptr<osg::Texture2D> output = isFinal || temporal
+            ? nullptr : acquireIntermediate(slotBase + static_cast<unsigned int>(i % 2));
+        Pass pass = temporal
+            ? createTemporalPass(currentInput, passGroups[i][0])
+            : (compute && i == 0)
+            ? createComputePass(currentInput, isFinal ? m_outputTexture : output,
+                                passGroups[i], isFinal)
+            : createPass(currentInput, output, passGroups[i], isFinal);
+        if (temporal)
         {
-            pass.camera->setRenderOrder(osg::Camera::PRE_RENDER,
-                                        static_cast<int>(i) + 1);
+            m_temporalPass = static_cast<int>(i);
+            slotBase = 2;
         }
 
+        // Set render order: passes are PRE_RENDER with increasing order
+        // index from the chain's base; only an on-screen final pass is
+        // POST_RENDER.  Chains with disjoint bases run back to back.
+        const int order = m_renderOrderBase + static_cast<int>(i) + 1;
+        if (!isFinal || pass.compute || m_outputTexture.valid() || m_outputArray.valid())
+            pass.camera->setRenderOrder(osg::Camera::PRE_RENDER, order);
+
         root->addChild(pass.camera);
+        for (auto& camera : pass.historyCameras)
+        {
+            if (!camera)
+                continue;
+            camera->setRenderOrder(osg::Camera::PRE_RENDER, order);
+            root->addChild(camera);
+        }
 
         // Register update callbacks
-        osg::ref_ptr<osg::NodeCallback> cb = activeEffects[i]->createUpdateCallback();
-        if (cb)
-            root->addUpdateCallback(cb);
+        std::string passName;
+        for (auto& e : passGroups[i])
+        {
+            osg::ref_ptr<osg::NodeCallback> cb = e->createUpdateCallback();
+            if (cb)
+                root->addUpdateCallback(cb);
+
+            passName += (passName.empty() ? "" : " + ") + e->getName();
+        }
+        if (passName.empty())
+            passName = "Present";
+
+        if (m_gpuTimer.valid())
+            m_gpuTimer->attach(pass.camera, passName);
 
-        std::cout << "[PostProcessChain] Pass " << i << ": "
-                  << activeEffects[i]->getName()
+        std::cout << "[PostProcessChain] Pass " << i << ": " << passName
+                  << (pass.compute ? " (compute)" : fuse && !pass.effects.empty() ? " (fused)" : "")
+                  << (pass.temporal ? " (temporal)" : "")
+                  << (m_builtLayers > 1 ? " (" + std::to_string(m_builtLayers) + " layers)" : "")
                   << (isFinal ? " (final)" : "") << "\n";
 
         currentInput = pass.outputTexture; // may be nullptr for final pass
+        m_passes.push_back(pass);
     }
 
-    return root;
+    // Apply the current enabled flags now, then keep them in sync.
+    updateBypass();
+    root->addUpdateCallback(new ChainUpdateCallback(this));
+
+    // First camera drawn: program binaries are loaded before any pass
+    // applies its program; hot reload borrows the context.
+    if (!entryCamera)
+        entryCamera = m_passes.front().camera.get();
+    if (!ProgramCache::instance().getBinaryCacheDirectory().empty() || m_hotReload.valid())
+        entryCamera->setInitialDrawCallback(new ChainEntryDrawCallback(m_hotReload.get()));
+}
+
+// ============================================================================
+void PostProcessChain::setExposure(float exposure)
+{
+    m_exposure = std::max(0.0f, exposure);
+    if (m_frameBlock.valid())
+    {
+        m_frameBlock->getData().exposure = m_exposure;
+        m_frameBlock->dirty();
+    }
+}
+
+// ============================================================================
+void PostProcessChain::setSeed(std::uint64_t seed)
+{
+    m_seed = seed;
+    if (m_frameBlock.valid())
+    {
+        m_frameBlock->getData().seed[0] = static_cast<std::uint32_t>(seed);
+        m_frameBlock->getData().seed[1] = static_cast<std::uint32_t>(seed >> 32);
+        m_frameBlock->dirty();
+    }
+}
+
+// ============================================================================
+void PostProcessChain::setRegion(unsigned int x, unsigned int y,
+                                 unsigned int sensorWidth, unsigned int sensorHeight)
+{
+    if (sensorWidth > 65536 || sensorHeight > 65536)
+        std::cerr << "[PostProcessChain] WARNING: Sensor " << sensorWidth << "x" << sensorHeight
+                  << " exceeds 65536 pixels a side; the noise repeats past it.\n";
+    m_regionX      = sensorWidth  ? x : 0;
+    m_regionY      = sensorHeight ? y : 0;
+    m_sensorWidth  = sensorWidth;
+    m_sensorHeight = sensorHeight;
+    if (m_regionX + m_width > getSensorWidth() || m_regionY + m_height > getSensorHeight())
+        std::cerr << "[PostProcessChain] WARNING: Region " << m_width << "x" << m_height
+                  << " at " << m_regionX << "," << m_regionY << " exceeds the "
+                  << getSensorWidth() << "x" << getSensorHeight() << " sensor.\n";
+    if (m_frameBlock.valid())
+        applyRegion();
+}
+
+// ============================================================================
+void PostProcessChain::applyRegion()
+{
+    FrameBlock& block = m_frameBlock->getData();
+    block.tileOffset[0] = static_cast<float>(m_regionX);
+    block.tileOffset[1] = static_cast<float>(m_regionY);
+    block.sensorSize[0] = static_cast<float>(getSensorWidth());
+    block.sensorSize[1] = static_cast<float>(getSensorHeight());
+    m_frameBlock->dirty();
+    for (auto& e : m_effects)
+        e->setRegion(m_regionX, m_regionY, getSensorWidth(), getSensorHeight());
+}
+
+// ============================================================================
+void PostProcessChain::updateFrame(const osg::FrameStamp* frameStamp)
+{
+    if (!m_frameBlock.valid())
+        return;
+    FrameBlock& block = m_frameBlock->getData();
+    block.frameNumber = m_frameCount++;
+    block.time = frameStamp ? static_cast<float>(frameStamp->getSimulationTime()) : 0.0f;
+    m_frameBlock->dirty();
+}
+
+// ============================================================================
+void PostProcessChain::resize(unsigned int width, unsigned int height)
+{
+    m_baseWidth  = std::max(1u, width);
+    m_baseHeight = std::max(1u, height);
+    applyRenderSize(
+        std::max(1u, static_cast<unsigned int>(m_baseWidth  * m_renderScale + 0.5f)),
+        std::max(1u, static_cast<unsigned int>(m_baseHeight * m_renderScale + 0.5f)));
+}
+
+// ============================================================================
+void PostProcessChain::setDynamicResolution(bool on, double targetFrameMs, float minScale)
+{
+    if (on && m_offscreenOutput)
+    {
+        std::cerr << "[PostProcessChain] WARNING: Dynamic resolution needs on-screen "
+                     "output; disabled.\n";
+        on = false;
+    }
+    m_dynamicResolution = on;
+    m_targetFrameMs     = std::max(1.0, targetFrameMs);
+    m_minScale          = std::min(1.0f, std::max(1.0f / 16.0f, minScale));
+    m_lastFrameTime     = -1.0;
+    m_avgFrameMs        = 0.0;
+    m_framesSinceScale  = 0;
+    if (!on && m_renderScale != 1.0f)
+    {
+        m_renderScale = 1.0f;
+        resize(m_baseWidth, m_baseHeight);
+    }
+}
+
+// ============================================================================
+void PostProcessChain::updateDynamicResolution(const osg::FrameStamp* frameStamp)
+{
+    if (!m_dynamicResolution || m_offscreenOutput || !frameStamp || m_passes.empty())
+        return;
+
+    // Smoothed frame-to-frame time; re-evaluated every kInterval frames
+    // so one resize has settled (and one hitch has faded) before the next.
+    static const unsigned int kInterval = 30;
+    const double now = frameStamp->getReferenceTime();
+    if (m_lastFrameTime >= 0.0)
+    {
+        const double ms = (now - m_lastFrameTime) * 1000.0;
+        m_avgFrameMs = m_avgFrameMs > 0.0 ? 0.9 * m_avgFrameMs + 0.1 * ms : ms;
+    }
+    m_lastFrameTime = now;
+    if (++m_framesSinceScale < kInterval || m_avgFrameMs <= 0.0)
+        return;
+    m_framesSinceScale = 0;
+
+    // Cost follows the pixel count, i.e. the square of the scale.  The
+    // dead band (5 % over, 15 % under) keeps the size from oscillating.
+    const double ratio = m_targetFrameMs / m_avgFrameMs;
+    if (ratio > 1.0 / 1.05 && ratio < 1.0 / 0.85)
+        return;
+    float scale = m_renderScale * static_cast<float>(std::sqrt(ratio));
+    scale = std::round(scale * 16.0f) / 16.0f;
+    scale = std::min(1.0f, std::max(m_minScale, scale));
+    if (scale == m_renderScale)
+        return;
+
+    std::cout << "[PostProcessChain] Render scale " << m_renderScale << " -> " << scale
+              << " (" << m_avgFrameMs << " ms, target " << m_targetFrameMs << " ms)\n";
+    m_renderScale = scale;
+    m_avgFrameMs  = 0.0;
+    resize(m_baseWidth, m_baseHeight);
+}
+
+// ============================================================================
+void PostProcessChain::setSceneScale(float scale)
+{
+    m_sceneScale = std::min(1.0f, std::max(1.0f / 16.0f, scale));
+    applySceneSize();
+}
+
+// ============================================================================
+unsigned int PostProcessChain::sceneDimension(unsigned int size) const
+{
+    return std::max(1u, static_cast<unsigned int>(size * m_sceneScale + 0.5f));
+}
+
+// ============================================================================
+void PostProcessChain::applySceneSize()
+{
+    if (!m_sceneCamera.valid())
+        return;
+    const unsigned int width  = sceneDimension(m_width);
+    const unsigned int height = sceneDimension(m_height);
+    if (m_sceneTexture->getTextureWidth()  == static_cast<int>(width) &&
+        m_sceneTexture->getTextureHeight() == static_cast<int>(height))
+        return;
+    m_sceneTexture->setTextureSize(width, height);
+    m_sceneTexture->dirtyTextureObject();
+    m_sceneCamera->setViewport(0, 0, width, height);
+    m_sceneCamera->dirtyAttachmentMap();
+}
+
+// ============================================================================
+void PostProcessChain::applyRenderSize(unsigned int width, unsigned int height)
+{
+    if (width == m_width && height == m_height)
+        return;
+    const RenderTargetPool::Key oldKey = { m_width, m_height, getIntermediateFormat() };
+    m_width  = width;
+    m_height = height;
+    if (m_passes.empty())
+        return;   // not built yet: buildPasses() uses the new size
+
+    // ── Targets the chain owns are resized in place ─────────────────────
+    applySceneSize();
+    if (m_outputTexture.valid())
+    {
+        m_outputTexture->setTextureSize(width, height);
+        m_outputTexture->dirtyTextureObject();
+    }
+    if (m_outputArray.valid())
+    {
+        m_outputArray->setTextureSize(width, height, m_builtLayers);
+        m_outputArray->dirtyTextureObject();
+    }
+
+    // ── Passes: viewports, dispatch size, compute output ────────────────
+    for (auto& pass : m_passes)
+    {
+        if (pass.camera->getViewport())
+            pass.camera->setViewport(0, 0, width, height);
+        if (pass.isFinal && (m_outputTexture.valid() || m_outputArray.valid()))
+            pass.camera->dirtyAttachmentMap();
+
+        if (pass.temporal)
+        {
+            // The history no longer matches: start the exposure over
+            for (osg::Texture2D* tex : { pass.outputTexture.get(), pass.historyTextures[0].get(),
+                                         pass.historyTextures[1].get() })
+            {
+                tex->setTextureSize(width, height);
+                tex->dirtyTextureObject();
+            }
+            pass.camera->dirtyAttachmentMap();
+            for (auto& camera : pass.historyCameras)
+            {
+                camera->setViewport(0, 0, width, height);
+                camera->dirtyAttachmentMap();
+            }
+            m_subFrame = 0;
+        }
+
+        if (pass.compute)
+        {
+            pass.dispatch->setComputeGroups(
+                static_cast<GLint>((width  + kComputeTile - 1) / kComputeTile),
+                static_cast<GLint>((height + kComputeTile - 1) / kComputeTile), 1);
+            if (!pass.isFinal)
+            {
+                pass.outputTexture = acquireIntermediate(0);
+                const GLint format = pass.outputTexture->getInternalFormat();
+                pass.stateSet->setAttributeAndModes(
+                    new osg::BindImageTexture(0, pass.outputTexture.get(),
+                                              osg::BindImageTexture::WRITE_ONLY,
+                                              sizedImageFormat(format)),
+                    osg::StateAttribute::ON);
+            }
+        }
+    }
+
+    // The pool drops the old size once no chain sharing it uses it
+    m_pool->release(oldKey, this);
+
+    // ── Shared resolution and per-pixel maps ────────────────────────────
+    m_frameBlock->getData().resolution[0] = static_cast<float>(width);
+    m_frameBlock->getData().resolution[1] = static_cast<float>(height);
+    m_frameBlock->dirty();
+    for (auto& e : m_effects)
+        e->setResolution(width, height);
+    applyRegion();
+
+    // Raster intermediates are re-acquired at the new size by the rewire
+    m_targetsChanged = true;
+    updateBypass();
+}
+
+// ============================================================================
+void PostProcessChain::updateBypass()
+{
+    bool changed = m_targetsChanged;
+    m_targetsChanged = false;
+    for (auto& pass : m_passes)
+    {
+        for (size_t k = 0; k < pass.effects.size(); ++k)
+        {
+            bool on = pass.effects[k]->isEnabled();
+            if (k >= pass.enabled.size() || pass.enabled[k] != on)
+                changed = true;
+        }
+    }
+    if (!changed)
+        return;
+
+    // Walk the passes in order, feeding each enabled pass the output of
+    // the previous enabled one.  Enabled intermediates alternate between
+    // the two pooled targets; skipping a pass can flip the parity, so the
+    // attachment is re-pointed (the FBO is rebuilt, the texture is not).
+    // The final pass always draws (it owns the screen); when its effect is
+    // off it falls back to a passthrough.
+    osg::ref_ptr<osg::Texture2D> currentInput = m_sceneTexture;
+    unsigned int activeIntermediates = 0;
+    unsigned int slotBase = 0;
+
+    // CFA: the first generated pass in line mosaics, later ones see raw
+    bool raw = false;
+    auto feedRaw = [&raw](Pass& pass)
+    {
+        if (!pass.rawInputUniform.valid())
+            return;
+        pass.rawInputUniform->set(raw);
+        raw = true;
+    };
+
+    for (auto& pass : m_passes)
+    {
+        bool anyOn = false;
+        pass.enabled.resize(pass.effects.size());
+        for (size_t k = 0; k < pass.effects.size(); ++k)
+        {
+            bool on = pass.effects[k]->isEnabled();
+            if (pass.enabledUniform.valid())
+                pass.enabledUniform->setElement(static_cast<unsigned int>(k), on);
+            if (pass.enabled[k] != on)
+                std::cout << "[PostProcessChain] " << pass.effects[k]->getName()
+                          << (on ? " enabled" : " bypassed") << "\n";
+            pass.enabled[k] = on;
+            anyOn = anyOn || on;
+        }
+
+        osg::StateSet* ss = pass.stateSet.get();
+
+        if (pass.compute)
+        {
+            // Always dispatched (the gates handle bypass); fixed output
+            ss->setTextureAttributeAndModes(0, currentInput, osg::StateAttribute::ON);
+            feedRaw(pass);
+            currentInput = pass.outputTexture;
+        }
+        else if (pass.temporal)
+        {
+            // Fixed output; updateTemporal() picks the camera per frame
+            pass.camera->setNodeMask(anyOn ? ~0u : 0u);
+            if (!anyOn)
+                continue;
+            ss->setTextureAttributeAndModes(0, currentInput, osg::StateAttribute::ON);
+            currentInput = pass.outputTexture;
+            slotBase = 2;
+            activeIntermediates = 0;
+        }
+        else if (!pass.isFinal)
+        {
+            pass.camera->setNodeMask(anyOn ? ~0u : 0u);
+            if (!anyOn)
+                continue;
+
+            osg::ref_ptr<osg::Texture2D> output =
+                acquireIntermediate(slotBase + activeIntermediates++ % 2);
+            if (output != pass.outputTexture)
+            {
+                pass.camera->detach(osg::Camera::COLOR_BUFFER0);
+                pass.camera->attach(osg::Camera::COLOR_BUFFER0, output);
+                pass.camera->dirtyAttachmentMap();
+                pass.outputTexture = output;
+            }
+
+            ss->setTextureAttributeAndModes(0, currentInput, osg::StateAttribute::ON);
+            feedRaw(pass);
+            currentInput = pass.outputTexture;
+        }
+        else
+        {
+            ss->setTextureAttributeAndModes(0, currentInput, osg::StateAttribute::ON);
+            feedRaw(pass);
+            ss->setAttributeAndModes(anyOn ? pass.program.get()
+                                           : m_passthroughProgram.get(),
+                                     osg::StateAttribute::ON);
+        }
+    }
+}
+
+// ============================================================================
+void PostProcessChain::updateTemporal()
+{
+    if (m_temporalPass < 0)
+        return;
+    Pass& stage = m_passes[m_temporalPass];
+    INoiseEffect& effect = *stage.effects[0];
+    const bool active = effect.isEnabled();
+    const unsigned int n = std::max(1u, effect.getSubFrames());
+    const unsigned int sub = m_subFrame < n ? m_subFrame : 0;
+    m_subFrame = (sub + 1) % n;
+    const bool last = !active || sub == n - 1;
+
+    // Sub-frame i < n-1 is drawn by history camera i % 2 (reading the
+    // other history texture); the last one by the stage camera into the
+    // output, reading whichever history sub-frame n-2 wrote.
+    if (active)
+    {
+        effect.beginSubFrame(sub);
+        stage.camera->setNodeMask(last ? ~0u : 0u);
+        stage.camera->getOrCreateStateSet()->setTextureAttributeAndModes(
+            INoiseEffect::HISTORY_UNIT, stage.historyTextures[(sub + 1) % 2],
+            osg::StateAttribute::ON);
+    }
+    for (unsigned int k = 0; k < 2; ++k)
+        stage.historyCameras[k]->setNodeMask(active && !last && sub % 2 == k ? ~0u : 0u);
+
+    // Readout runs once per exposure; on screen the final pass keeps
+    // presenting the finished one in between.
+    for (size_t i = m_temporalPass + 1; i < m_passes.size(); ++i)
+    {
+        Pass& pass = m_passes[i];
+        bool on = pass.isFinal ||
+                  std::find(pass.enabled.begin(), pass.enabled.end(), true) != pass.enabled.end();
+        if (!last && !(pass.isFinal && !m_offscreenOutput))
+            on = false;
+        pass.camera->setNodeMask(on ? ~0u : 0u);
+    }
+}
+
+// ============================================================================
+unsigned int PostProcessChain::getSubFramesPerOutput() const
+{
+    if (m_temporalPass < 0)
+        return 1;
+    const INoiseEffect& effect = *m_passes[m_temporalPass].effects[0];
+    return effect.isEnabled() ? std::max(1u, effect.getSubFrames()) : 1u;
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Texture2D> PostProcessChain::acquireIntermediate(unsigned int slot)
+{
+    return m_pool->acquire({ m_width, m_height, getIntermediateFormat() }, slot, this);
+}
+
+// ============================================================================
+GLint PostProcessChain::getIntermediateFormat() const
+{
+    if (m_cfaPattern == CfaPattern::None)
+        return getSignalInternalFormat();
+    switch (m_signalFormat)
+    {
+    case SignalFormat::Float32: return GL_R32F;
+    case SignalFormat::UNorm8:  return GL_R8;
+    default:                    return GL_R16F;   // Float16, R11G11B10F
+    }
+}
+
+// ============================================================================
+GLint PostProcessChain::getSignalInternalFormat() const
+{
+    switch (m_signalFormat)
+    {
+    case SignalFormat::Float16:    return GL_RGBA16F_ARB;
+    case SignalFormat::Float32:    return GL_RGBA32F_ARB;
+    case SignalFormat::R11G11B10F: return GL_R11F_G11F_B10F_EXT;
+    default:                       return GL_RGBA;
+    }
 }
 
 // ============================================================================
 PostProcessChain::Pass PostProcessChain::createPass(
     osg::ref_ptr<osg::Texture2D> inputTexture,
-    std::shared_ptr<INoiseEffect> effect,
+    osg::ref_ptr<osg::Texture2D> outputTexture,
+    const std::vector<std::shared_ptr<INoiseEffect>>& effects,
     bool isFinalPass)
 {
     Pass pass;
-    pass.effect = effect;
+    pass.effects = effects;
+    pass.isFinal = isFinalPass;
 
-    // ── Output texture (not needed for final pass) ──────────────────────
-    if (!isFinalPass)
-    {
-        pass.outputTexture = new osg::Texture2D;
-        pass.outputTexture->setTextureSize(m_width, m_height);
-        pass.outputTexture->setInternalFormat(GL_RGBA);
-        pass.outputTexture->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::LINEAR);
-        pass.outputTexture->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::LINEAR);
-        pass.outputTexture->setWrap(osg::Texture2D::WRAP_S, osg::Texture2D::CLAMP_TO_EDGE);
-        pass.outputTexture->setWrap(osg::Texture2D::WRAP_T, osg::Texture2D::CLAMP_TO_EDGE);
-    }
+    // ── Output texture (pooled; none for the final pass) ────────────────
+    pass.outputTexture = outputTexture;
 
     // ── Camera ──────────────────────────────────────────────────────────
     pass.camera = new osg::Camera;
@@ -151,14 +987,23 @@ PostProcessChain::Pass PostProcessChain::createPass(
     pass.camera->setViewMatrix(osg::Matrix::identity());
 
     if (isFinalPass)
-    {
         pass.camera->setRenderOrder(osg::Camera::POST_RENDER);
+
+    osg::Texture2D* target = isFinalPass ? m_outputTexture.get()
+                                         : pass.outputTexture.get();
+    if (isFinalPass && m_outputArray.valid())
+    {
+        // Layer chosen per primitive by gl_Layer in the geometry shader
+        pass.camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
+        pass.camera->setViewport(0, 0, m_width, m_height);
+        pass.camera->attach(osg::Camera::COLOR_BUFFER0, m_outputArray.get(), 0,
+                            osg::Camera::FACE_CONTROLLED_BY_GEOMETRY_SHADER);
     }
-    else
+    else if (target)
     {
         pass.camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
         pass.camera->setViewport(0, 0, m_width, m_height);
-        pass.camera->attach(osg::Camera::COLOR_BUFFER0, pass.outputTexture);
+        pass.camera->attach(osg::Camera::COLOR_BUFFER0, target);
     }
 
     // Disable depth and lighting
@@ -173,49 +1018,477 @@ PostProcessChain::Pass PostProcessChain::createPass(
     pass.camera->addChild(geode);
 
     // ── Shader program ──────────────────────────────────────────────────
-    // Build the fragment source: #version + noise_utils + effect source
-    std::string fragBody = effect->getFragmentSource();
+    // A fused pass keeps every effect in the source and gates each one
+    // with a uniform, so toggling never triggers a recompile.
+    bool gated = effects.size() > 1;
+    pass.program  = createPassProgram(pass);
+    pass.features = passFeatures(pass.effects);
+
+    // ── State setup ─────────────────────────────────────────────────────
+    // The input texture and program are swapped at runtime by
+    // updateBypass(), so the StateSet is DYNAMIC.
+    osg::StateSet* ss = pass.quadGeom->getOrCreateStateSet();
+    pass.stateSet = ss;
+    ss->setDataVariance(osg::Object::DYNAMIC);
+    ss->setAttributeAndModes(pass.program, osg::StateAttribute::ON);
+    ss->setTextureAttributeAndModes(0, inputTexture, osg::StateAttribute::ON);
+    ss->addUniform(new osg::Uniform("u_inputTexture", 0));
+    ss->setAttributeAndModes(m_frameBinding, osg::StateAttribute::ON);
 
-    // Strip #version from the effect source (we'll add our own)
-    // The effect source starts with #version 330 core
-    std::string fragSource;
-    auto versionPos = fragBody.find("#version");
-    if (versionPos != std::string::npos)
+    if (m_poissonQuality == PoissonQuality::Table)
     {
-        auto lineEnd = fragBody.find('\n', versionPos);
-        std::string versionLine = fragBody.substr(versionPos, lineEnd - versionPos + 1);
-        std::string body = fragBody.substr(lineEnd + 1);
-        fragSource = versionLine + "\n" + m_utilsSource + "\n" + body;
+        ss->setTextureAttributeAndModes(PoissonTable::TEXTURE_UNIT, m_poissonTable,
+                                        osg::StateAttribute::ON);
+        ss->addUniform(new osg::Uniform("u_poissonTable",
+                                        static_cast<int>(PoissonTable::TEXTURE_UNIT)));
     }
-    else
+
+    if (gated)
+    {
+        pass.enabledUniform = new osg::Uniform(osg::Uniform::BOOL, "u_effectEnabled",
+                                               static_cast<int>(effects.size()));
+        ss->addUniform(pass.enabledUniform);
+    }
+
+    // Generated CFA passes mosaic their input unless it already is raw
+    if (m_cfaPattern != CfaPattern::None &&
+        (effects.empty() || !effects[0]->getApplyFunction().empty()))
     {
-        fragSource = "#version 330 core\n" + m_utilsSource + "\n" + fragBody;
+        pass.rawInputUniform = new osg::Uniform("u_inputIsRaw", false);
+        ss->addUniform(pass.rawInputUniform);
     }
 
-    osg::ref_ptr<osg::Shader> vertShader =
-        new osg::Shader(osg::Shader::VERTEX, m_vertexSource);
-    osg::ref_ptr<osg::Shader> fragShader =
-        new osg::Shader(osg::Shader::FRAGMENT, fragSource);
+    // Let each effect set up its own uniforms
+    for (auto& e : effects)
+        e->setupUniforms(ss);
+    markDynamic(ss);
 
-    osg::ref_ptr<osg::Program> program = new osg::Program;
-    program->setName(effect->getName());
-    program->addShader(vertShader);
-    program->addShader(fragShader);
-    program->addBindAttribLocation("osg_Vertex", 0);
-    program->addBindAttribLocation("osg_MultiTexCoord0", 1);
+    return pass;
+}
 
-    // ── State setup ─────────────────────────────────────────────────────
-    osg::StateSet* ss = pass.quadGeom->getOrCreateStateSet();
-    ss->setAttributeAndModes(program, osg::StateAttribute::ON);
+// ============================================================================
+PostProcessChain::Pass PostProcessChain::createTemporalPass(
+    osg::ref_ptr<osg::Texture2D> inputTexture,
+    std::shared_ptr<INoiseEffect> effect)
+{
+    // The exposure and its history are float whatever the signal format,
+    // and never pooled: they must survive the sub-frames in between.
+    osg::ref_ptr<osg::Texture2D> output =
+        RenderTargetPool::createTexture(m_width, m_height, GL_RGBA32F_ARB);
+    Pass pass = createPass(inputTexture, output, { effect }, false);
+    pass.temporal = true;
+    pass.camera->getOrCreateStateSet()->setDataVariance(osg::Object::DYNAMIC);
+
+    for (auto& tex : pass.historyTextures)
+        tex = RenderTargetPool::createTexture(m_width, m_height, GL_RGBA32F_ARB);
+
+    // Same quad, program and input; only the target and history differ
+    osg::Node* quad = pass.camera->getChild(0);
+    for (unsigned int k = 0; k < 2; ++k)
+    {
+        osg::ref_ptr<osg::Camera> camera = new osg::Camera;
+        camera->setClearMask(0);
+        camera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
+        camera->setProjectionMatrix(osg::Matrix::ortho2D(0.0, 1.0, 0.0, 1.0));
+        camera->setViewMatrix(osg::Matrix::identity());
+        camera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
+        camera->setViewport(0, 0, m_width, m_height);
+        camera->attach(osg::Camera::COLOR_BUFFER0, pass.historyTextures[k].get());
+        camera->setNodeMask(0u);
+
+        osg::StateSet* camSS = camera->getOrCreateStateSet();
+        camSS->setMode(GL_DEPTH_TEST, osg::StateAttribute::OFF);
+        camSS->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+        camSS->setTextureAttributeAndModes(INoiseEffect::HISTORY_UNIT,
+                                           pass.historyTextures[1 - k],
+                                           osg::StateAttribute::ON);
+        camera->addChild(quad);
+        pass.historyCameras[k] = camera;
+    }
+    return pass;
+}
+
+// ============================================================================
+PostProcessChain::Pass PostProcessChain::createComputePass(
+    osg::ref_ptr<osg::Texture2D> inputTexture,
+    osg::ref_ptr<osg::Texture2D> outputTexture,
+    const std::vector<std::shared_ptr<INoiseEffect>>& effects,
+    bool isFinalPass)
+{
+    Pass pass;
+    pass.effects       = effects;
+    pass.isFinal       = isFinalPass;
+    pass.compute       = true;
+    pass.outputTexture = outputTexture;
+
+    // ── Camera (no target of its own; it only orders the dispatch) ──────
+    pass.camera = new osg::Camera;
+    pass.camera->setClearMask(0);
+    pass.camera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
+    pass.camera->setRenderOrder(osg::Camera::PRE_RENDER, 1);
+    pass.camera->setViewport(0, 0, m_width, m_height);
+
+    // ── Dispatch over 16x16 tiles ───────────────────────────────────────
+    const GLint groupsX = static_cast<GLint>((m_width  + kComputeTile - 1) / kComputeTile);
+    const GLint groupsY = static_cast<GLint>((m_height + kComputeTile - 1) / kComputeTile);
+    osg::ref_ptr<BarrierDispatchCompute> dispatch = new BarrierDispatchCompute(groupsX, groupsY);
+    dispatch->setCullingActive(false);
+    dispatch->setDataVariance(osg::Object::DYNAMIC);   // groups follow resize()
+    pass.dispatch = dispatch;
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->setCullingActive(false);
+    geode->addDrawable(dispatch);
+    pass.camera->addChild(geode);
+
+    // ── Shader program ──────────────────────────────────────────────────
+    const GLint outputFormat = outputTexture->getInternalFormat();
+    pass.program  = createPassProgram(pass);
+    pass.features = passFeatures(pass.effects);
+
+    // ── State setup (same units and uniforms as a raster pass) ──────────
+    osg::StateSet* ss = dispatch->getOrCreateStateSet();
+    pass.stateSet = ss;
+    ss->setDataVariance(osg::Object::DYNAMIC);
+    ss->setAttributeAndModes(pass.program, osg::StateAttribute::ON);
     ss->setTextureAttributeAndModes(0, inputTexture, osg::StateAttribute::ON);
     ss->addUniform(new osg::Uniform("u_inputTexture", 0));
+    ss->setAttributeAndModes(m_frameBinding, osg::StateAttribute::ON);
+    ss->setAttributeAndModes(new osg::BindImageTexture(0, outputTexture.get(),
+                                                       osg::BindImageTexture::WRITE_ONLY,
+                                                       sizedImageFormat(outputFormat)),
+                             osg::StateAttribute::ON);
+
+    if (m_poissonQuality == PoissonQuality::Table)
+    {
+        ss->setTextureAttributeAndModes(PoissonTable::TEXTURE_UNIT, m_poissonTable,
+                                        osg::StateAttribute::ON);
+        ss->addUniform(new osg::Uniform("u_poissonTable",
+                                        static_cast<int>(PoissonTable::TEXTURE_UNIT)));
+    }
 
-    // Let the effect set up its own uniforms
-    effect->setupUniforms(ss);
+    pass.enabledUniform = new osg::Uniform(osg::Uniform::BOOL, "u_effectEnabled",
+                                           static_cast<int>(effects.size()));
+    ss->addUniform(pass.enabledUniform);
+    if (m_cfaPattern != CfaPattern::None)
+    {
+        pass.rawInputUniform = new osg::Uniform("u_inputIsRaw", false);
+        ss->addUniform(pass.rawInputUniform);
+    }
+
+    for (auto& e : effects)
+        e->setupUniforms(ss);
+    markDynamic(ss);
 
     return pass;
 }
 
+// ============================================================================
+std::string PostProcessChain::shaderDefines() const
+{
+    std::string defines = "#define POISSON_QUALITY "
+        + std::to_string(static_cast<int>(m_poissonQuality)) + "\n";
+    if (m_builtLayers > 1)
+        defines += "#define CHAIN_LAYERS " + std::to_string(m_builtLayers) + "\n";
+    if (m_cfaPattern != CfaPattern::None)
+        defines += "#define CFA_PATTERN " + std::to_string(static_cast<int>(m_cfaPattern)) + "\n";
+    return defines;
+}
+
+// ============================================================================
+std::string PostProcessChain::assembleFragmentSource(
+    const std::vector<std::shared_ptr<INoiseEffect>>& effects,
+    bool gated) const
+{
+    std::string versionLine, body;
+    const std::string defines = shaderDefines();
+    const bool cfa = m_cfaPattern != CfaPattern::None;
+
+    // Self-contained effect shader (own main): #version + noise_utils + body
+    if (effects.size() == 1 && effects[0]->getApplyFunction().empty())
+    {
+        splitVersionLine(effects[0]->getFragmentSource(), versionLine, body);
+        return versionLine + defines + "\n" + kFrameBlock + "\n" + m_utilsSource + "\n"
+             + featureDefines(*effects[0]) + body;
+    }
+
+    // Generated shader: preamble + noise_utils + every effect's apply
+    // function, then a main() that calls them in chain order.
+    // An empty effect list yields a plain passthrough shader.
+    std::string effectBodies;
+    std::string mainBody;
+    assembleEffectCalls(effects, gated, effectBodies, mainBody);
+
+    // Effects share the first effect's GLSL version
+    if (!effects.empty())
+        splitVersionLine(effects[0]->getFragmentSource(), versionLine, body);
+    if (versionLine.empty())
+        versionLine = "#version 330 core\n";
+
+    std::string gateDecl;
+    if (gated)
+        gateDecl = "uniform bool      u_effectEnabled["
+                 + std::to_string(effects.size()) + "];\n";
+    if (cfa)
+        gateDecl += kCfaDecl;
+
+    return versionLine + defines + "\n"
+         + (m_builtLayers > 1 ? kLayeredPreamble : kChainPreamble) + gateDecl + "\n"
+         + m_utilsSource + "\n"
+         + effectBodies
+         + "void main()\n"
+           "{\n"
+           "    vec2 fragCoord = v_texCoord * u_resolution + u_tileOffset;\n"
+           "    vec3 color = texture(u_inputTexture, v_texCoord).rgb;\n"
+         + (cfa ? kCfaMosaic : std::string())
+         + mainBody
+         + (cfa ? "    fragColor = vec4(color.rrr, 1.0);\n"
+                : "    fragColor = vec4(color, 1.0);\n")
+         + "}\n";
+}
+
+// ============================================================================
+void PostProcessChain::assembleEffectCalls(
+    const std::vector<std::shared_ptr<INoiseEffect>>& effects, bool gated,
+    std::string& effectBodies, std::string& mainBody) const
+{
+    const bool clampSignal = (m_signalFormat == SignalFormat::UNorm8);
+    for (size_t i = 0; i < effects.size(); ++i)
+    {
+        const auto& e = effects[i];
+        std::string effectVersion, body;
+        splitVersionLine(e->getFragmentSource(), effectVersion, body);
+
+        effectBodies += featureDefines(*e) + body + "\n";
+        mainBody += gated ? "    if (u_effectEnabled[" + std::to_string(i) + "])\n    "
+                          : std::string();
+        // 8-bit storage clips anyway; float storage keeps the linear
+        // signal (including negative read noise) until the ADC.
+        mainBody += clampSignal
+            ? "    color = clamp(" + e->getApplyFunction() + "(color, fragCoord), 0.0, 1.0);\n"
+            : "    color = " + e->getApplyFunction() + "(color, fragCoord);\n";
+    }
+}
+
+// ============================================================================
+std::string PostProcessChain::assembleComputeSource(
+    const std::vector<std::shared_ptr<INoiseEffect>>& effects,
+    GLint outputFormat) const
+{
+    // The effects run back to back inside one invocation, so the signal
+    // and every stage's RNG state stay in registers; nothing round-trips
+    // through memory between stages.
+    std::string effectBodies;
+    std::string mainBody;
+    assembleEffectCalls(effects, true, effectBodies, mainBody);
+
+    const std::string tile = std::to_string(kComputeTile);
+    const bool cfa = m_cfaPattern != CfaPattern::None;
+    return std::string("#version 430 core\n")
+         + shaderDefines()
+         + "\n"
+         + "layout(local_size_x = " + tile + ", local_size_y = " + tile + ") in;\n"
+         + "\n"
+         + "uniform sampler2D u_inputTexture;\n"
+         + kFrameBlock
+         + "layout(binding = 0, " + imageFormatQualifier(outputFormat) + ") "
+           "uniform writeonly image2D u_outputImage;\n"
+         + "#define v_texCoord ((vec2(gl_GlobalInvocationID.xy) + 0.5) / vec2(imageSize(u_outputImage)))\n"
+         + "uniform bool      u_effectEnabled[" + std::to_string(effects.size()) + "];\n"
+         + (cfa ? kCfaDecl : std::string())
+         + "\n"
+         + m_utilsSource + "\n"
+         + effectBodies
+         + "void main()\n"
+           "{\n"
+           "    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);\n"
+           "    if (any(greaterThanEqual(pixel, imageSize(u_outputImage))))\n"
+           "        return;\n"
+           "    vec2 fragCoord = vec2(pixel) + 0.5 + u_tileOffset;\n"
+           "    vec3 color = texture(u_inputTexture, v_texCoord).rgb;\n"
+         + (cfa ? kCfaMosaic : std::string())
+         + mainBody
+         + (cfa ? "    imageStore(u_outputImage, pixel, vec4(color.rrr, 1.0));\n"
+                : "    imageStore(u_outputImage, pixel, vec4(color, 1.0));\n")
+         + "}\n";
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Program> PostProcessChain::createProgram(
+    const std::string& name, const std::string& fragSource, bool* created) const
+{
+    ProgramCache::Stages stages = {
+        { osg::Shader::VERTEX,   m_vertexSource },
+        { osg::Shader::FRAGMENT, fragSource     } };
+
+    if (m_builtLayers > 1)
+    {
+        std::string versionLine, body;
+        splitVersionLine(m_layeredGeometrySource, versionLine, body);
+        const std::string layers = std::to_string(m_builtLayers);
+        stages.push_back({ osg::Shader::GEOMETRY,
+            versionLine
+            + "#define CHAIN_LAYERS " + layers + "\n"
+            + "#define CHAIN_MAX_VERTICES " + std::to_string(3 * m_builtLayers) + "\n"
+            + body });
+    }
+
+    // Identical sources in any chain share one program (compiled once)
+    auto bindAttributes = [](osg::Program* program) {
+        program->addBindAttribLocation("osg_Vertex", 0);
+        program->addBindAttribLocation("osg_MultiTexCoord0", 1);
+        program->addBindUniformBlock("NoiseChainBlock", FRAME_BLOCK_BINDING);
+    };
+    return created
+        ? ProgramCache::instance().getForCompile(name, stages, bindAttributes, *created)
+        : ProgramCache::instance().get(name, stages, bindAttributes);
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Program> PostProcessChain::createPassProgram(const Pass& pass,
+                                                               bool* created) const
+{
+    std::string programName;
+    for (auto& e : pass.effects)
+        programName += (programName.empty() ? "" : "+") + e->getName();
+
+    if (pass.compute)
+    {
+        ProgramCache::Stages stages = { { osg::Shader::COMPUTE,
+            assembleComputeSource(pass.effects, pass.outputTexture->getInternalFormat()) } };
+        programName += " (compute)";
+        auto bindBlock = [](osg::Program* program) {
+            program->addBindUniformBlock("NoiseChainBlock", FRAME_BLOCK_BINDING);
+        };
+        return created
+            ? ProgramCache::instance().getForCompile(programName, stages, bindBlock, *created)
+            : ProgramCache::instance().get(programName, stages, bindBlock);
+    }
+
+    return createProgram(programName,
+                         assembleFragmentSource(pass.effects, pass.effects.size() > 1),
+                         created);
+}
+
+// ============================================================================
+void PostProcessChain::swapProgram(unsigned int index, osg::ref_ptr<osg::Program> program)
+{
+    if (index == m_passes.size())
+    {
+        m_passthroughProgram = program;
+        m_pendingPassthrough = nullptr;
+    }
+    else
+    {
+        Pass& pass = m_passes[index];
+        pass.program = program;
+        pass.pendingProgram = nullptr;
+    }
+
+    // Same rule as updateBypass(): a final pass with everything off
+    // presents through the passthrough program.
+    for (auto& pass : m_passes)
+    {
+        const bool anyOn = std::find(pass.enabled.begin(), pass.enabled.end(), true)
+                           != pass.enabled.end();
+        osg::Program* active = (pass.isFinal && !pass.compute && !anyOn)
+            ? m_passthroughProgram.get() : pass.program.get();
+        pass.stateSet->setAttributeAndModes(active, osg::StateAttribute::ON);
+    }
+}
+
+// ============================================================================
+void PostProcessChain::updateSpecialization()
+{
+    for (unsigned int i = 0; i < m_passes.size(); ++i)
+    {
+        Pass& pass = m_passes[i];
+        std::string features = passFeatures(pass.effects);
+        if (features == pass.features)
+            continue;
+
+        // Permutations seen before come straight from the program cache;
+        // new ones compile on their first draw.
+        pass.features = std::move(features);
+        osg::ref_ptr<osg::Program> program = createPassProgram(pass);
+        if (program != pass.program)
+            swapProgram(i, program);
+    }
+}
+
+// ============================================================================
+void PostProcessChain::updateHotReload()
+{
+    if (!m_hotReload.valid())
+        return;
+
+    const std::vector<std::string> changed = m_hotReload->pollChanges();
+    if (!changed.empty())
+    {
+        for (auto& path : changed)
+        {
+            std::cout << "[PostProcessChain] Reloading " << path << "\n";
+            ProgramCache::instance().invalidateSource(path);
+        }
+        loadCommonSources();
+        if (m_builtLayers > 1)
+            m_layeredGeometrySource = readFile(m_shaderDir + "/layered_quad.geom");
+
+        // Unchanged sources hash to the running program; only passes whose
+        // assembled source changed get a new one.  Programs that already
+        // exist (another chain, or an edit undone) are linked or will be
+        // by the normal draw, so they are swapped straight away.
+        auto request = [this](unsigned int index, osg::ref_ptr<osg::Program> current,
+                              osg::ref_ptr<osg::Program> program, bool created,
+                              osg::ref_ptr<osg::Program>& pending) {
+            if (program == current)
+            {
+                pending = nullptr;
+                return;
+            }
+            pending = program;
+            if (created)
+                m_hotReload->compile(program, index);
+            else
+                swapProgram(index, program);
+        };
+
+        for (unsigned int i = 0; i < m_passes.size(); ++i)
+        {
+            bool created = false;
+            osg::ref_ptr<osg::Program> program = createPassProgram(m_passes[i], &created);
+            request(i, m_passes[i].program, program, created, m_passes[i].pendingProgram);
+        }
+        bool created = false;
+        osg::ref_ptr<osg::Program> passthrough =
+            createProgram("Passthrough", assembleFragmentSource({}, false), &created);
+        request(static_cast<unsigned int>(m_passes.size()), m_passthroughProgram,
+                passthrough, created, m_pendingPassthrough);
+    }
+
+    // ── Swap in what finished compiling (frame boundary) ────────────────
+    for (auto& result : m_hotReload->takeResults())
+    {
+        const bool isPassthrough = result.tag == m_passes.size();
+        if (!isPassthrough && result.tag > m_passes.size())
+            continue;
+        osg::ref_ptr<osg::Program>& pending = isPassthrough
+            ? m_pendingPassthrough : m_passes[result.tag].pendingProgram;
+        if (result.program != pending)
+            continue;   // superseded by a newer edit
+
+        if (!result.linked)
+        {
+            std::cerr << "[PostProcessChain] WARNING: " << result.program->getName()
+                      << " failed to compile or link; keeping the running program.\n";
+            pending = nullptr;
+            continue;
+        }
+        std::cout << "[PostProcessChain] Swapped in " << result.program->getName() << "\n";
+        swapProgram(result.tag, result.program);
+    }
+}
+
 // ============================================================================
 osg::ref_ptr<osg::Geometry> PostProcessChain::createFullscreenQuad()
 {
@@ -239,6 +1512,8 @@ osg::ref_ptr<osg::Geometry> PostProcessChain::createFullscreenQuad()
     (*normals)[0].set(0.0f, 0.0f, 1.0f);
     geom->setNormalArray(normals, osg::Array::BIND_OVERALL);
 
-    geom->addPrimitiveSet(new osg::DrawArrays(GL_QUADS, 0, 4));
+    // A fan rather than GL_QUADS: geometry shaders (layered mode) only
+    // accept points, lines and triangles.
+    geom->addPrimitiveSet(new osg::DrawArrays(GL_TRIANGLE_FAN, 0, 4));
     return geom;
 }
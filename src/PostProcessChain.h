@@ -5,19 +5,79 @@
 //  Chains multiple INoiseEffect passes together. Each effect gets its own
 //  RTT camera and fullscreen quad.  The output texture of pass N becomes
 //  the input texture of pass N+1.  The final pass renders to screen.
+//  Intermediate outputs ping-pong between two textures from a
+//  RenderTargetPool.
+//
+//  In Fused mode the effects are concatenated into one generated fragment
+//  shader instead (one texture fetch, one full-screen write).
+//
+//  Every effect gets its pass (or fused slot) at build time, enabled or
+//  not.  INoiseEffect::setEnabled() is picked up on the next update
+//  traversal: disabled passes are node-masked off and the next pass is
+//  rewired to the previous output, so toggling never recompiles a shader
+//  or reallocates a texture.
+//
+//  Layered mode (setLayerCount(K), offscreen + fused) renders the clean
+//  scene once and runs the fused pass over a K-layer Texture2DArray: a
+//  geometry shader fans the quad out to every layer and each layer sees
+//  u_frameNumber * K + layer, so one draw yields K independent noise
+//  realisations of the same scene.
+//
+//  The Compute backend runs the fused effect list as one GL 4.3 compute
+//  dispatch over 16x16 tiles (texture fetch in, imageStore out) instead of a
+//  rasterised quad; on screen a passthrough pass presents the result.
+//
+//  Values every pass shares (resolution, frame number, exposure, time)
+//  live in one std140 uniform block per chain, NoiseChainBlock, written
+//  once per frame by the chain's update callback; effects only keep
+//  their own parameters as uniforms.
+//
+//  A temporal stage (INoiseEffect::isTemporal, e.g. AccumulationEffect)
+//  gets a dedicated float output plus a history pair, alternated by two
+//  extra cameras sharing its quad; the passes after it read the finished
+//  exposure and run only on its last sub-frame (on screen, the final pass
+//  keeps presenting the last exposure in between).
+//
+//  CFA mode samples the scene through a colour filter array: the first
+//  generated pass keeps one colour per photosite, every later stage
+//  carries that single value in single-channel targets and draws one
+//  random sample per pixel instead of three, and the offscreen output is
+//  a one-channel raw frame.  An optional demosaic pass restores RGB.
+//
+//  resize() follows the window without a rebuild: owned targets are
+//  resized in place, intermediates are re-acquired from the pool at the
+//  new size, and the frame block and effect maps pick up the new
+//  resolution; no program is recompiled.  Dynamic resolution drives the
+//  same path from the measured frame time, rendering the chain below the
+//  window size (the on-screen pass upsamples) when frames run long.
+//
+//  With hot reload on, the shader directory is polled during the update
+//  traversal; passes whose assembled sources changed get a new program,
+//  compiled off the render thread and swapped in once it links.
 // ============================================================================
 
 #include "PostProcessing.h"
 #include "INoiseEffect.h"
+#include "RenderTargetPool.h"
+#include "PoissonTable.h"
+#include "GpuTimer.h"
+#include "ShaderHotReload.h"
 
 #include <osg/Group>
+#include <osg/BufferIndexBinding>
+#include <osg/BufferObject>
+#include <osg/BufferTemplate>
 #include <osg/Camera>
+#include <osg/DispatchCompute>
 #include <osg/Texture2D>
+#include <osg/Texture2DArray>
 #include <osg/Geode>
 #include <osg/Geometry>
 #include <osg/Program>
 #include <osg/Shader>
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <string>
@@ -25,18 +85,296 @@
 class PostProcessChain
 {
 public:
+    enum class BuildMode
+    {
+        MultiPass,  ///< one RTT pass per effect
+        Fused       ///< all enabled effects in a single generated pass
+    };
+
+    enum class Backend
+    {
+        Raster,   ///< fullscreen-quad fragment passes (GL 3.3)
+        Compute   ///< one fused compute dispatch (GL 4.3)
+    };
+
+    /// Storage for the scene texture and every intermediate.  The float
+    /// formats carry the linear, unclipped signal from effect to effect;
+    /// clipping and quantisation are left to the last stage (AdcEffect).
+    enum class SignalFormat
+    {
+        UNorm8,      ///< GL_RGBA8, clamped to [0,1] after every effect
+        Float16,     ///< GL_RGBA16F (default)
+        Float32,     ///< GL_RGBA32F
+        R11G11B10F   ///< packed unsigned float, half the bandwidth of RGBA16F
+    };
+
+    /// Small-lambda Poisson sampler used by noise_utils.glsl
+    /// (POISSON_QUALITY).  Trades exactness for bounded per-pixel cost.
+    enum class PoissonQuality
+    {
+        Fast  = 0,  ///< Gaussian approximation everywhere
+        Table = 1,  ///< inverse-CDF lookup texture, constant cost
+        Exact = 2   ///< Knuth loop (up to 200 iterations, divergent)
+    };
+
+    /// Colour filter array of the simulated sensor, named by the colours
+    /// of the top-left 2x2 photosites of the output frame.
+    enum class CfaPattern
+    {
+        None = 0,   ///< full RGB per pixel (default)
+        RGGB,
+        BGGR,
+        GRBG,
+        GBRG
+    };
+
     PostProcessChain(unsigned int width, unsigned int height,
                      const std::string& shaderDir = "shaders");
 
     /// Add an effect to the end of the chain.
     void addEffect(std::shared_ptr<INoiseEffect> effect);
 
+    /// The effects in chain order.
+    const std::vector<std::shared_ptr<INoiseEffect>>& getEffects() const { return m_effects; }
+
+    /// Insert an effect before position `index` (clamped to the end).
+    /// Call before build().
+    void insertEffect(std::size_t index, std::shared_ptr<INoiseEffect> effect);
+
     /// Build the complete scene graph.
     /// Call this AFTER adding all effects.
     /// @param scene  The 3D scene to render
     /// @return Root group to set as the viewer's scene data
     osg::ref_ptr<osg::Group> build(osg::ref_ptr<osg::Node> scene);
 
+    /// Build the passes only, reading an already rendered `input` (e.g.
+    /// one scene render shared by several chains, see SensorRig).  The
+    /// input may differ in size from the chain; it is sampled bilinearly.
+    /// The caller keeps `input` rendered before the chain's passes
+    /// (PRE_RENDER order 0).
+    osg::ref_ptr<osg::Group> buildFromTexture(osg::ref_ptr<osg::Texture2D> input);
+
+    /// PRE_RENDER camera drawing `scene` into `target` at its size; the
+    /// scene camera build() uses.
+    static osg::ref_ptr<osg::Camera> createSceneCamera(osg::ref_ptr<osg::Node> scene,
+                                                       osg::Texture2D* target);
+
+    /// Uniform buffer binding point of NoiseChainBlock.
+    static const GLuint FRAME_BLOCK_BINDING = 0;
+
+    /// Relative exposure (integration time, 1 = nominal): scales the
+    /// collected photon signal and the accumulated dark signal.  Cheap to
+    /// change at any time.
+    void  setExposure(float exposure);
+    float getExposure() const { return m_exposure; }
+
+    /// 64-bit noise seed (u_seed).  Together with the frame number and an
+    /// effect's stream ID it fixes every temporal draw, so a frame can be
+    /// reproduced exactly.  Seeds that differ only in their low or only in
+    /// their high 32 bits (e.g. node index or node index << 32) give
+    /// disjoint noise at every frame; other pairs fold to the same 32-bit
+    /// stream word with probability 2^-32.  Fixed-pattern maps do not
+    /// depend on it.  Cheap to change at any time.
+    void          setSeed(std::uint64_t seed);
+    std::uint64_t getSeed() const { return m_seed; }
+
+    /// Render the chain's getWidth() x getHeight() frame as the window at
+    /// (x, y) (bottom-left, GL rows) of a larger sensorWidth x
+    /// sensorHeight sensor: fragCoord, the RNG streams, the fixed-pattern
+    /// maps and the CFA phase all follow the sensor coordinates
+    /// (u_tileOffset, u_sensorSize), so tiles rendered one after another
+    /// join without seams.  The window must lie inside the sensor, and the
+    /// sensor must not exceed 65536 pixels a side (the RNG counters hold
+    /// 16-bit coordinates).  sensorWidth / sensorHeight 0 (the default) =
+    /// the whole frame is the sensor.  Re-bakes synthetic maps and cuts
+    /// measured ones when it changes.  The scene itself is not offset:
+    /// the projection of the camera above the chain has to match.
+    void setRegion(unsigned int x, unsigned int y,
+                   unsigned int sensorWidth, unsigned int sensorHeight);
+    unsigned int getRegionX() const { return m_regionX; }
+    unsigned int getRegionY() const { return m_regionY; }
+    unsigned int getSensorWidth()  const { return m_sensorWidth  ? m_sensorWidth  : m_width;  }
+    unsigned int getSensorHeight() const { return m_sensorHeight ? m_sensorHeight : m_height; }
+    bool         hasRegion() const { return m_sensorWidth && m_sensorHeight; }
+
+    /// u_frameNumber of the next frame (0 after build()).  Tiles of one
+    /// output frame must draw with the same number to continue each
+    /// other's temporal noise.
+    void setFrameNumber(std::int32_t next) { m_frameCount = next; }
+
+    /// Advance the frame number and time in NoiseChainBlock.  Called
+    /// automatically every update traversal.
+    void updateFrame(const osg::FrameStamp* frameStamp);
+
+    /// Re-read INoiseEffect::isEnabled() and rewire the built passes.
+    /// Called automatically every update traversal; cheap when nothing
+    /// changed.
+    void updateBypass();
+
+    /// Change the chain size (the window size on screen).  Before build()
+    /// this only records it; afterwards the scene and output targets are
+    /// resized in place and intermediates re-acquired, without touching
+    /// programs.  With dynamic resolution the chain renders at
+    /// getRenderScale() of this size.  An offscreen target changes size
+    /// too, so readback set up for the old size must be recreated.
+    void resize(unsigned int width, unsigned int height);
+
+    /// Scale the internal render size (down to `minScale` of the resize()
+    /// size, in 1/16 steps) so the frame time stays near `targetFrameMs`.
+    /// Measured from frame to frame, so a vsync'd window cannot show
+    /// headroom below its refresh interval.  On-screen output only.
+    void setDynamicResolution(bool on, double targetFrameMs = 16.6, float minScale = 0.5f);
+    bool getDynamicResolution() const { return m_dynamicResolution; }
+
+    /// Fraction of the resize() size currently rendered (1 unless
+    /// dynamic resolution lowered it).
+    float getRenderScale() const { return m_renderScale; }
+
+    /// Render the scene at `scale` (1/16 .. 1) of the chain size; the
+    /// first pass upsamples it bilinearly (the scene target is LINEAR).
+    /// The noise still runs per chain pixel, so only the clean render gets
+    /// coarser, which noise-dominated low-light frames hardly show, and
+    /// the scene's raster cost falls with the square of the scale.
+    /// build() chains only; cheap to change at any time.
+    void  setSceneScale(float scale);
+    float getSceneScale() const { return m_sceneScale; }
+
+    /// Dynamic resolution step.  Called automatically every update
+    /// traversal.
+    void updateDynamicResolution(const osg::FrameStamp* frameStamp);
+
+    /// Temporal step: advance the temporal stage's sub-frame and switch
+    /// the passes after it on for the last one.  Called automatically
+    /// every update traversal.
+    void updateTemporal();
+
+    /// Start a new exposure with the next frame (e.g. on a scene change).
+    void restartExposure() { m_subFrame = 0; }
+
+    /// Frames rendered per output frame: the temporal stage's sub-frame
+    /// count while it is enabled, else 1.  The output is complete on
+    /// sub-frame getSubFramesPerOutput() - 1 after restartExposure().
+    unsigned int getSubFramesPerOutput() const;
+
+    /// Select multi-pass or fused construction (takes effect on build()).
+    /// Fused mode falls back to multi-pass if an effect has no apply function.
+    void      setBuildMode(BuildMode mode) { m_buildMode = mode; }
+    BuildMode getBuildMode() const         { return m_buildMode; }
+
+    /// Raster or compute passes (takes effect on build()).  Compute needs
+    /// fused-capable effects and falls back to raster otherwise, and in
+    /// layered mode.
+    void    setBackend(Backend b) { m_backend = b; }
+    Backend getBackend() const    { return m_backend; }
+
+    /// Select the signal storage format (takes effect on build()).
+    void         setSignalFormat(SignalFormat f) { m_signalFormat = f; }
+    SignalFormat getSignalFormat() const         { return m_signalFormat; }
+
+    /// GL internal format for the current signal format.
+    GLint getSignalInternalFormat() const;
+
+    /// Sample one colour per photosite (takes effect on build()).  The
+    /// offscreen output then is a single-channel raw frame (GL_R16, or
+    /// GL_R8 for UNorm8) unless demosaicing is on.
+    void       setCfaPattern(CfaPattern p) { m_cfaPattern = p; }
+    CfaPattern getCfaPattern() const       { return m_cfaPattern; }
+
+    /// In CFA mode, end the chain with a bilinear demosaic pass so the
+    /// output is RGB again (takes effect on build(); not in layered mode).
+    void setDemosaicEnabled(bool on) { m_demosaicEnabled = on; }
+    bool getDemosaicEnabled() const  { return m_demosaicEnabled; }
+
+    /// Pixel format to read the offscreen output back with: GL_RED for
+    /// a CFA raw frame, GL_RGBA otherwise.  Valid after build().
+    GLenum getOutputPixelFormat() const
+    {
+        return rawOutput() ? GL_RED : GL_RGBA;
+    }
+
+    /// Pixel type to read the offscreen output back with: GL_UNSIGNED_BYTE
+    /// for UNorm8, GL_UNSIGNED_SHORT otherwise (the output target is
+    /// RGBA16 so ADC codes above 8 bits survive).
+    GLenum getOutputDataType() const
+    {
+        return m_signalFormat == SignalFormat::UNorm8 ? GL_UNSIGNED_BYTE : GL_UNSIGNED_SHORT;
+    }
+
+    /// Select the Poisson sampler compiled into every pass (takes effect
+    /// on build()).
+    void           setPoissonQuality(PoissonQuality q) { m_poissonQuality = q; }
+    PoissonQuality getPoissonQuality() const           { return m_poissonQuality; }
+
+    /// Wrap every pass in GPU timer queries (takes effect on build()).
+    /// Timings are reported per pass under the effect name(s).
+    void setGpuTimingEnabled(bool on) { m_gpuTiming = on; }
+    bool getGpuTimingEnabled() const  { return m_gpuTiming; }
+
+    /// The pass timer (nullptr unless timing was enabled at build()).
+    GpuTimer* getGpuTimer() const { return m_gpuTimer.get(); }
+
+    /// Rolling min / avg / p99 per pass; empty unless timing is enabled.
+    std::vector<GpuTimer::Timing> getPassTimings() const
+    {
+        return m_gpuTimer.valid() ? m_gpuTimer->getTimings()
+                                  : std::vector<GpuTimer::Timing>();
+    }
+
+    /// Watch the shader directory and rebuild changed programs while
+    /// running (takes effect on build()).  Sources must come from disk
+    /// (ProgramCache::setReadFromDisk); a program that fails to link is
+    /// reported and the running one kept.
+    void setHotReloadEnabled(bool on) { m_hotReloadEnabled = on; }
+    bool getHotReloadEnabled() const  { return m_hotReloadEnabled; }
+
+    /// Hot reload step: pick up changed files and swap in programs that
+    /// finished linking.  Called automatically every update traversal.
+    void updateHotReload();
+
+    /// Swap in the shader permutation of passes whose effects changed
+    /// their INoiseEffect::getFeatureKeys().  Called automatically every
+    /// update traversal; cheap when nothing changed.
+    void updateSpecialization();
+
+    /// Render the final pass into getOutputTexture() instead of the screen
+    /// (headless / batch use).  Call before build().
+    void setOffscreenOutput(bool on) { m_offscreenOutput = on; }
+    bool getOffscreenOutput() const  { return m_offscreenOutput; }
+
+    /// Number of noise realisations per scene render (1 = off, max
+    /// MAX_LAYERS).  Needs offscreen output and forces fused mode; call
+    /// before build().
+    static const unsigned int MAX_LAYERS = 32;
+    void         setLayerCount(unsigned int k) { m_layerCount = k; }
+    unsigned int getLayerCount() const         { return m_layerCount; }
+
+    /// The camera of the last pass and, in offscreen mode, its target
+    /// (a Texture2D, or a Texture2DArray in layered mode).
+    /// Valid after build(); attach readback callbacks to the camera.
+    osg::Camera*         getOutputCamera() const       { return m_passes.empty() ? nullptr : m_passes.back().camera.get(); }
+    osg::Texture2D*      getOutputTexture() const      { return m_outputTexture.get(); }
+    osg::Texture2DArray* getOutputTextureArray() const { return m_outputArray.get(); }
+
+    /// Layers actually built (1 unless layered mode could be honoured).
+    unsigned int getBuiltLayerCount() const { return m_builtLayers; }
+
+    /// Share a render-target pool with other chains (see RenderTargetPool
+    /// for the constraints).  Call before build(); by default each chain
+    /// creates its own.
+    void setRenderTargetPool(std::shared_ptr<RenderTargetPool> pool) { m_pool = std::move(pool); }
+    std::shared_ptr<RenderTargetPool> getRenderTargetPool() const      { return m_pool; }
+
+    /// Passes render at PRE_RENDER orders base + 1 .. base + getNumPasses()
+    /// (an on-screen final pass is POST_RENDER).  Chains in one viewer
+    /// given bases that do not overlap run one after the other, so
+    /// offscreen chains can share a pool there.  Call before build().
+    void setRenderOrderBase(int base) { m_renderOrderBase = base; }
+    int  getRenderOrderBase() const   { return m_renderOrderBase; }
+
+    /// Built passes (0 before build()).
+    unsigned int getNumPasses() const { return static_cast<unsigned int>(m_passes.size()); }
+
+    /// Current internal render size.
     unsigned int getWidth()  const { return m_width;  }
     unsigned int getHeight() const { return m_height; }
 
@@ -44,27 +382,182 @@ private:
     /// Load noise_utils.glsl and the fullscreen quad vertex shader source.
     void loadCommonSources();
 
+    /// Shared tail of build() / buildFromTexture(): add the passes reading
+    /// `sceneTexture` to `root`.  `entryCamera` draws first and gets the
+    /// chain's draw hooks (nullptr: the first pass camera).
+    void buildPasses(osg::Group* root, osg::ref_ptr<osg::Texture2D> sceneTexture,
+                     osg::Camera* entryCamera);
+
+    /// Storage of the intermediates: the signal format, single-channel in
+    /// CFA mode.
+    GLint getIntermediateFormat() const;
+
+    /// CFA mode without a demosaic pass: the output holds one value per
+    /// pixel.  Final once buildPasses() has decided on demosaicing.
+    bool rawOutput() const
+    {
+        return m_cfaPattern != CfaPattern::None && !m_demosaic;
+    }
+
+    /// #defines every generated shader starts with.
+    std::string shaderDefines() const;
+
+    /// Reallocate the built graph for a new internal size.
+    void applyRenderSize(unsigned int width, unsigned int height);
+
+    /// Write the region to NoiseChainBlock and hand it to the effects.
+    void applyRegion();
+
+    /// Scene target size for a chain dimension (getSceneScale()).
+    unsigned int sceneDimension(unsigned int size) const;
+
+    /// Resize the build() scene target and camera to the scene scale.
+    void applySceneSize();
+
     /// Build a single pass (RTT camera + fullscreen quad + shader).
+    /// A multi-pass stage holds one effect, a fused stage holds several.
     struct Pass
     {
         osg::ref_ptr<osg::Camera>    camera;
         osg::ref_ptr<osg::Texture2D> outputTexture;
         osg::ref_ptr<osg::Geometry>  quadGeom;
-        std::shared_ptr<INoiseEffect> effect;
+        osg::ref_ptr<osg::Program>   program;
+        osg::ref_ptr<osg::Program>   pendingProgram;  ///< hot reload: compiling
+        osg::ref_ptr<osg::Uniform>   enabledUniform;  ///< fused: bool[N]
+        osg::ref_ptr<osg::Uniform>   rawInputUniform; ///< CFA: input already mosaiced
+        std::vector<std::shared_ptr<INoiseEffect>> effects;
+        osg::ref_ptr<osg::StateSet>  stateSet;        ///< quad or dispatch state
+        osg::ref_ptr<osg::DispatchCompute> dispatch;  ///< compute only
+        std::vector<bool>            enabled;         ///< last applied state
+        std::string                  features;        ///< feature defines of `program`
+        bool                         isFinal = false;
+        bool                         compute = false; ///< dispatch, fixed output
+        bool                         temporal = false; ///< fixed output, camera = last sub-frame
+        osg::ref_ptr<osg::Camera>    historyCameras[2];  ///< temporal: other sub-frames
+        osg::ref_ptr<osg::Texture2D> historyTextures[2];
     };
 
     Pass createPass(osg::ref_ptr<osg::Texture2D> inputTexture,
-                    std::shared_ptr<INoiseEffect> effect,
+                    osg::ref_ptr<osg::Texture2D> outputTexture,
+                    const std::vector<std::shared_ptr<INoiseEffect>>& effects,
                     bool isFinalPass);
 
+    /// Build the pass of a temporal stage reading `inputTexture`: its own
+    /// float output and history pair, and the history cameras.
+    Pass createTemporalPass(osg::ref_ptr<osg::Texture2D> inputTexture,
+                            std::shared_ptr<INoiseEffect> effect);
+
+    /// Build the compute dispatch pass writing `outputTexture`.
+    Pass createComputePass(osg::ref_ptr<osg::Texture2D> inputTexture,
+                           osg::ref_ptr<osg::Texture2D> outputTexture,
+                           const std::vector<std::shared_ptr<INoiseEffect>>& effects,
+                           bool isFinalPass);
+
+    /// Ping-pong intermediate target (slot 0 or 1) from the pool.
+    osg::ref_ptr<osg::Texture2D> acquireIntermediate(unsigned int slot);
+
+    /// Assemble the complete fragment shader for one pass.  With gated
+    /// set, each apply call is guarded by u_effectEnabled[i].
+    std::string assembleFragmentSource(
+        const std::vector<std::shared_ptr<INoiseEffect>>& effects,
+        bool gated) const;
+
+    /// Compute-shader counterpart of assembleFragmentSource(); the output
+    /// image is declared with the qualifier for `outputFormat`.
+    std::string assembleComputeSource(
+        const std::vector<std::shared_ptr<INoiseEffect>>& effects,
+        GLint outputFormat) const;
+
+    /// Effect bodies plus the main() statements that chain their apply
+    /// functions; shared by the fragment and compute assemblers.
+    void assembleEffectCalls(const std::vector<std::shared_ptr<INoiseEffect>>& effects,
+                             bool gated, std::string& effectBodies,
+                             std::string& mainBody) const;
+
+    /// Program for a raster pass.  With `created` set the program is
+    /// looked up for hot reload (compiled by the caller).
+    osg::ref_ptr<osg::Program> createProgram(const std::string& name,
+                                             const std::string& fragSource,
+                                             bool* created = nullptr) const;
+
+    /// The program `pass` needs for the current sources and settings.
+    osg::ref_ptr<osg::Program> createPassProgram(const Pass& pass,
+                                                 bool* created = nullptr) const;
+
+    /// Install `program` on pass `index` (m_passes.size() = passthrough).
+    void swapProgram(unsigned int index, osg::ref_ptr<osg::Program> program);
+
     osg::ref_ptr<osg::Geometry> createFullscreenQuad();
 
-    unsigned int m_width;
+    /// CPU mirror of NoiseChainBlock (std140).
+    struct FrameBlock
+    {
+        float         resolution[2];
+        std::int32_t  frameNumber;
+        float         exposure;
+        float         time;
+        std::uint32_t pad;
+        std::uint32_t seed[2];   ///< u_seed: low word, high word
+        float         tileOffset[2];
+        float         sensorSize[2];
+    };
+
+    unsigned int m_width;           ///< internal render size
     unsigned int m_height;
+    unsigned int m_baseWidth;       ///< size requested by resize()
+    unsigned int m_baseHeight;
     std::string  m_shaderDir;
+    BuildMode    m_buildMode = BuildMode::MultiPass;
+    bool         m_offscreenOutput = false;
+    PoissonQuality m_poissonQuality = PoissonQuality::Table;
+    SignalFormat m_signalFormat = SignalFormat::Float16;
+    Backend      m_backend = Backend::Raster;
+    bool         m_gpuTiming = false;
+    bool         m_hotReloadEnabled = false;
+    CfaPattern   m_cfaPattern = CfaPattern::None;
+    bool         m_demosaicEnabled = false;
+
+    bool         m_dynamicResolution = false;
+    double       m_targetFrameMs = 16.6;
+    float        m_minScale = 0.5f;
+    float        m_renderScale = 1.0f;
+    float        m_sceneScale = 1.0f;
+    double       m_lastFrameTime = -1.0;
+    double       m_avgFrameMs = 0.0;
+    unsigned int m_framesSinceScale = 0;
 
     std::string  m_vertexSource;
     std::string  m_utilsSource;
+    std::string  m_layeredGeometrySource;
+
+    unsigned int m_layerCount  = 1;
+    unsigned int m_builtLayers = 1;
 
     std::vector<std::shared_ptr<INoiseEffect>> m_effects;
+    std::shared_ptr<INoiseEffect>              m_demosaic;   ///< CFA + demosaic only
+
+    // ── Built graph (valid after build()) ───────────────────────────────
+    std::vector<Pass>            m_passes;
+    osg::ref_ptr<osg::Texture2D> m_sceneTexture;
+    osg::ref_ptr<osg::Camera>    m_sceneCamera;    ///< build() only; owns m_sceneTexture
+    bool                         m_targetsChanged = false;  ///< rewire on next updateBypass()
+    int                          m_temporalPass = -1;       ///< index of the temporal stage's pass
+    unsigned int                 m_subFrame = 0;            ///< next sub-frame of the exposure
+    osg::ref_ptr<osg::Program>   m_passthroughProgram;
+    osg::ref_ptr<osg::Texture2D> m_outputTexture;
+    osg::ref_ptr<osg::Texture2DArray> m_outputArray;   ///< layered mode only
+    osg::ref_ptr<osg::Texture2D> m_poissonTable;   ///< Table quality only
+    osg::ref_ptr<GpuTimer>       m_gpuTimer;
+    osg::ref_ptr<ShaderHotReload> m_hotReload;
+    osg::ref_ptr<osg::Program>   m_pendingPassthrough;
+
+    float                        m_exposure = 1.0f;
+    std::uint64_t                m_seed = 0;
+    unsigned int                 m_regionX = 0, m_regionY = 0;
+    unsigned int                 m_sensorWidth = 0, m_sensorHeight = 0;   ///< 0 = frame size
+    std::int32_t                 m_frameCount = 0;
+    osg::ref_ptr<osg::BufferTemplate<FrameBlock>> m_frameBlock;
+    osg::ref_ptr<osg::UniformBufferBinding>       m_frameBinding;
+    std::shared_ptr<RenderTargetPool> m_pool;
+    int                               m_renderOrderBase = 0;
 };
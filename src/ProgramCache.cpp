@@ -0,0 +1,252 @@
+#include "ProgramCache.h"
+#include "EmbeddedShaders.h"
+
+#include <osg/GLExtensions>
+#include <osg/State>
+#include <osgDB/FileUtils>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// ============================================================================
+ProgramCache& ProgramCache::instance()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+// ============================================================================
+ProgramCache::ProgramCache()
+    : m_readFromDisk(EmbeddedShaders::count() == 0)
+{
+}
+
+// ============================================================================
+std::uint64_t ProgramCache::hash(const std::string& data, std::uint64_t seed)
+{
+    std::uint64_t h = seed;
+    for (unsigned char c : data)
+    {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+// ============================================================================
+std::string ProgramCache::source(const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_sources.find(path);
+        if (it != m_sources.end())
+            return it->second;
+    }
+
+    if (!m_readFromDisk)
+    {
+        if (const EmbeddedShaders::Entry* entry = EmbeddedShaders::find(path))
+            return std::string(reinterpret_cast<const char*>(entry->source), entry->length);
+    }
+
+    std::ifstream ifs(path);
+    if (!ifs.is_open())
+    {
+        std::cerr << "[ProgramCache] ERROR: Cannot open file: " << path << "\n";
+        return {};
+    }
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sources[path] = ss.str();
+}
+
+// ============================================================================
+void ProgramCache::setReadFromDisk(bool on)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_readFromDisk = on;
+    m_sources.clear();
+}
+
+// ============================================================================
+void ProgramCache::invalidateSources()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sources.clear();
+}
+
+void ProgramCache::invalidateSource(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sources.erase(path);
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Program> ProgramCache::get(const std::string& name, const Stages& stages,
+                                             const std::function<void(osg::Program*)>& configure,
+                                             const std::string& variant)
+{
+    return lookup(name, stages, configure, variant, BinaryState::Unchecked, nullptr);
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Program> ProgramCache::getForCompile(const std::string& name, const Stages& stages,
+                                                       const std::function<void(osg::Program*)>& configure,
+                                                       bool& created)
+{
+    return lookup(name, stages, configure, {}, BinaryState::Done, &created);
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Program> ProgramCache::lookup(const std::string& name, const Stages& stages,
+                                                const std::function<void(osg::Program*)>& configure,
+                                                const std::string& variant, BinaryState initialState,
+                                                bool* created)
+{
+    std::uint64_t key = hash(variant);
+    for (auto& stage : stages)
+    {
+        key = hash(std::to_string(static_cast<int>(stage.first)), key);
+        key = hash(stage.second, key);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry& entry = m_programs[key];
+    if (created)
+        *created = !entry.program;
+    if (!entry.program)
+    {
+        entry.program = new osg::Program;
+        entry.program->setName(name);
+        for (auto& stage : stages)
+            entry.program->addShader(new osg::Shader(stage.first, stage.second));
+        if (configure)
+            configure(entry.program.get());
+        entry.state = initialState;
+    }
+    return entry.program;
+}
+
+// ============================================================================
+std::size_t ProgramCache::getNumPrograms() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_programs.size();
+}
+
+// ============================================================================
+void ProgramCache::setBinaryCacheDirectory(const std::string& dir)
+{
+    if (!dir.empty() && !osgDB::makeDirectory(dir))
+    {
+        std::cerr << "[ProgramCache] ERROR: Cannot create binary cache directory: "
+                  << dir << "\n";
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_binaryDir = dir;
+}
+
+// ============================================================================
+std::string ProgramCache::binaryPath(std::uint64_t key) const
+{
+    char name[48];
+    std::snprintf(name, sizeof(name), "/%016llx-%016llx.bin",
+                  static_cast<unsigned long long>(key),
+                  static_cast<unsigned long long>(m_driverHash));
+    return m_binaryDir + name;
+}
+
+// ============================================================================
+void ProgramCache::processBinaries(osg::RenderInfo& renderInfo)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_binaryDir.empty())
+        return;
+
+    osg::State* state = renderInfo.getState();
+    const osg::GLExtensions* ext = state->get<osg::GLExtensions>();
+    if (!ext->isGetProgramBinarySupported)
+        return;
+
+    if (m_driverHash == 0)
+    {
+        auto str = [](GLenum e) {
+            const GLubyte* s = glGetString(e);
+            return s ? std::string(reinterpret_cast<const char*>(s)) : std::string();
+        };
+        m_driverHash = hash(str(GL_VENDOR) + "|" + str(GL_RENDERER) + "|" + str(GL_VERSION));
+    }
+
+    for (auto& kv : m_programs)
+    {
+        Entry& entry = kv.second;
+        switch (entry.state)
+        {
+        case BinaryState::Unchecked:
+        {
+            // Before the program's first apply: offer the saved binary
+            std::ifstream ifs(binaryPath(kv.first), std::ios::binary);
+            GLenum format = 0;
+            std::vector<unsigned char> data;
+            if (ifs.read(reinterpret_cast<char*>(&format), sizeof(format)))
+                data.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+
+            if (!data.empty())
+            {
+                osg::ref_ptr<osg::ProgramBinary> binary = new osg::ProgramBinary;
+                binary->assign(static_cast<unsigned int>(data.size()), data.data());
+                binary->setFormat(format);
+                entry.program->setProgramBinary(binary);
+                entry.state = BinaryState::Loaded;
+            }
+            else
+            {
+                entry.state = BinaryState::Compiled;
+            }
+            break;
+        }
+        case BinaryState::Loaded:
+        {
+            osg::Program::PerContextProgram* pcp = entry.program->getPCP(*state);
+            if (!pcp)
+                break;   // not applied yet
+            if (!pcp->isLinked())
+            {
+                std::cerr << "[ProgramCache] WARNING: Driver rejected cached binary for "
+                          << entry.program->getName() << "; relinking from source.\n";
+                std::remove(binaryPath(kv.first).c_str());
+                entry.program->setProgramBinary(nullptr);
+                entry.program->dirtyProgram();
+                entry.state = BinaryState::Compiled;
+                break;
+            }
+            entry.state = BinaryState::Done;
+            break;
+        }
+        case BinaryState::Compiled:
+        {
+            osg::Program::PerContextProgram* pcp = entry.program->getPCP(*state);
+            if (!pcp || !pcp->isLinked())
+                break;   // not linked yet
+
+            osg::ref_ptr<osg::ProgramBinary> binary = pcp->compileProgramBinary(*state);
+            if (binary.valid() && binary->getSize() > 0)
+            {
+                std::ofstream ofs(binaryPath(kv.first), std::ios::binary);
+                const GLenum format = binary->getFormat();
+                ofs.write(reinterpret_cast<const char*>(&format), sizeof(format));
+                ofs.write(reinterpret_cast<const char*>(binary->getData()), binary->getSize());
+            }
+            entry.state = BinaryState::Done;
+            break;
+        }
+        case BinaryState::Done:
+            break;
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#pragma once
+// ============================================================================
+//  ProgramCache — Process-wide shader source and program cache
+// ============================================================================
+//  Shader sources come from the table compiled into the binary
+//  (EmbeddedShaders) or, with setReadFromDisk(true) or for files that were
+//  not embedded, from disk once per process (source()).  Programs are
+//  shared by every chain that assembles identical shader sources: get()
+//  keys on a 64-bit FNV-1a hash of the stage types and sources, so N
+//  chains with the same effect mix compile and link once.
+//
+//  With a binary cache directory set, linked programs are saved through
+//  glGetProgramBinary and handed back to the driver on the next start
+//  (glProgramBinary), skipping GLSL compilation.  Files are named
+//  <program hash>-<driver hash>.bin, so a driver or GPU change simply
+//  misses.  A binary the driver rejects is deleted and the program
+//  relinks from source on the following frame.
+//
+//  Binary load/save needs a current context: PostProcessChain calls
+//  processBinaries() from the initial draw callback of its first camera.
+// ============================================================================
+
+#include <osg/Camera>
+#include <osg/Program>
+#include <osg/Shader>
+#include <osg/ref_ptr>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ProgramCache
+{
+public:
+    using Stages = std::vector<std::pair<osg::Shader::Type, std::string>>;
+
+    static ProgramCache& instance();
+
+    /// Contents of a shader file: the embedded copy (matched by file name)
+    /// unless reading from disk, else the file, read on first use.  Empty
+    /// (with an error) if it cannot be opened; failures are not cached.
+    std::string source(const std::string& path);
+
+    /// Dev mode: read shader files from disk even when they are embedded,
+    /// so edits take effect without rebuilding.  Default is on only for
+    /// builds without embedded shaders.
+    void setReadFromDisk(bool on);
+    bool isReadingFromDisk() const { return m_readFromDisk; }
+
+    /// Drop cached file contents (all, or one path) so the next source()
+    /// re-reads the disk.
+    void invalidateSources();
+    void invalidateSource(const std::string& path);
+
+    /// Shared program for these stages.  `configure` runs once, on a new
+    /// program, after the shaders are added (attribute bindings etc.); pass
+    /// a distinct `variant` when configure differs for the same sources.
+    osg::ref_ptr<osg::Program> get(const std::string& name, const Stages& stages,
+                                   const std::function<void(osg::Program*)>& configure = {},
+                                   const std::string& variant = {});
+
+    /// Like get(), for programs the caller compiles itself (hot reload):
+    /// `created` reports whether the program is new, and new programs are
+    /// kept out of the binary cache so only the caller touches them.
+    osg::ref_ptr<osg::Program> getForCompile(const std::string& name, const Stages& stages,
+                                             const std::function<void(osg::Program*)>& configure,
+                                             bool& created);
+
+    /// Enable the on-disk binary cache (created if missing); empty disables.
+    void setBinaryCacheDirectory(const std::string& dir);
+    const std::string& getBinaryCacheDirectory() const { return m_binaryDir; }
+
+    /// Load and save program binaries (draw thread, context current);
+    /// cheap once every program has been handled.
+    void processBinaries(osg::RenderInfo& renderInfo);
+
+    std::size_t getNumPrograms() const;
+
+    /// 64-bit FNV-1a.
+    static std::uint64_t hash(const std::string& data, std::uint64_t seed = 14695981039346656037ull);
+
+private:
+    ProgramCache();
+
+    enum class BinaryState
+    {
+        Unchecked,   ///< not looked up on disk yet
+        Loaded,      ///< binary handed to the program; verify link
+        Compiled,    ///< built from source; save once linked
+        Done
+    };
+
+    struct Entry
+    {
+        osg::ref_ptr<osg::Program> program;
+        BinaryState                state = BinaryState::Unchecked;
+    };
+
+    osg::ref_ptr<osg::Program> lookup(const std::string& name, const Stages& stages,
+                                      const std::function<void(osg::Program*)>& configure,
+                                      const std::string& variant, BinaryState initialState,
+                                      bool* created);
+
+    std::string binaryPath(std::uint64_t key) const;
+
+    mutable std::mutex                         m_mutex;
+    std::map<std::string, std::string>         m_sources;
+    std::map<std::uint64_t, Entry>             m_programs;
+    bool                                       m_readFromDisk = false;
+    std::string                                m_binaryDir;
+    std::uint64_t                              m_driverHash = 0;   ///< 0 until a context was seen
+};
@@ -4,9 +4,9 @@
 // ============================================================================
 
 #include "INoiseEffect.h"
+#include "ProgramCache.h"
+#include "CpuKernels.h"
 #include <osg/Uniform>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 
 class ReadNoiseEffect : public INoiseEffect
@@ -17,58 +17,41 @@ public:
         : m_shaderDir(shaderDir), m_readNoise(readNoise)
     {
         m_uReadNoise   = new osg::Uniform("u_readNoise", m_readNoise);
-        m_uFrameNumber = new osg::Uniform("u_frameNumber", 0);
-        m_uResolution  = new osg::Uniform("u_resolution", osg::Vec2(1280, 720));
+        createStreamUniform("u_readStream", READ_STREAM);
     }
 
     std::string getName() const override { return "ReadNoise"; }
 
     std::string getFragmentSource() const override
     {
-        std::ifstream ifs(m_shaderDir + "/read_noise.frag");
-        if (!ifs.is_open()) return {};
-        std::stringstream ss; ss << ifs.rdbuf();
-        return ss.str();
+        return ProgramCache::instance().source(m_shaderDir + "/read_noise.frag");
+    }
+
+    std::string getApplyFunction() const override { return "apply_read_noise"; }
+    std::vector<std::string> getFeatureKeys() const override
+    {
+        if (m_fastNormals) return { "READ_FAST_NORMALS" };
+        return {};
     }
 
     void setupUniforms(osg::StateSet* ss) override
     {
         ss->addUniform(m_uReadNoise);
-        ss->addUniform(m_uFrameNumber);
-        ss->addUniform(m_uResolution);
+        ss->addUniform(m_uStreamId);
     }
 
-    osg::ref_ptr<osg::NodeCallback> createUpdateCallback() override;
+    bool prepareCpu(unsigned int, unsigned int) override { return true; }
+    void processCpu(const CpuKernels::Tile& tile) const override
+    {
+        CpuKernels::readNoise(tile, m_readNoise, m_streamId, m_fastNormals);
+    }
 
     // ── Parameter access ────────────────────────────────────────────────
-    void  setReadNoise(float v) { m_readNoise = std::max(0.f, v); m_uReadNoise->set(m_readNoise); }
+    void  setReadNoise(float v) { setIfChanged(m_uReadNoise.get(), m_readNoise, std::max(0.f, v)); }
     float getReadNoise() const  { return m_readNoise; }
 
-    void setResolution(float w, float h) { m_uResolution->set(osg::Vec2(w, h)); }
-
 private:
     std::string m_shaderDir;
     float m_readNoise;
     osg::ref_ptr<osg::Uniform> m_uReadNoise;
-    osg::ref_ptr<osg::Uniform> m_uFrameNumber;
-    osg::ref_ptr<osg::Uniform> m_uResolution;
 };
-
-class ReadNoiseFrameCallback : public osg::NodeCallback
-{
-public:
-    ReadNoiseFrameCallback(osg::ref_ptr<osg::Uniform> u) : m_u(u), m_f(0) {}
-    void operator()(osg::Node* node, osg::NodeVisitor* nv) override
-    {
-        m_u->set(m_f++);
-        traverse(node, nv);
-    }
-private:
-    osg::ref_ptr<osg::Uniform> m_u;
-    int m_f;
-};
-
-inline osg::ref_ptr<osg::NodeCallback> ReadNoiseEffect::createUpdateCallback()
-{
-    return new ReadNoiseFrameCallback(m_uFrameNumber);
-}
@@ -0,0 +1,113 @@
+#include "RenderTargetPool.h"
+
+// ── Helper ──────────────────────────────────────────────────────────────────
+static std::size_t bytesPerPixel(GLint internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_RGBA16F_ARB:
+    case GL_RGBA16:       return 8;
+    case GL_RGBA32F_ARB:  return 16;
+    case GL_R8:           return 1;
+    case GL_R16F:
+    case GL_R16:          return 2;
+    case GL_R32F:         return 4;
+    default:              return 4;
+    }
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Texture2D> RenderTargetPool::acquire(const Key& key,
+                                                       unsigned int slot,
+                                                       const void* owner)
+{
+    m_owners[key].insert(owner);
+    auto& slots = m_targets[key];
+    while (slots.size() <= slot)
+        slots.push_back(createTexture(key.width, key.height, key.internalFormat));
+    return slots[slot];
+}
+
+// ============================================================================
+void RenderTargetPool::release(const Key& key, const void* owner)
+{
+    auto it = m_owners.find(key);
+    if (it != m_owners.end())
+    {
+        it->second.erase(owner);
+        if (!it->second.empty())
+            return;
+        m_owners.erase(it);
+    }
+    m_targets.erase(key);
+}
+
+// ============================================================================
+std::size_t RenderTargetPool::getNumTextures() const
+{
+    std::size_t n = 0;
+    for (auto& entry : m_targets)
+        n += entry.second.size();
+    return n;
+}
+
+// ============================================================================
+std::size_t RenderTargetPool::getApproxBytes() const
+{
+    std::size_t bytes = 0;
+    for (auto& entry : m_targets)
+    {
+        const Key& k = entry.first;
+        bytes += entry.second.size() * std::size_t(k.width) * k.height
+               * bytesPerPixel(k.internalFormat);
+    }
+    return bytes;
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Texture2D> RenderTargetPool::createTexture(unsigned int width,
+                                                             unsigned int height,
+                                                             GLint internalFormat)
+{
+    osg::ref_ptr<osg::Texture2D> tex = new osg::Texture2D;
+    tex->setTextureSize(width, height);
+    tex->setInternalFormat(internalFormat);
+
+    // Float / 16-bit targets need a matching source format for allocation
+    switch (internalFormat)
+    {
+    case GL_RGBA16F_ARB:
+    case GL_RGBA32F_ARB:
+        tex->setSourceFormat(GL_RGBA);
+        tex->setSourceType(GL_FLOAT);
+        break;
+    case GL_R11F_G11F_B10F_EXT:
+        tex->setSourceFormat(GL_RGB);
+        tex->setSourceType(GL_FLOAT);
+        break;
+    case GL_RGBA16:
+        tex->setSourceFormat(GL_RGBA);
+        tex->setSourceType(GL_UNSIGNED_SHORT);
+        break;
+    case GL_R16F:
+    case GL_R32F:
+        tex->setSourceFormat(GL_RED);
+        tex->setSourceType(GL_FLOAT);
+        break;
+    case GL_R16:
+        tex->setSourceFormat(GL_RED);
+        tex->setSourceType(GL_UNSIGNED_SHORT);
+        break;
+    case GL_R8:
+        tex->setSourceFormat(GL_RED);
+        tex->setSourceType(GL_UNSIGNED_BYTE);
+        break;
+    default:
+        break;
+    }
+    tex->setFilter(osg::Texture2D::MIN_FILTER, osg::Texture2D::LINEAR);
+    tex->setFilter(osg::Texture2D::MAG_FILTER, osg::Texture2D::LINEAR);
+    tex->setWrap(osg::Texture2D::WRAP_S, osg::Texture2D::CLAMP_TO_EDGE);
+    tex->setWrap(osg::Texture2D::WRAP_T, osg::Texture2D::CLAMP_TO_EDGE);
+    return tex;
+}
@@ -0,0 +1,72 @@
+#pragma once
+// ============================================================================
+//  RenderTargetPool — Shared ping-pong textures for PostProcessChain
+// ============================================================================
+//  Intermediate passes only ever need two live targets: the one being read
+//  and the one being written.  The pool hands out numbered slots per
+//  (width, height, internal format) key, so an N-pass chain holds two
+//  intermediates instead of N-1.
+//
+//  A pool can be shared by several chains as long as their passes do not
+//  interleave in one graphics context: offscreen chains in one viewer
+//  with disjoint render-order bases (PostProcessChain::setRenderOrderBase,
+//  as SensorRig does), chains swapped in and out of a viewer one at a
+//  time, or chains in separate views/contexts, which per-context texture
+//  objects keep apart.
+//  Each key remembers the owners that acquired it, so an owner moving to
+//  another size releases its old key without dropping textures another
+//  chain still renders into.
+// ============================================================================
+
+#include <osg/Texture2D>
+#include <osg/ref_ptr>
+
+#include <map>
+#include <set>
+#include <vector>
+#include <cstddef>
+
+class RenderTargetPool
+{
+public:
+    struct Key
+    {
+        unsigned int width;
+        unsigned int height;
+        GLint        internalFormat;
+
+        bool operator<(const Key& o) const
+        {
+            if (width  != o.width)  return width  < o.width;
+            if (height != o.height) return height < o.height;
+            return internalFormat < o.internalFormat;
+        }
+    };
+
+    /// Return texture number `slot` for the given key, creating it on first
+    /// use, and record `owner` as a user of the key.  The chain uses slots
+    /// 0 and 1 as its ping-pong pair.
+    osg::ref_ptr<osg::Texture2D> acquire(const Key& key, unsigned int slot,
+                                         const void* owner = nullptr);
+
+    /// `owner` no longer uses `key` (e.g. the old size after a resize); the
+    /// key's textures are dropped once no owner is left.
+    void release(const Key& key, const void* owner = nullptr);
+
+    /// Drop every texture (e.g. before switching to a new resolution).
+    void clear() { m_targets.clear(); m_owners.clear(); }
+
+    /// Number of textures currently held, and their approximate size.
+    std::size_t getNumTextures() const;
+    std::size_t getApproxBytes() const;
+
+    /// Create a render-target texture with the chain's standard sampling
+    /// state (linear filtering, clamp to edge).
+    static osg::ref_ptr<osg::Texture2D> createTexture(unsigned int width,
+                                                      unsigned int height,
+                                                      GLint internalFormat);
+
+private:
+    std::map<Key, std::vector<osg::ref_ptr<osg::Texture2D>>> m_targets;
+    std::map<Key, std::set<const void*>>                     m_owners;
+};
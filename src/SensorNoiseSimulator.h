@@ -7,8 +7,10 @@
 //    2. Dark noise  (additive dark current + DSNU + hot pixels)
 //    3. Photon noise (Poisson shot noise on total signal)
 //    4. Read noise   (additive Gaussian from readout)
+//    5. ADC          (gain, black level, N-bit quantisation)
 //
-//  Each module can be independently enabled/disabled and adjusted.
+//  Each module can be independently enabled/disabled and adjusted.  A
+//  SensorProfile sets all of it at once; its defaults are the simulator's.
 // ============================================================================
 
 #include "PostProcessChain.h"
@@ -16,8 +18,12 @@
 #include "DarkNoiseEffect.h"
 #include "PhotonNoiseEffect.h"
 #include "ReadNoiseEffect.h"
+#include "AdcEffect.h"
+#include "AccumulationEffect.h"
+#include "SensorProfile.h"
 
 #include <osgGA/GUIEventHandler>
+#include <algorithm>
 #include <memory>
 #include <iostream>
 
@@ -25,28 +31,27 @@ class SensorNoiseSimulator
 {
 public:
     SensorNoiseSimulator(unsigned int width, unsigned int height,
-                         const std::string& shaderDir = "shaders")
-        : m_chain(width, height, shaderDir)
+                         const std::string& shaderDir = "shaders",
+                         PostProcessChain::Backend backend = PostProcessChain::Backend::Raster)
+        : m_chain(width, height, shaderDir), m_shaderDir(shaderDir)
     {
-        // Create effect modules
-        m_prnu       = std::make_shared<PRNUEffect>(shaderDir);
-        m_darkNoise  = std::make_shared<DarkNoiseEffect>(shaderDir);
-        m_photonNoise = std::make_shared<PhotonNoiseEffect>(shaderDir);
-        m_readNoise  = std::make_shared<ReadNoiseEffect>(shaderDir);
-
-        // Set resolution on all effects
-        float w = static_cast<float>(width);
-        float h = static_cast<float>(height);
-        m_prnu->setResolution(w, h);
-        m_darkNoise->setResolution(w, h);
-        m_photonNoise->setResolution(w, h);
-        m_readNoise->setResolution(w, h);
+        m_chain.setBackend(backend);
+
+        // Create effect modules with the default profile's parameters
+        const SensorProfile::Parameters& p = m_profile.params;
+        m_prnu       = std::make_shared<PRNUEffect>(shaderDir, p.prnuStrength);
+        m_darkNoise  = std::make_shared<DarkNoiseEffect>(shaderDir, p.darkCurrent, p.dsnuStrength,
+                                                         p.hotPixelProbability, p.hotPixelStrength);
+        m_photonNoise = std::make_shared<PhotonNoiseEffect>(shaderDir, p.photonScale);
+        m_readNoise  = std::make_shared<ReadNoiseEffect>(shaderDir, p.readNoise);
+        m_adc        = std::make_shared<AdcEffect>(shaderDir, p.adcBits, p.adcGain, p.adcBlackLevel);
 
         // Add in physically correct order
         m_chain.addEffect(m_prnu);
         m_chain.addEffect(m_darkNoise);
         m_chain.addEffect(m_photonNoise);
         m_chain.addEffect(m_readNoise);
+        m_chain.addEffect(m_adc);
     }
 
     /// Build the scene graph with all effects applied.
@@ -55,22 +60,133 @@ public:
         return m_chain.build(scene);
     }
 
+    /// Build the effects on an existing texture (e.g. a streamed image
+    /// sequence) instead of a scene render.
+    osg::ref_ptr<osg::Group> applyToTexture(osg::ref_ptr<osg::Texture2D> input)
+    {
+        return m_chain.buildFromTexture(input);
+    }
+
+    /// Multi-pass (default) or a single fused pass.  Call before apply().
+    void setBuildMode(PostProcessChain::BuildMode mode) { m_chain.setBuildMode(mode); }
+
+    /// Signal storage between effects.  Call before apply().
+    void setSignalFormat(PostProcessChain::SignalFormat f) { m_chain.setSignalFormat(f); }
+
+    /// Poisson sampler quality for photon and dark noise.  Call before apply().
+    void setPoissonQuality(PostProcessChain::PoissonQuality q) { m_chain.setPoissonQuality(q); }
+
+    /// Relative exposure for photon and dark signal (1 = nominal).
+    void setExposure(float e) { m_chain.setExposure(e); }
+
+    /// Integrate `subFrames` renders into each output frame: inserts an
+    /// AccumulationEffect after photon noise, so read noise and the ADC
+    /// run once per exposure.  Multi-pass only; call once, before apply().
+    void enableAccumulation(unsigned int subFrames,
+                            AccumulationEffect::Window window = AccumulationEffect::Window::Box)
+    {
+        if (m_accumulation)
+        {
+            m_accumulation->setSubFrames(subFrames);
+            m_accumulation->setWindow(window);
+            return;
+        }
+        m_accumulation = std::make_shared<AccumulationEffect>(m_shaderDir, subFrames, window);
+        const auto& effects = m_chain.getEffects();
+        const auto photon = std::find(effects.begin(), effects.end(), m_photonNoise);
+        m_chain.insertEffect(static_cast<std::size_t>(photon - effects.begin()) + 1, m_accumulation);
+    }
+
+    /// Share intermediate render targets with other simulators.  Call before apply().
+    void setRenderTargetPool(std::shared_ptr<RenderTargetPool> pool) { m_chain.setRenderTargetPool(std::move(pool)); }
+
+    /// Model the sensor `profile` describes.  Its pipeline takes effect
+    /// on the next apply(), the enabled modules and parameters at once.
+    /// Without sub-frames an accumulation stage added earlier is disabled,
+    /// not removed.
+    void applyProfile(const SensorProfile& profile)
+    {
+        const SensorProfile::Pipeline& p = profile.pipeline;
+        m_chain.setBuildMode(p.mode);
+        m_chain.setBackend(p.backend);
+        m_chain.setSignalFormat(p.signal);
+        m_chain.setPoissonQuality(p.poisson);
+        m_chain.setCfaPattern(p.cfa);
+        m_chain.setDemosaicEnabled(p.demosaic);
+        if (p.subFrames > 1)
+        {
+            enableAccumulation(p.subFrames, p.window);
+            m_accumulation->setEnabled(true);
+        }
+        else if (m_accumulation)
+        {
+            m_accumulation->setEnabled(false);
+        }
+
+        m_prnu->setEnabled(profile.effects.prnu);
+        m_darkNoise->setEnabled(profile.effects.dark);
+        m_photonNoise->setEnabled(profile.effects.photon);
+        m_readNoise->setEnabled(profile.effects.read);
+        m_adc->setEnabled(profile.effects.adc);
+
+        m_profile = profile;
+        resetParameters();
+    }
+
+    /// Return every parameter to the last applied profile (the defaults
+    /// unless applyProfile() was called).
+    void resetParameters()
+    {
+        const SensorProfile::Parameters& p = m_profile.params;
+        m_chain.setExposure(p.exposure);
+        m_prnu->setPRNUStrength(p.prnuStrength);
+        m_prnu->setGainMap(p.gainMap.get());
+        m_darkNoise->setDarkCurrent(p.darkCurrent);
+        m_darkNoise->setDSNUStrength(p.dsnuStrength);
+        m_darkNoise->setHotPixelProbability(p.hotPixelProbability);
+        m_darkNoise->setHotPixelStrength(p.hotPixelStrength);
+        m_darkNoise->setDSNUMap(p.dsnuMap.get());
+        m_darkNoise->setHotPixelMask(p.hotPixelMask.get());
+        m_darkNoise->setFastNormals(p.darkFastNormals);
+        m_photonNoise->setPhotonScale(p.photonScale);
+        m_photonNoise->setFastNormals(p.photonFastNormals);
+        m_readNoise->setReadNoise(p.readNoise);
+        m_readNoise->setFastNormals(p.readFastNormals);
+        m_adc->setBits(p.adcBits);
+        m_adc->setGain(p.adcGain);
+        m_adc->setBlackLevel(p.adcBlackLevel);
+    }
+
+    /// The last applied profile.
+    const SensorProfile& getProfile() const { return m_profile; }
+
     // ── Direct access to each module ────────────────────────────────────
     std::shared_ptr<PRNUEffect>&        prnu()        { return m_prnu; }
     std::shared_ptr<DarkNoiseEffect>&   darkNoise()   { return m_darkNoise; }
     std::shared_ptr<PhotonNoiseEffect>& photonNoise() { return m_photonNoise; }
     std::shared_ptr<ReadNoiseEffect>&   readNoise()   { return m_readNoise; }
+    std::shared_ptr<AdcEffect>&         adc()         { return m_adc; }
+    std::shared_ptr<AccumulationEffect>& accumulation() { return m_accumulation; }  ///< null unless enabled
+
+    /// The underlying chain (offscreen output, readback camera, ...).
+    PostProcessChain& chain() { return m_chain; }
+
+    const std::string& getShaderDir() const { return m_shaderDir; }
 
     /// Get an event handler for interactive control.
     osg::ref_ptr<osgGA::GUIEventHandler> getEventHandler();
 
 private:
     PostProcessChain m_chain;
+    SensorProfile    m_profile;
 
     std::shared_ptr<PRNUEffect>        m_prnu;
     std::shared_ptr<DarkNoiseEffect>   m_darkNoise;
     std::shared_ptr<PhotonNoiseEffect> m_photonNoise;
     std::shared_ptr<ReadNoiseEffect>   m_readNoise;
+    std::shared_ptr<AdcEffect>         m_adc;
+    std::shared_ptr<AccumulationEffect> m_accumulation;
+    std::string                        m_shaderDir;
 };
 
 // ── Keyboard handler ────────────────────────────────────────────────────
@@ -169,18 +285,27 @@ public:
             return true;
         }
 
+        // ── ADC bit depth ───────────────────────────────────────────
+        case 'b':
+        {
+            m_sim.adc()->setBits(m_sim.adc()->getBits() + 1);
+            std::cout << "[Sensor] ADC: " << m_sim.adc()->getBits() << " bit\n";
+            return true;
+        }
+        case 'B':
+        {
+            m_sim.adc()->setBits(m_sim.adc()->getBits() - 1);
+            std::cout << "[Sensor] ADC: " << m_sim.adc()->getBits() << " bit\n";
+            return true;
+        }
+
         // ── Reset all ───────────────────────────────────────────────
         case 'r':
         case 'R':
         {
-            m_sim.photonNoise()->setPhotonScale(100.0f);
-            m_sim.darkNoise()->setDarkCurrent(0.005f);
-            m_sim.darkNoise()->setDSNUStrength(0.003f);
-            m_sim.darkNoise()->setHotPixelProbability(0.0005f);
-            m_sim.darkNoise()->setHotPixelStrength(50.0f);
-            m_sim.readNoise()->setReadNoise(0.01f);
-            m_sim.prnu()->setPRNUStrength(0.01f);
-            std::cout << "[Sensor] All parameters reset to defaults\n";
+            m_sim.resetParameters();
+            std::cout << "[Sensor] All parameters reset to profile '"
+                      << m_sim.getProfile().name << "'\n";
             return true;
         }
 
@@ -201,6 +326,10 @@ public:
             m_sim.readNoise()->setEnabled(!m_sim.readNoise()->isEnabled());
             std::cout << "[Sensor] Read noise " << (m_sim.readNoise()->isEnabled() ? "ON" : "OFF") << "\n";
             return true;
+        case '5':
+            m_sim.adc()->setEnabled(!m_sim.adc()->isEnabled());
+            std::cout << "[Sensor] ADC " << (m_sim.adc()->isEnabled() ? "ON" : "OFF") << "\n";
+            return true;
 
         default:
             return false;
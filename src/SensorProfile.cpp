@@ -0,0 +1,585 @@
+#include "SensorProfile.h"
+
+#include <osgDB/FileNameUtils>
+#include <osgDB/ReadFile>
+
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    // ── Minimal JSON document ───────────────────────────────────────────
+    // Enough for profiles: no \u escapes beyond ASCII, numbers as double.
+    struct JsonValue
+    {
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        Type        type = Type::Null;
+        bool        boolean = false;
+        double      number = 0.0;
+        std::string string;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> members;   ///< in file order
+    };
+
+    class JsonParser
+    {
+    public:
+        explicit JsonParser(const std::string& text) : m_text(text) {}
+
+        /// Parse the whole text as one value; on failure `error` says
+        /// what and where.
+        bool parse(JsonValue& out, std::string& error)
+        {
+            if (!value(out, 0))
+            {
+                error = where() + m_error;
+                return false;
+            }
+            skipSpace();
+            if (m_pos != m_text.size())
+            {
+                error = where() + "trailing characters";
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        static const unsigned int MAX_DEPTH = 64;
+
+        std::string where() const
+        {
+            unsigned int line = 1;
+            for (std::size_t i = 0; i < m_pos && i < m_text.size(); ++i)
+                line += m_text[i] == '\n';
+            return "line " + std::to_string(line) + ": ";
+        }
+
+        bool fail(const char* message)
+        {
+            m_error = message;
+            return false;
+        }
+
+        void skipSpace()
+        {
+            while (m_pos < m_text.size() &&
+                   (m_text[m_pos] == ' ' || m_text[m_pos] == '\t' ||
+                    m_text[m_pos] == '\n' || m_text[m_pos] == '\r'))
+                ++m_pos;
+        }
+
+        bool literal(const char* word)
+        {
+            const std::size_t n = std::char_traits<char>::length(word);
+            if (m_text.compare(m_pos, n, word) != 0)
+                return fail("unexpected character");
+            m_pos += n;
+            return true;
+        }
+
+        bool value(JsonValue& out, unsigned int depth)
+        {
+            if (depth > MAX_DEPTH)
+                return fail("nested too deeply");
+            skipSpace();
+            if (m_pos >= m_text.size())
+                return fail("unexpected end of input");
+
+            const char c = m_text[m_pos];
+            if (c == '{') return object(out, depth);
+            if (c == '[') return array(out, depth);
+            if (c == '"')
+            {
+                out.type = JsonValue::Type::String;
+                return string(out.string);
+            }
+            if (c == 't' || c == 'f')
+            {
+                out.type = JsonValue::Type::Bool;
+                out.boolean = c == 't';
+                return literal(out.boolean ? "true" : "false");
+            }
+            if (c == 'n')
+            {
+                out.type = JsonValue::Type::Null;
+                return literal("null");
+            }
+            return number(out);
+        }
+
+        bool object(JsonValue& out, unsigned int depth)
+        {
+            out.type = JsonValue::Type::Object;
+            ++m_pos;
+            skipSpace();
+            if (m_pos < m_text.size() && m_text[m_pos] == '}')
+            {
+                ++m_pos;
+                return true;
+            }
+            for (;;)
+            {
+                skipSpace();
+                if (m_pos >= m_text.size() || m_text[m_pos] != '"')
+                    return fail("expected a key");
+                std::pair<std::string, JsonValue> member;
+                if (!string(member.first))
+                    return false;
+                skipSpace();
+                if (m_pos >= m_text.size() || m_text[m_pos] != ':')
+                    return fail("expected ':'");
+                ++m_pos;
+                if (!value(member.second, depth + 1))
+                    return false;
+                out.members.push_back(std::move(member));
+
+                skipSpace();
+                if (m_pos < m_text.size() && m_text[m_pos] == ',')
+                {
+                    ++m_pos;
+                    continue;
+                }
+                if (m_pos < m_text.size() && m_text[m_pos] == '}')
+                {
+                    ++m_pos;
+                    return true;
+                }
+                return fail("expected ',' or '}'");
+            }
+        }
+
+        bool array(JsonValue& out, unsigned int depth)
+        {
+            out.type = JsonValue::Type::Array;
+            ++m_pos;
+            skipSpace();
+            if (m_pos < m_text.size() && m_text[m_pos] == ']')
+            {
+                ++m_pos;
+                return true;
+            }
+            for (;;)
+            {
+                out.items.emplace_back();
+                if (!value(out.items.back(), depth + 1))
+                    return false;
+
+                skipSpace();
+                if (m_pos < m_text.size() && m_text[m_pos] == ',')
+                {
+                    ++m_pos;
+                    continue;
+                }
+                if (m_pos < m_text.size() && m_text[m_pos] == ']')
+                {
+                    ++m_pos;
+                    return true;
+                }
+                return fail("expected ',' or ']'");
+            }
+        }
+
+        bool string(std::string& out)
+        {
+            ++m_pos;
+            while (m_pos < m_text.size())
+            {
+                const char c = m_text[m_pos++];
+                if (c == '"')
+                    return true;
+                if (c != '\\')
+                {
+                    out += c;
+                    continue;
+                }
+                if (m_pos >= m_text.size())
+                    break;
+                switch (m_text[m_pos++])
+                {
+                case '"':  out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/':  out += '/';  break;
+                case 'b':  out += '\b'; break;
+                case 'f':  out += '\f'; break;
+                case 'n':  out += '\n'; break;
+                case 'r':  out += '\r'; break;
+                case 't':  out += '\t'; break;
+                case 'u':
+                {
+                    if (m_pos + 4 > m_text.size())
+                        return fail("bad \\u escape");
+                    const unsigned long code = std::strtoul(m_text.substr(m_pos, 4).c_str(), nullptr, 16);
+                    if (code > 0x7F)
+                        return fail("non-ASCII \\u escape");
+                    out += static_cast<char>(code);
+                    m_pos += 4;
+                    break;
+                }
+                default:
+                    return fail("bad escape");
+                }
+            }
+            return fail("unterminated string");
+        }
+
+        // -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?, converted in the
+        // classic locale
+        bool number(JsonValue& out)
+        {
+            const std::size_t begin = m_pos;
+            auto digit = [this]
+            {
+                return m_pos < m_text.size() && m_text[m_pos] >= '0' && m_text[m_pos] <= '9';
+            };
+            auto digits = [this, &digit]
+            {
+                const std::size_t from = m_pos;
+                while (digit())
+                    ++m_pos;
+                return m_pos > from;
+            };
+
+            if (m_pos < m_text.size() && m_text[m_pos] == '-')
+                ++m_pos;
+            if (!digit())
+                return fail(m_pos == begin ? "unexpected character" : "bad number");
+            if (m_text[m_pos] == '0')
+                ++m_pos;
+            else
+                digits();
+            if (m_pos < m_text.size() && m_text[m_pos] == '.')
+            {
+                ++m_pos;
+                if (!digits())
+                    return fail("bad number");
+            }
+            if (m_pos < m_text.size() && (m_text[m_pos] == 'e' || m_text[m_pos] == 'E'))
+            {
+                ++m_pos;
+                if (m_pos < m_text.size() && (m_text[m_pos] == '+' || m_text[m_pos] == '-'))
+                    ++m_pos;
+                if (!digits())
+                    return fail("bad number");
+            }
+
+            std::istringstream ss(m_text.substr(begin, m_pos - begin));
+            ss.imbue(std::locale::classic());
+            if (!(ss >> out.number))
+                return fail("number out of range");
+            out.type = JsonValue::Type::Number;
+            return true;
+        }
+
+        const std::string& m_text;
+        std::size_t        m_pos = 0;
+        const char*        m_error = "";
+    };
+
+    // ── Typed access to one object of the profile ───────────────────────
+    // Every key read is marked; the destructor reports the rest.  Type
+    // errors clear `ok`.
+    class ProfileSection
+    {
+    public:
+        ProfileSection(const JsonValue& object, std::string path, const std::string& file, bool& ok)
+            : m_object(object), m_path(std::move(path)), m_file(file), m_ok(ok),
+              m_used(object.members.size(), false)
+        {
+        }
+
+        ~ProfileSection()
+        {
+            for (std::size_t i = 0; i < m_used.size(); ++i)
+                if (!m_used[i])
+                    std::cerr << "[SensorProfile] WARNING: " << m_file << ": unknown key '"
+                              << qualified(m_object.members[i].first.c_str()) << "' ignored.\n";
+        }
+
+        /// The member `key` if present and of `type`; null otherwise.
+        const JsonValue* get(const char* key, JsonValue::Type type, const char* expected)
+        {
+            for (std::size_t i = 0; i < m_object.members.size(); ++i)
+            {
+                if (m_object.members[i].first != key)
+                    continue;
+                m_used[i] = true;
+                if (m_object.members[i].second.type == type)
+                    return &m_object.members[i].second;
+                error(key, std::string("expected ") + expected);
+                return nullptr;
+            }
+            return nullptr;
+        }
+
+        void read(const char* key, float& out)
+        {
+            if (const JsonValue* v = get(key, JsonValue::Type::Number, "a number"))
+                out = static_cast<float>(v->number);
+        }
+
+        void read(const char* key, int& out)
+        {
+            if (const JsonValue* v = get(key, JsonValue::Type::Number, "an integer"))
+            {
+                if (v->number < -65536.0 || v->number > 65536.0 ||
+                    v->number != double(static_cast<int>(v->number)))
+                    error(key, "expected an integer");
+                else
+                    out = static_cast<int>(v->number);
+            }
+        }
+
+        void read(const char* key, unsigned int& out)
+        {
+            if (const JsonValue* v = get(key, JsonValue::Type::Number, "a count"))
+            {
+                if (v->number < 0.0 || v->number > 65536.0 ||
+                    v->number != double(static_cast<unsigned int>(v->number)))
+                    error(key, "expected a count");
+                else
+                    out = static_cast<unsigned int>(v->number);
+            }
+        }
+
+        void read(const char* key, bool& out)
+        {
+            if (const JsonValue* v = get(key, JsonValue::Type::Bool, "true or false"))
+                out = v->boolean;
+        }
+
+        void read(const char* key, std::string& out)
+        {
+            if (const JsonValue* v = get(key, JsonValue::Type::String, "a string"))
+                out = v->string;
+        }
+
+        /// One of a fixed set of names.
+        template<typename T>
+        void read(const char* key, T& out,
+                  std::initializer_list<std::pair<const char*, T>> names)
+        {
+            const JsonValue* v = get(key, JsonValue::Type::String, "a string");
+            if (!v)
+                return;
+            std::string known;
+            for (const auto& n : names)
+            {
+                if (v->string == n.first)
+                {
+                    out = n.second;
+                    return;
+                }
+                known += known.empty() ? "" : ", ";
+                known += n.first;
+            }
+            error(key, "'" + v->string + "' is not one of " + known);
+        }
+
+        /// A map path relative to `baseDir`; "" keeps the synthetic map.
+        void readMap(const char* key, osg::ref_ptr<osg::Image>& out, const std::string& baseDir)
+        {
+            const JsonValue* v = get(key, JsonValue::Type::String, "a string");
+            if (!v)
+                return;
+            if (v->string.empty())
+            {
+                out = nullptr;
+                return;
+            }
+            std::string file = v->string;
+            if (!baseDir.empty() && !osgDB::isAbsolutePath(file))
+                file = osgDB::concatPaths(baseDir, file);
+            out = osgDB::readRefImageFile(file);
+            if (!out)
+                error(key, "cannot load map " + file);
+        }
+
+        const JsonValue* section(const char* key)
+        {
+            return get(key, JsonValue::Type::Object, "an object");
+        }
+
+        std::string qualified(const char* key) const
+        {
+            return m_path.empty() ? std::string(key) : m_path + "." + key;
+        }
+
+    private:
+        void error(const char* key, const std::string& message)
+        {
+            std::cerr << "[SensorProfile] ERROR: " << m_file << ": " << qualified(key)
+                      << ": " << message << "\n";
+            m_ok = false;
+        }
+
+        const JsonValue&  m_object;
+        std::string       m_path;
+        const std::string& m_file;
+        bool&             m_ok;
+        std::vector<bool> m_used;
+    };
+}
+
+// ============================================================================
+// Names become output subdirectories: one path component, never "." or "..".
+static bool checkName(const std::string& name, const std::string& file)
+{
+    if (name.empty() || name.find_first_of("/\\") != std::string::npos ||
+        name == "." || name.find("..") != std::string::npos)
+    {
+        std::cerr << "[SensorProfile] ERROR: " << file << ": invalid name '" << name
+                  << "' (no path separators or '..')\n";
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+static bool parseProfile(const std::string& json, SensorProfile& profile,
+                         const std::string& baseDir, const std::string& file)
+{
+    JsonValue root;
+    std::string error;
+    if (!JsonParser(json).parse(root, error))
+    {
+        std::cerr << "[SensorProfile] ERROR: " << file << ": " << error << "\n";
+        return false;
+    }
+    if (root.type != JsonValue::Type::Object)
+    {
+        std::cerr << "[SensorProfile] ERROR: " << file << ": expected an object\n";
+        return false;
+    }
+
+    using PPC = PostProcessChain;
+    SensorProfile p = profile;
+    bool ok = true;
+    {
+        ProfileSection top(root, "", file, ok);
+        top.read("name", p.name);
+        top.read("exposure", p.params.exposure);
+
+        if (const JsonValue* v = top.section("pipeline"))
+        {
+            ProfileSection s(*v, "pipeline", file, ok);
+            s.read("mode", p.pipeline.mode,
+                   { { "multipass", PPC::BuildMode::MultiPass }, { "fused", PPC::BuildMode::Fused } });
+            s.read("backend", p.pipeline.backend,
+                   { { "raster", PPC::Backend::Raster }, { "compute", PPC::Backend::Compute } });
+            s.read("signal", p.pipeline.signal,
+                   { { "unorm8", PPC::SignalFormat::UNorm8 }, { "half", PPC::SignalFormat::Float16 },
+                     { "float", PPC::SignalFormat::Float32 }, { "r11g11b10", PPC::SignalFormat::R11G11B10F } });
+            s.read("poisson", p.pipeline.poisson,
+                   { { "fast", PPC::PoissonQuality::Fast }, { "table", PPC::PoissonQuality::Table },
+                     { "exact", PPC::PoissonQuality::Exact } });
+            s.read("cfa", p.pipeline.cfa,
+                   { { "none", PPC::CfaPattern::None }, { "rggb", PPC::CfaPattern::RGGB },
+                     { "bggr", PPC::CfaPattern::BGGR }, { "grbg", PPC::CfaPattern::GRBG },
+                     { "gbrg", PPC::CfaPattern::GBRG } });
+            s.read("demosaic", p.pipeline.demosaic);
+            s.read("subframes", p.pipeline.subFrames);
+            s.read("window", p.pipeline.window,
+                   { { "box", AccumulationEffect::Window::Box },
+                     { "exponential", AccumulationEffect::Window::Exponential } });
+        }
+        if (const JsonValue* v = top.section("prnu"))
+        {
+            ProfileSection s(*v, "prnu", file, ok);
+            s.read("enabled", p.effects.prnu);
+            s.read("strength", p.params.prnuStrength);
+            s.readMap("gainMap", p.params.gainMap, baseDir);
+        }
+        if (const JsonValue* v = top.section("dark"))
+        {
+            ProfileSection s(*v, "dark", file, ok);
+            s.read("enabled", p.effects.dark);
+            s.read("current", p.params.darkCurrent);
+            s.read("dsnu", p.params.dsnuStrength);
+            s.read("hotProbability", p.params.hotPixelProbability);
+            s.read("hotStrength", p.params.hotPixelStrength);
+            s.read("fastNormals", p.params.darkFastNormals);
+            s.readMap("dsnuMap", p.params.dsnuMap, baseDir);
+            s.readMap("hotMask", p.params.hotPixelMask, baseDir);
+        }
+        if (const JsonValue* v = top.section("photon"))
+        {
+            ProfileSection s(*v, "photon", file, ok);
+            s.read("enabled", p.effects.photon);
+            s.read("scale", p.params.photonScale);
+            s.read("fastNormals", p.params.photonFastNormals);
+        }
+        if (const JsonValue* v = top.section("read"))
+        {
+            ProfileSection s(*v, "read", file, ok);
+            s.read("enabled", p.effects.read);
+            s.read("sigma", p.params.readNoise);
+            s.read("fastNormals", p.params.readFastNormals);
+        }
+        if (const JsonValue* v = top.section("adc"))
+        {
+            ProfileSection s(*v, "adc", file, ok);
+            s.read("enabled", p.effects.adc);
+            s.read("bits", p.params.adcBits);
+            s.read("gain", p.params.adcGain);
+            s.read("blackLevel", p.params.adcBlackLevel);
+        }
+    }
+    if (!ok)
+        return false;
+
+    profile = std::move(p);
+    return true;
+}
+
+// ============================================================================
+std::string SensorProfile::Pipeline::key() const
+{
+    // Sub-frame count and window can change on a built chain; only the
+    // presence of the accumulation stage is part of the build
+    std::ostringstream ss;
+    ss << "mode" << int(mode) << "_backend" << int(backend) << "_signal" << int(signal)
+       << "_poisson" << int(poisson) << "_cfa" << int(cfa) << (demosaic ? "_demosaic" : "")
+       << (subFrames > 1 ? "_accum" : "");
+    return ss.str();
+}
+
+// ============================================================================
+bool SensorProfile::load(const std::string& path, SensorProfile& profile)
+{
+    std::ifstream ifs(path);
+    if (!ifs.is_open())
+    {
+        std::cerr << "[SensorProfile] ERROR: Cannot open file: " << path << "\n";
+        return false;
+    }
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+
+    SensorProfile loaded = profile;
+    loaded.name.clear();
+    if (!parseProfile(ss.str(), loaded, osgDB::getFilePath(path), path))
+        return false;
+    if (loaded.name.empty())
+        loaded.name = osgDB::getStrippedName(path);
+    if (!checkName(loaded.name, path))
+        return false;
+    profile = std::move(loaded);
+    return true;
+}
+
+// ============================================================================
+bool SensorProfile::parse(const std::string& json, SensorProfile& profile,
+                          const std::string& baseDir)
+{
+    SensorProfile parsed = profile;
+    if (!parseProfile(json, parsed, baseDir, "profile") || !checkName(parsed.name, "profile"))
+        return false;
+    profile = std::move(parsed);
+    return true;
+}
@@ -0,0 +1,116 @@
+#pragma once
+// ============================================================================
+//  SensorProfile — Machine-readable description of one simulated sensor
+// ============================================================================
+//  Everything SensorNoiseSimulator needs to model a sensor, in two parts:
+//
+//    pipeline    what the chain is built from (build mode, backend, signal
+//                format, Poisson sampler, CFA, temporal stage).  Changing
+//                any of it means a new build; Pipeline::key() tells
+//                chains apart, and SensorProfileCache keeps one built
+//                chain per key.
+//    effects /   which of the five modules run and their parameters.
+//    params      Uniforms, baked maps and bypass only: cheap to change on
+//                a built chain.
+//
+//  Default-constructed members are the simulator's defaults, so a profile
+//  only lists what differs.  Profiles are JSON files:
+//
+//    {
+//      "name": "imx-lowlight",
+//      "pipeline": { "mode": "fused", "backend": "raster", "signal": "half",
+//                    "poisson": "table", "cfa": "rggb", "demosaic": false,
+//                    "subframes": 1, "window": "box" },
+//      "exposure": 1.0,
+//      "prnu":   { "enabled": true, "strength": 0.01, "gainMap": "gain.exr" },
+//      "dark":   { "current": 0.005, "dsnu": 0.003, "hotProbability": 0.0005,
+//                  "hotStrength": 50, "fastNormals": false,
+//                  "dsnuMap": "dsnu.exr", "hotMask": "hot.png" },
+//      "photon": { "scale": 100, "fastNormals": false },
+//      "read":   { "sigma": 0.01, "fastNormals": false },
+//      "adc":    { "bits": 12, "gain": 1.0, "blackLevel": 0.0 }
+//    }
+//
+//  The effect order is fixed by the physics (SensorNoiseSimulator), so the
+//  effect list is the set of enabled modules.  Map paths are relative to
+//  the profile file and loaded with it.
+// ============================================================================
+
+#include "PostProcessChain.h"
+#include "AccumulationEffect.h"
+
+#include <osg/Image>
+#include <osg/ref_ptr>
+
+#include <string>
+
+struct SensorProfile
+{
+    /// Chain construction; takes effect when the chain is built.
+    struct Pipeline
+    {
+        PostProcessChain::BuildMode      mode    = PostProcessChain::BuildMode::MultiPass;
+        PostProcessChain::Backend        backend = PostProcessChain::Backend::Raster;
+        PostProcessChain::SignalFormat   signal  = PostProcessChain::SignalFormat::Float16;
+        PostProcessChain::PoissonQuality poisson = PostProcessChain::PoissonQuality::Table;
+        PostProcessChain::CfaPattern     cfa     = PostProcessChain::CfaPattern::None;
+        bool                             demosaic  = false;
+        unsigned int                     subFrames = 1;   ///< > 1 adds the accumulation stage
+        AccumulationEffect::Window       window    = AccumulationEffect::Window::Box;
+
+        /// Identifies the built chain: equal keys can share one.
+        std::string key() const;
+    };
+
+    /// Enabled modules.
+    struct Effects
+    {
+        bool prnu   = true;
+        bool dark   = true;
+        bool photon = true;
+        bool read   = true;
+        bool adc    = true;
+    };
+
+    /// Run-time parameters.  Null maps = synthetic ones.
+    struct Parameters
+    {
+        float exposure            = 1.0f;
+        float prnuStrength        = 0.01f;
+        float darkCurrent         = 0.005f;
+        float dsnuStrength        = 0.003f;
+        float hotPixelProbability = 0.0005f;
+        float hotPixelStrength    = 50.0f;
+        float photonScale         = 100.0f;
+        float readNoise           = 0.01f;
+        int   adcBits             = 12;
+        float adcGain             = 1.0f;
+        float adcBlackLevel       = 0.0f;
+        bool  photonFastNormals   = false;
+        bool  darkFastNormals     = false;
+        bool  readFastNormals     = false;
+
+        osg::ref_ptr<osg::Image> gainMap;
+        osg::ref_ptr<osg::Image> dsnuMap;
+        osg::ref_ptr<osg::Image> hotPixelMask;
+    };
+
+    std::string name = "default";
+    Pipeline    pipeline;
+    Effects     effects;
+    Parameters  params;
+
+    /// Read a JSON profile over `profile`: members the file does not
+    /// mention keep their values (start from a default-constructed
+    /// profile, or a base such as the command line's).  Unknown keys are
+    /// reported and skipped.  Returns false (leaving `profile` untouched)
+    /// on a syntax error, a value of the wrong type or a map that cannot
+    /// be loaded, or a name that is not a plain directory name (empty,
+    /// a path separator or ".."); names become output subdirectories.
+    /// Without a "name" the file's base name is used.
+    static bool load(const std::string& path, SensorProfile& profile);
+
+    /// load() from a string; map paths are relative to `baseDir`.
+    static bool parse(const std::string& json, SensorProfile& profile,
+                      const std::string& baseDir = "");
+};
@@ -0,0 +1,54 @@
+#include "SensorProfileCache.h"
+
+#include <iostream>
+
+// ============================================================================
+SensorProfileCache::SensorProfileCache(unsigned int width, unsigned int height,
+                                       const std::string& shaderDir, Configure configure)
+    : m_width(width), m_height(height), m_shaderDir(shaderDir),
+      m_configure(std::move(configure)),
+      m_pool(std::make_shared<RenderTargetPool>()),
+      m_switch(new osg::Switch), m_sceneSlot(new osg::Group)
+{
+}
+
+// ============================================================================
+SensorProfileCache::Entry& SensorProfileCache::entry(const SensorProfile& profile)
+{
+    const std::string key = profile.pipeline.key();
+    auto it = m_entries.find(key);
+    if (it != m_entries.end())
+        return it->second;
+
+    Entry& e = m_entries[key];
+    e.sim.reset(new SensorNoiseSimulator(m_width, m_height, m_shaderDir, profile.pipeline.backend));
+    e.sim->setRenderTargetPool(m_pool);
+    if (m_configure)
+        m_configure(*e.sim);
+    e.sim->applyProfile(profile);
+
+    e.child = m_switch->getNumChildren();
+    m_switch->addChild(e.sim->apply(m_sceneSlot), false);
+    std::cout << "[SensorProfileCache] Built chain " << e.child << " (" << key
+              << ") for profile '" << profile.name << "'\n";
+    return e;
+}
+
+// ============================================================================
+SensorNoiseSimulator& SensorProfileCache::prepare(const SensorProfile& profile)
+{
+    return *entry(profile).sim;
+}
+
+// ============================================================================
+SensorNoiseSimulator& SensorProfileCache::select(const SensorProfile& profile)
+{
+    Entry& e = entry(profile);
+    if (m_active != e.sim.get())
+    {
+        m_switch->setSingleChildOn(e.child);
+        m_active = e.sim.get();
+    }
+    e.sim->applyProfile(profile);
+    return *e.sim;
+}
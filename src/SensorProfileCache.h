@@ -0,0 +1,84 @@
+#pragma once
+// ============================================================================
+//  SensorProfileCache — Built chains for switching between sensor profiles
+// ============================================================================
+//  A SensorProfile splits into a pipeline (what a chain is built from) and
+//  parameters (uniforms, maps, bypass).  The cache keeps one built
+//  SensorNoiseSimulator per pipeline key under an osg::Switch, all reading
+//  one scene slot, so selecting a profile is a switch flip plus parameter
+//  uploads: programs and FBO layouts stay built.  Profiles that differ
+//  only in parameters share a chain.
+//
+//  Only the selected chain is traversed, so the chains share one
+//  RenderTargetPool (swapped in one at a time, see RenderTargetPool) and
+//  ProgramCache hands identical programs to all of them.  Chains built
+//  before the viewer's first frame are compiled with it (the compile
+//  traversal includes switched-off children); later ones on their first
+//  draw, or from the binary cache (ProgramCache::setBinaryCacheDirectory).
+// ============================================================================
+
+#include "SensorNoiseSimulator.h"
+#include "SensorProfile.h"
+#include "RenderTargetPool.h"
+
+#include <osg/Group>
+#include <osg/Switch>
+#include <osg/ref_ptr>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+class SensorProfileCache
+{
+public:
+    using Configure = std::function<void(SensorNoiseSimulator&)>;
+
+    /// Chains are width x height.  `configure` sets up every new
+    /// simulator before its profile is applied, for what profiles do not
+    /// hold (seed, timing, offscreen output, layers, ...).
+    SensorProfileCache(unsigned int width, unsigned int height,
+                       const std::string& shaderDir = "shaders",
+                       Configure configure = Configure());
+
+    /// Build the chain for `profile`'s pipeline unless the cache holds
+    /// one; the simulator keeps `profile` applied.  Does not select it.
+    SensorNoiseSimulator& prepare(const SensorProfile& profile);
+
+    /// Make the chain of `profile`'s pipeline the active one (building
+    /// it if needed) and apply the profile's modules and parameters.  The
+    /// caller restarts exposures and frame numbering as it needs.
+    SensorNoiseSimulator& select(const SensorProfile& profile);
+
+    /// nullptr until select().
+    SensorNoiseSimulator* getActive() const { return m_active; }
+
+    /// Switch over all built chains; the viewer's scene data.
+    osg::Group* getRoot() const { return m_switch.get(); }
+
+    /// Group every chain renders; put the scene under it.
+    osg::Group* getSceneSlot() const { return m_sceneSlot.get(); }
+
+    unsigned int getNumChains() const { return static_cast<unsigned int>(m_entries.size()); }
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<SensorNoiseSimulator> sim;
+        unsigned int                          child = 0;   ///< index under m_switch
+    };
+
+    Entry& entry(const SensorProfile& profile);
+
+    unsigned int m_width;
+    unsigned int m_height;
+    std::string  m_shaderDir;
+    Configure    m_configure;
+
+    std::map<std::string, Entry>      m_entries;   ///< by SensorProfile::Pipeline::key()
+    std::shared_ptr<RenderTargetPool> m_pool;
+    osg::ref_ptr<osg::Switch>         m_switch;
+    osg::ref_ptr<osg::Group>          m_sceneSlot;
+    SensorNoiseSimulator*             m_active = nullptr;
+};
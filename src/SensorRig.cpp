@@ -0,0 +1,153 @@
+#include "SensorRig.h"
+#include "ProgramCache.h"
+#include "RenderTargetPool.h"
+
+#include <osg/Geode>
+#include <osg/Geometry>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+// Mosaic tiles: the sensor output as is (already quantised by the ADC).
+static const char* kMosaicFragment =
+    "#version 330 core\n"
+    "in vec2 v_texCoord;\n"
+    "uniform sampler2D u_inputTexture;\n"
+    "out vec4 fragColor;\n"
+    "void main()\n"
+    "{\n"
+    "    fragColor = vec4(texture(u_inputTexture, v_texCoord).rgb, 1.0);\n"
+    "}\n";
+
+// ============================================================================
+SensorRig::SensorRig(unsigned int sceneWidth, unsigned int sceneHeight,
+                     const std::string& shaderDir)
+    : m_sceneWidth(sceneWidth), m_sceneHeight(sceneHeight), m_shaderDir(shaderDir)
+{
+}
+
+// ============================================================================
+SensorNoiseSimulator& SensorRig::addSensor(unsigned int width, unsigned int height,
+                                           PostProcessChain::Backend backend)
+{
+    m_sensors.emplace_back(new SensorNoiseSimulator(width, height, m_shaderDir, backend));
+    return *m_sensors.back();
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Group> SensorRig::build(osg::ref_ptr<osg::Node> scene)
+{
+    osg::ref_ptr<osg::Group> root = new osg::Group;
+
+    // ── One scene render for every sensor ───────────────────────────────
+    m_sceneTexture = RenderTargetPool::createTexture(m_sceneWidth, m_sceneHeight, m_sceneFormat);
+    root->addChild(PostProcessChain::createSceneCamera(scene, m_sceneTexture));
+
+    // ── One chain per sensor ────────────────────────────────────────────
+    // Each chain's passes follow the previous chain's in render order, so
+    // all of them share one pool: two intermediates per size and format.
+    auto pool = std::make_shared<RenderTargetPool>();
+    int orderBase = 0;
+    for (unsigned int i = 0; i < m_sensors.size(); ++i)
+    {
+        PostProcessChain& chain = m_sensors[i]->chain();
+        chain.setOffscreenOutput(true);
+        chain.setRenderTargetPool(pool);
+        chain.setRenderOrderBase(orderBase);
+        if (chain.getLayerCount() > 1)
+        {
+            std::cerr << "[SensorRig] WARNING: Sensor " << i
+                      << ": layered output is not supported in a rig; rendering one layer.\n";
+            chain.setLayerCount(1);
+        }
+        std::cout << "[SensorRig] Sensor " << i << ": " << chain.getWidth()
+                  << "x" << chain.getHeight() << "\n";
+        root->addChild(chain.buildFromTexture(m_sceneTexture));
+        orderBase += static_cast<int>(chain.getNumPasses());
+    }
+
+    m_mosaicCamera  = nullptr;
+    m_mosaicTexture = nullptr;
+    if (m_output != Output::Separate && !m_sensors.empty())
+        root->addChild(createMosaic());
+
+    return root;
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Camera> SensorRig::createMosaic()
+{
+    unsigned int tileW = 0, tileH = 0;
+    for (auto& s : m_sensors)
+    {
+        tileW = std::max(tileW, s->chain().getWidth());
+        tileH = std::max(tileH, s->chain().getHeight());
+    }
+    const unsigned int n    = static_cast<unsigned int>(m_sensors.size());
+    const unsigned int cols = static_cast<unsigned int>(std::ceil(std::sqrt(double(n))));
+    const unsigned int rows = (n + cols - 1) / cols;
+    const unsigned int mosaicW = cols * tileW;
+    const unsigned int mosaicH = rows * tileH;
+
+    // After every chain's final pass (all PRE_RENDER, offscreen)
+    m_mosaicCamera = new osg::Camera;
+    m_mosaicCamera->setClearMask(GL_COLOR_BUFFER_BIT);
+    m_mosaicCamera->setClearColor(osg::Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    m_mosaicCamera->setRenderOrder(osg::Camera::POST_RENDER, 1);
+    m_mosaicCamera->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
+    m_mosaicCamera->setProjectionMatrix(osg::Matrix::ortho2D(0.0, mosaicW, 0.0, mosaicH));
+    m_mosaicCamera->setViewMatrix(osg::Matrix::identity());
+
+    if (m_output == Output::MosaicOffscreen)
+    {
+        // RGBA holding every tile: 16-bit unless all sensors are 8-bit.
+        // Raw tiles arrive as grey through their output's swizzle.
+        GLint format = GL_RGBA;
+        for (auto& s : m_sensors)
+        {
+            const GLint tile = s->chain().getOutputTexture()->getInternalFormat();
+            if (tile != GL_RGBA && tile != GL_R8)
+                format = GL_RGBA16;
+        }
+        m_mosaicTexture = RenderTargetPool::createTexture(mosaicW, mosaicH, format);
+        m_mosaicCamera->setRenderTargetImplementation(osg::Camera::FRAME_BUFFER_OBJECT);
+        m_mosaicCamera->setViewport(0, 0, mosaicW, mosaicH);
+        m_mosaicCamera->attach(osg::Camera::COLOR_BUFFER0, m_mosaicTexture.get());
+    }
+
+    osg::StateSet* camSS = m_mosaicCamera->getOrCreateStateSet();
+    camSS->setMode(GL_DEPTH_TEST, osg::StateAttribute::OFF);
+    camSS->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+    camSS->setAttributeAndModes(ProgramCache::instance().get("Mosaic", {
+        { osg::Shader::VERTEX,   ProgramCache::instance().source(m_shaderDir + "/fullscreen_quad.vert") },
+        { osg::Shader::FRAGMENT, kMosaicFragment } },
+        [](osg::Program* program) {
+            program->addBindAttribLocation("osg_Vertex", 0);
+            program->addBindAttribLocation("osg_MultiTexCoord0", 1);
+        }), osg::StateAttribute::ON);
+    camSS->addUniform(new osg::Uniform("u_inputTexture", 0));
+
+    // ── One quad per sensor, sensor 0 top left, at its own size ─────────
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        const PostProcessChain& chain = m_sensors[i]->chain();
+        const float x = float((i % cols) * tileW);
+        const float y = float((rows - 1 - i / cols) * tileH + (tileH - chain.getHeight()));
+
+        osg::ref_ptr<osg::Geometry> quad = osg::createTexturedQuadGeometry(
+            osg::Vec3(x, y, 0.0f),
+            osg::Vec3(float(chain.getWidth()), 0.0f, 0.0f),
+            osg::Vec3(0.0f, float(chain.getHeight()), 0.0f));
+        quad->getOrCreateStateSet()->setTextureAttributeAndModes(
+            0, chain.getOutputTexture(), osg::StateAttribute::ON);
+        geode->addDrawable(quad);
+    }
+    m_mosaicCamera->addChild(geode);
+
+    std::cout << "[SensorRig] Mosaic " << cols << "x" << rows << " tiles, "
+              << mosaicW << "x" << mosaicH
+              << (m_output == Output::MosaicOffscreen ? " (offscreen)" : "") << "\n";
+    return m_mosaicCamera;
+}
@@ -0,0 +1,84 @@
+#pragma once
+// ============================================================================
+//  SensorRig — Several simulated sensors sharing one scene render
+// ============================================================================
+//  The 3D scene is rendered once per frame into a linear float texture;
+//  every sensor is a full SensorNoiseSimulator (its own effect instances,
+//  uniforms and resolution) whose chain is built with buildFromTexture()
+//  on that texture.  A sensor with a different resolution than the scene
+//  samples it bilinearly.
+//
+//  Each chain renders offscreen into its own output texture
+//  (getSensorOutput()).  The chains run one after the other (consecutive
+//  render-order bases) and share one RenderTargetPool, so the rig holds
+//  two intermediates per size and format instead of two per sensor.
+//
+//  With a mosaic the outputs are also tiled into a grid of ceil(sqrt(N))
+//  columns, on screen or into getMosaicTexture(); tiles are as large as
+//  the largest sensor, sensor 0 top left.  The offscreen mosaic is RGBA16
+//  unless every sensor outputs 8 bits, so sensors of different formats
+//  keep their channels and precision; CFA raw tiles show as grey.
+// ============================================================================
+
+#include "SensorNoiseSimulator.h"
+
+#include <osg/Camera>
+#include <osg/Group>
+#include <osg/Texture2D>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class SensorRig
+{
+public:
+    enum class Output
+    {
+        Separate,          ///< per-sensor output textures only
+        MosaicOnScreen,    ///< plus a tiled view in the window
+        MosaicOffscreen    ///< plus a tiled texture (getMosaicTexture())
+    };
+
+    SensorRig(unsigned int sceneWidth, unsigned int sceneHeight,
+              const std::string& shaderDir = "shaders");
+
+    /// Add a sensor of the given resolution; configure the returned
+    /// simulator (parameters, build mode, ...) before build().
+    SensorNoiseSimulator& addSensor(unsigned int width, unsigned int height,
+                                    PostProcessChain::Backend backend = PostProcessChain::Backend::Raster);
+
+    unsigned int          getNumSensors() const { return static_cast<unsigned int>(m_sensors.size()); }
+    SensorNoiseSimulator& sensor(unsigned int i) { return *m_sensors[i]; }
+
+    /// Call before build().
+    void   setOutput(Output o) { m_output = o; }
+    Output getOutput() const   { return m_output; }
+
+    /// Scene texture format (default GL_RGBA16F: linear, unclipped signal).
+    void setSceneFormat(GLint internalFormat) { m_sceneFormat = internalFormat; }
+
+    /// Scene camera, one chain per sensor and the optional mosaic.
+    osg::ref_ptr<osg::Group> build(osg::ref_ptr<osg::Node> scene);
+
+    /// Valid after build().
+    osg::Texture2D* getSceneTexture() const               { return m_sceneTexture.get(); }
+    osg::Texture2D* getSensorOutput(unsigned int i) const { return m_sensors[i]->chain().getOutputTexture(); }
+    osg::Camera*    getMosaicCamera() const               { return m_mosaicCamera.get(); }
+    osg::Texture2D* getMosaicTexture() const              { return m_mosaicTexture.get(); }
+
+private:
+    osg::ref_ptr<osg::Camera> createMosaic();
+
+    unsigned int m_sceneWidth;
+    unsigned int m_sceneHeight;
+    std::string  m_shaderDir;
+    Output       m_output = Output::Separate;
+    GLint        m_sceneFormat = GL_RGBA16F_ARB;
+
+    std::vector<std::unique_ptr<SensorNoiseSimulator>> m_sensors;
+
+    osg::ref_ptr<osg::Texture2D> m_sceneTexture;
+    osg::ref_ptr<osg::Camera>    m_mosaicCamera;
+    osg::ref_ptr<osg::Texture2D> m_mosaicTexture;
+};
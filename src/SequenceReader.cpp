@@ -0,0 +1,157 @@
+#include "SequenceReader.h"
+
+#include <osgDB/FileNameUtils>
+#include <osgDB/FileUtils>
+#include <osgDB/ReadFile>
+
+#include <algorithm>
+#include <iostream>
+
+// ── Helper ──────────────────────────────────────────────────────────────────
+static bool isImageFile(const std::string& name)
+{
+    static const char* kExtensions[] = {
+        "png", "jpg", "jpeg", "tif", "tiff", "exr", "hdr", "bmp", "tga", "dds", "rgb"
+    };
+    const std::string ext = osgDB::getLowerCaseFileExtension(name);
+    for (const char* e : kExtensions)
+        if (ext == e)
+            return true;
+    return false;
+}
+
+// ============================================================================
+SequenceReader::SequenceReader(std::vector<std::string> files, std::size_t queueSize)
+    : m_files(std::move(files)), m_queue(std::max<std::size_t>(2, queueSize))
+{
+}
+
+// ============================================================================
+SequenceReader::~SequenceReader()
+{
+    stop();
+}
+
+// ============================================================================
+std::vector<std::string> SequenceReader::listFiles(const std::string& path)
+{
+    std::vector<std::string> files;
+    if (osgDB::fileType(path) != osgDB::DIRECTORY)
+    {
+        if (osgDB::fileExists(path))
+            files.push_back(path);
+        return files;
+    }
+
+    for (const std::string& name : osgDB::getDirectoryContents(path))
+        if (isImageFile(name))
+            files.push_back(osgDB::concatPaths(path, name));
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+// ============================================================================
+bool SequenceReader::start(bool loop)
+{
+    stop();
+    m_loop = loop;
+    m_stop = false;
+    m_done = false;
+    m_decoded = 0;
+    m_failed = 0;
+
+    // The first readable frame defines the sequence
+    m_width = 0;
+    for (unsigned int i = 0; i < m_files.size(); ++i)
+    {
+        osg::ref_ptr<osg::Image> image = decode(i);
+        if (!image)
+            continue;
+        m_width       = static_cast<unsigned int>(image->s());
+        m_height      = static_cast<unsigned int>(image->t());
+        m_pixelFormat = image->getPixelFormat();
+        m_dataType    = image->getDataType();
+
+        Frame frame;
+        frame.index = i;
+        frame.image = image;
+        push(frame);
+        m_thread = std::thread(&SequenceReader::decodeLoop, this, i + 1);
+        return true;
+    }
+
+    std::cerr << "[SequenceReader] ERROR: No readable frame among "
+              << m_files.size() << " files.\n";
+    m_done = true;
+    return false;
+}
+
+// ============================================================================
+void SequenceReader::stop()
+{
+    m_stop.store(true, std::memory_order_release);
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+// ============================================================================
+bool SequenceReader::next(Frame& frame, bool wait)
+{
+    if (!wait)
+        return m_queue.tryPop(frame);
+    return m_queue.popWait(frame, [this] { return m_done.load(std::memory_order_acquire); });
+}
+
+// ============================================================================
+osg::ref_ptr<osg::Image> SequenceReader::decode(unsigned int index)
+{
+    osg::ref_ptr<osg::Image> image = osgDB::readRefImageFile(m_files[index]);
+    if (!image || !image->data())
+    {
+        std::cerr << "[SequenceReader] ERROR: Cannot read " << m_files[index] << "\n";
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (m_width != 0 &&
+        (static_cast<unsigned int>(image->s()) != m_width ||
+         static_cast<unsigned int>(image->t()) != m_height ||
+         image->getPixelFormat() != m_pixelFormat || image->getDataType() != m_dataType))
+    {
+        std::cerr << "[SequenceReader] ERROR: " << m_files[index]
+                  << " differs in size or format from the first frame; skipped.\n";
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    m_decoded.fetch_add(1, std::memory_order_relaxed);
+    return image;
+}
+
+// ============================================================================
+void SequenceReader::push(Frame& frame)
+{
+    // Queue full: the consumer is behind, which is the point of reading ahead
+    m_queue.pushWait(frame, [this] { return m_stop.load(std::memory_order_acquire); });
+}
+
+// ============================================================================
+void SequenceReader::decodeLoop(unsigned int firstIndex)
+{
+    unsigned int i = firstIndex;
+    while (!m_stop.load(std::memory_order_acquire))
+    {
+        if (i >= m_files.size())
+        {
+            if (!m_loop || m_decoded.load(std::memory_order_relaxed) == 0)
+                break;
+            i = 0;
+        }
+
+        Frame frame;
+        frame.index = i;
+        frame.image = decode(i);
+        ++i;
+        if (frame.image)
+            push(frame);
+    }
+    m_done.store(true, std::memory_order_release);
+}
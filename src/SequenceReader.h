@@ -0,0 +1,92 @@
+#pragma once
+// ============================================================================
+//  SequenceReader — Background decoder for clean input image sequences
+// ============================================================================
+//  Decodes a list of image files on its own thread (osgDB readers) and
+//  hands the frames to the draw thread through a lock-free
+//  BoundedFrameQueue, so decoding overlaps the GPU work of the frames
+//  before it.  The first file fixes size, pixel format and type; frames
+//  that differ are skipped and counted as failed.
+//
+//  Pixel values go into the chain as they are: the sequence should hold
+//  linear scene-referred data.
+// ============================================================================
+
+#include "BoundedFrameQueue.h"
+
+#include <osg/Image>
+#include <osg/ref_ptr>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SequenceReader
+{
+public:
+    struct Frame
+    {
+        unsigned int             index = 0;   ///< position in the file list
+        osg::ref_ptr<osg::Image> image;
+    };
+
+    /// @param files      Frames in playback order
+    /// @param queueSize  Decoded frames held ahead of the consumer
+    explicit SequenceReader(std::vector<std::string> files, std::size_t queueSize = 8);
+    ~SequenceReader();
+
+    SequenceReader(const SequenceReader&) = delete;
+    SequenceReader& operator=(const SequenceReader&) = delete;
+
+    /// The image files of a directory (sorted by name), or `path` itself
+    /// if it is a file.
+    static std::vector<std::string> listFiles(const std::string& path);
+
+    /// Decode the first frame (to learn the format), then start the
+    /// decoder thread.  With `loop` the list repeats forever.
+    /// Returns false if the first frame cannot be read.
+    bool start(bool loop = false);
+
+    /// Stop the decoder thread (also done by the destructor).
+    void stop();
+
+    /// Next decoded frame.  With `wait` block until one is ready; false
+    /// once the sequence is exhausted (or, without `wait`, none is ready).
+    bool next(Frame& frame, bool wait);
+
+    /// Every frame has been decoded and taken.
+    bool isExhausted() const
+    {
+        return m_done.load(std::memory_order_acquire) && m_queue.size() == 0;
+    }
+
+    unsigned int getWidth()  const { return m_width;  }
+    unsigned int getHeight() const { return m_height; }
+    GLenum getPixelFormat() const  { return m_pixelFormat; }
+    GLenum getDataType() const     { return m_dataType; }
+
+    std::size_t  getNumFiles() const { return m_files.size(); }
+    unsigned int getNumDecoded() const { return m_decoded.load(std::memory_order_relaxed); }
+    unsigned int getNumFailed() const  { return m_failed.load(std::memory_order_relaxed); }
+
+private:
+    void decodeLoop(unsigned int firstIndex);
+    osg::ref_ptr<osg::Image> decode(unsigned int index);
+    void push(Frame& frame);
+
+    std::vector<std::string>   m_files;
+    BoundedFrameQueue<Frame>   m_queue;
+    std::thread                m_thread;
+    bool                       m_loop = false;
+
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    GLenum       m_pixelFormat = GL_RGBA;
+    GLenum       m_dataType = GL_UNSIGNED_BYTE;
+
+    std::atomic<bool>         m_stop{ false };
+    std::atomic<bool>         m_done{ false };
+    std::atomic<unsigned int> m_decoded{ 0 };
+    std::atomic<unsigned int> m_failed{ 0 };
+};
@@ -0,0 +1,209 @@
+#include "ShaderHotReload.h"
+
+#include <osg/GLExtensions>
+#include <osg/State>
+#include <osg/Timer>
+
+#include <iostream>
+
+// ============================================================================
+ShaderHotReload::ShaderHotReload(const std::string& shaderDir, double pollSeconds)
+    : m_dir(shaderDir), m_pollSeconds(pollSeconds)
+{
+    m_times = scan();
+    m_worker = std::thread(&ShaderHotReload::workerLoop, this);
+    std::cout << "[ShaderHotReload] Watching " << m_dir << " (" << m_times.size()
+              << " files)\n";
+}
+
+// ============================================================================
+ShaderHotReload::~ShaderHotReload()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+// ============================================================================
+ShaderHotReload::FileTimes ShaderHotReload::scan() const
+{
+    FileTimes times;
+    std::error_code ec;
+    for (auto it = std::filesystem::directory_iterator(m_dir, ec);
+         !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+    {
+        if (!it->is_regular_file(ec))
+            continue;
+        const auto time = it->last_write_time(ec);
+        if (!ec)
+            times[m_dir + "/" + it->path().filename().string()] = time;
+    }
+    return times;
+}
+
+// ============================================================================
+std::vector<std::string> ShaderHotReload::pollChanges()
+{
+    const double now = osg::Timer::instance()->time_s();
+    if (now - m_lastPoll < m_pollSeconds)
+        return {};
+    m_lastPoll = now;
+
+    FileTimes times = scan();
+    std::vector<std::string> changed;
+    for (auto& kv : times)
+    {
+        auto old = m_times.find(kv.first);
+        if (old == m_times.end() || old->second != kv.second)
+            changed.push_back(kv.first);
+    }
+    // Deleted files are ignored: editors that save via rename briefly
+    // remove the file, and the running program stays valid meanwhile.
+    for (auto& kv : m_times)
+        if (!times.count(kv.first))
+            times.insert(kv);
+
+    m_times = std::move(times);
+    return changed;
+}
+
+// ============================================================================
+void ShaderHotReload::compile(osg::ref_ptr<osg::Program> program, unsigned int tag)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back({ program, tag });
+    }
+    m_cv.notify_all();
+}
+
+// ============================================================================
+std::vector<ShaderHotReload::Result> ShaderHotReload::takeResults()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Result> results;
+    results.swap(m_results);
+    return results;
+}
+
+// ============================================================================
+void ShaderHotReload::onDraw(osg::RenderInfo& renderInfo)
+{
+    std::vector<Job> jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_sharedContext.valid())
+        {
+            m_sharedContext = renderInfo.getState()->getGraphicsContext();
+            m_cv.notify_all();
+        }
+        if (m_background)
+            return;
+        jobs.swap(m_jobs);
+    }
+
+    // Fallback: compile on the render thread, still verified before swap
+    std::vector<Result> results;
+    for (auto& job : jobs)
+        results.push_back(compileNow(job, *renderInfo.getState()));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_results.insert(m_results.end(), results.begin(), results.end());
+}
+
+// ============================================================================
+bool ShaderHotReload::createContext()
+{
+    osg::ref_ptr<osg::GraphicsContext> shared;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_sharedContext.lock(shared))
+            return false;
+    }
+
+    // A context created with sharedContext reuses the shared one's
+    // context ID, so per-context program objects are shared too.
+    osg::ref_ptr<osg::GraphicsContext::Traits> traits =
+        new osg::GraphicsContext::Traits(*shared->getTraits());
+    traits->x = 0;
+    traits->y = 0;
+    traits->width  = 1;
+    traits->height = 1;
+    traits->windowDecoration = false;
+    traits->doubleBuffer = false;
+    traits->pbuffer = true;
+    traits->sharedContext = shared;
+
+    m_context = osg::GraphicsContext::createGraphicsContext(traits.get());
+    if (!m_context.valid() || !m_context->realize() || !m_context->makeCurrent())
+    {
+        std::cerr << "[ShaderHotReload] WARNING: No shared compile context; "
+                     "compiling on the render thread.\n";
+        m_context = nullptr;
+        return false;
+    }
+    m_context->getState()->initializeExtensionProcs();
+    return true;
+}
+
+// ============================================================================
+ShaderHotReload::Result ShaderHotReload::compileNow(const Job& job, osg::State& state) const
+{
+    Result result;
+    result.tag     = job.tag;
+    result.program = job.program;
+
+    job.program->compileGLObjects(state);
+    osg::Program::PerContextProgram* pcp = job.program->getPCP(state);
+    result.linked = pcp && pcp->isLinked();
+    return result;
+}
+
+// ============================================================================
+void ShaderHotReload::workerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_cv.wait(lock, [this] {
+            return m_stop || (m_background && !m_jobs.empty() && m_sharedContext.valid());
+        });
+        if (m_stop)
+            break;
+
+        std::vector<Job> jobs;
+        jobs.swap(m_jobs);
+        lock.unlock();
+
+        if (!m_context.valid() && !createContext())
+        {
+            // Hand the jobs to the draw callback from now on
+            lock.lock();
+            m_background = false;
+            m_jobs.insert(m_jobs.begin(), jobs.begin(), jobs.end());
+            break;
+        }
+
+        std::vector<Result> results;
+        for (auto& job : jobs)
+            results.push_back(compileNow(job, *m_context->getState()));
+
+        // Objects must be complete before the render thread uses them
+        glFinish();
+
+        lock.lock();
+        m_results.insert(m_results.end(), results.begin(), results.end());
+    }
+    lock.unlock();
+
+    if (m_context.valid())
+    {
+        m_context->releaseContext();
+        m_context->close();
+        m_context = nullptr;
+    }
+}
@@ -0,0 +1,98 @@
+#pragma once
+// ============================================================================
+//  ShaderHotReload — Shader file watcher and off-frame program compiler
+// ============================================================================
+//  pollChanges() compares the modification times of the files in a shader
+//  directory (at most every `pollSeconds`) and returns the changed paths.
+//  compile() queues a program for a worker thread that owns a 1x1 pbuffer
+//  sharing the viewer's context: compiling there creates the program's
+//  per-context objects under the same context ID, so the render thread
+//  picks up the linked GL program as-is and never waits on the compiler.
+//  takeResults() hands back finished programs with their link status; the
+//  chain swaps linked ones in during the update traversal and keeps the
+//  running program when a link fails.
+//
+//  The viewer's context is captured by onDraw(), which PostProcessChain
+//  calls from the initial draw callback of its first camera.  Without a
+//  shareable context (pbuffer creation failed) the programs are compiled
+//  in that draw callback instead: still verified before the swap, but
+//  compile time then lands on the render thread.
+// ============================================================================
+
+#include <osg/Camera>
+#include <osg/GraphicsContext>
+#include <osg/Program>
+#include <osg/Referenced>
+#include <osg/observer_ptr>
+#include <osg/ref_ptr>
+
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ShaderHotReload : public osg::Referenced
+{
+public:
+    struct Result
+    {
+        unsigned int               tag = 0;
+        osg::ref_ptr<osg::Program> program;
+        bool                       linked = false;
+    };
+
+    explicit ShaderHotReload(const std::string& shaderDir, double pollSeconds = 0.25);
+
+    const std::string& getShaderDir() const { return m_dir; }
+
+    /// Paths (shaderDir + "/" + file name) modified since the last call.
+    /// Update thread.
+    std::vector<std::string> pollChanges();
+
+    /// Compile and link `program` off the render thread; its Result
+    /// carries `tag` back to the caller.
+    void compile(osg::ref_ptr<osg::Program> program, unsigned int tag);
+
+    /// Programs finished since the last call.
+    std::vector<Result> takeResults();
+
+    /// Captures the viewer's context and, without a shareable one,
+    /// compiles the queued programs.  Call every frame from a camera's
+    /// draw callback (draw thread, context current).
+    void onDraw(osg::RenderInfo& renderInfo);
+
+protected:
+    ~ShaderHotReload() override;
+
+private:
+    struct Job
+    {
+        osg::ref_ptr<osg::Program> program;
+        unsigned int               tag = 0;
+    };
+
+    using FileTimes = std::map<std::string, std::filesystem::file_time_type>;
+
+    FileTimes scan() const;
+    void      workerLoop();
+    bool      createContext();
+    Result    compileNow(const Job& job, osg::State& state) const;
+
+    std::string  m_dir;
+    double       m_pollSeconds;
+    double       m_lastPoll = 0.0;
+    FileTimes    m_times;
+
+    std::mutex                             m_mutex;
+    std::condition_variable                m_cv;
+    std::vector<Job>                       m_jobs;
+    std::vector<Result>                    m_results;
+    osg::observer_ptr<osg::GraphicsContext> m_sharedContext;
+    osg::ref_ptr<osg::GraphicsContext>     m_context;      ///< worker's pbuffer
+    bool                                   m_background = true;
+    bool                                   m_stop = false;
+    std::thread                            m_worker;
+};
@@ -0,0 +1,75 @@
+#include "TimingHud.h"
+
+#include <osg/Geode>
+#include <osg/NodeCallback>
+#include <osgText/Text>
+
+#include <cstdio>
+#include <string>
+
+// Rebuilds the text from the timer every few frames.
+class TimingHudCallback : public osg::NodeCallback
+{
+public:
+    TimingHudCallback(GpuTimer* timer, osgText::Text* text, unsigned int refresh)
+        : m_timer(timer), m_text(text), m_refresh(refresh ? refresh : 1) {}
+
+    void operator()(osg::Node* node, osg::NodeVisitor* nv) override
+    {
+        if (m_frame++ % m_refresh == 0)
+        {
+            std::string s = "GPU pass      min / avg / p99 ms\n";
+            double total = 0.0;
+            char line[160];
+            for (auto& t : m_timer->getTimings())
+            {
+                std::snprintf(line, sizeof(line), "%-28s %6.3f %6.3f %6.3f\n",
+                              t.name.c_str(), t.minMs, t.avgMs, t.p99Ms);
+                s += line;
+                total += t.avgMs;
+            }
+            std::snprintf(line, sizeof(line), "%-28s        %6.3f\n", "total", total);
+            s += line;
+            m_text->setText(s);
+        }
+        traverse(node, nv);
+    }
+
+private:
+    osg::ref_ptr<GpuTimer>      m_timer;
+    osg::ref_ptr<osgText::Text> m_text;
+    unsigned int                m_refresh;
+    unsigned int                m_frame = 0;
+};
+
+// ============================================================================
+osg::ref_ptr<osg::Camera> createTimingHud(GpuTimer* timer,
+                                          unsigned int width, unsigned int height,
+                                          unsigned int refreshFrames)
+{
+    osg::ref_ptr<osgText::Text> text = new osgText::Text;
+    text->setDataVariance(osg::Object::DYNAMIC);
+    text->setFont("fonts/cour.ttf");
+    text->setCharacterSize(14.0f);
+    text->setColor(osg::Vec4(1.0f, 1.0f, 0.3f, 1.0f));
+    text->setBackdropType(osgText::Text::OUTLINE);
+    text->setPosition(osg::Vec3(10.0f, height - 20.0f, 0.0f));
+
+    osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+    geode->addDrawable(text);
+
+    osg::StateSet* ss = geode->getOrCreateStateSet();
+    ss->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+    ss->setMode(GL_DEPTH_TEST, osg::StateAttribute::OFF);
+
+    osg::ref_ptr<osg::Camera> hud = new osg::Camera;
+    hud->setReferenceFrame(osg::Transform::ABSOLUTE_RF);
+    hud->setProjectionMatrix(osg::Matrix::ortho2D(0.0, width, 0.0, height));
+    hud->setViewMatrix(osg::Matrix::identity());
+    hud->setClearMask(0);
+    hud->setRenderOrder(osg::Camera::POST_RENDER, 1);   // after the final pass
+    hud->setAllowEventFocus(false);
+    hud->addChild(geode);
+    hud->addUpdateCallback(new TimingHudCallback(timer, text, refreshFrames));
+    return hud;
+}
@@ -0,0 +1,17 @@
+#pragma once
+// ============================================================================
+//  TimingHud — On-screen overlay for GpuTimer statistics
+// ============================================================================
+//  A POST_RENDER orthographic camera with one text block, refreshed every
+//  `refreshFrames` frames from GpuTimer::getTimings().  Add it to the
+//  viewer's root next to the chain.
+// ============================================================================
+
+#include "GpuTimer.h"
+
+#include <osg/Camera>
+#include <osg/ref_ptr>
+
+osg::ref_ptr<osg::Camera> createTimingHud(GpuTimer* timer,
+                                          unsigned int width, unsigned int height,
+                                          unsigned int refreshFrames = 30);
@@ -5,7 +5,7 @@
 //  toggled on/off and adjusted at runtime.
 //
 //  Pipeline (physically correct order):
-//    Scene → PRNU → Dark Noise → Photon Noise → Read Noise → Screen
+//    Scene → PRNU → Dark Noise → Photon Noise → Read Noise → ADC → Screen
 //
 //  Controls:
 //    +/-       Photon scale       (shot noise level)
@@ -13,134 +13,481 @@
 //    n/N       Read noise         (increase / decrease)
 //    p/P       PRNU strength      (increase / decrease)
 //    s/S       DSNU strength      (increase / decrease)
-//    1-4       Toggle individual effects on/off
-//    R         Reset all to defaults
+//    b/B       ADC bit depth      (increase / decrease)
+//    1-5       Toggle individual effects on/off
+//    R         Reset all to the profile (defaults without --profile)
 //    Esc       Quit
+//
+//  Usage:
+//    PhotonNoiseDemo [--fused | --compute] [--poisson fast|table|exact]
+//                    [--signal unorm8|half|float|r11g11b10]
+//                    [--seed N] [--fast-normals] [--timing] [--timing-csv FILE] [--shader-cache DIR]
+//                    [--shader-dir DIR [--hot-reload]] [--sensors N]
+//                    [--size W H] [--dynamic-res MS] [--scene-scale S] [--subframes N]
+//                    [--threading single|draw|cull-draw] [--fps vsync|uncapped|HZ]
+//                    [--cfa rggb|bggr|grbg|gbrg [--demosaic]] [--profile FILE]
+//                    [--sequence PATH | model file]
+//    PhotonNoiseDemo --batch [--frames N] [--output DIR] [--format EXT]
+//                    [--writers N] [--layers K] [--subframes N] [--tile N]
+//                    [--scene-scale S]
+//                    [--seed N] [--fast-normals] [--cfa PATTERN [--demosaic]]
+//                    [--profile FILE ...]
+//                    [--sequence PATH [--cpu N] | model files...]
+//      --fused   Run all enabled effects as one generated shader pass
+//      --compute Run them as one GL 4.3 compute dispatch (16x16 tiles)
+//      --poisson Small-lambda Poisson sampler (default table)
+//      --signal  Storage between effects (default half: linear RGBA16F,
+//                quantised only by the ADC stage)
+//      --seed    64-bit noise seed (decimal or 0x hex, default 0).  Render
+//                nodes whose seeds differ in only the low or only the high
+//                32 bits (e.g. the node index) produce disjoint noise; the
+//                same seed reproduces a run frame for frame
+//      --fast-normals  Approximate Gaussian draws without log / cos
+//                (exact mean and variance, tails cut at 3.46 sigma)
+//      --timing  Time every pass on the GPU; HUD overlay (interactive) or
+//                a summary at exit (batch).  --timing-csv logs every sample
+//      --shader-cache  Keep linked program binaries in DIR so later runs
+//                skip GLSL compilation (per driver; stale entries relink)
+//      --shader-dir    Read GLSL from DIR instead of the copies built into
+//                the executable (edit shaders without rebuilding)
+//      --hot-reload    Watch the shader directory; edited programs are
+//                recompiled in the background and swapped in once linked
+//      --sensors Render the scene once and show N sensors in a mosaic
+//                (photon scale halved per sensor; keys control sensor 0)
+//      --size    Window / output size (default 1280 720); the chain
+//                follows window resizes
+//      --dynamic-res   Lower the internal render size (down to half) to
+//                keep frames near MS milliseconds
+//      --scene-scale   Render the scene at S (1/16 .. 1) of the sensor
+//                resolution and upsample it; noise stays per pixel
+//      --subframes     Integrate (sum) N renders into each output frame on
+//                the GPU; read noise and ADC run once per exposure
+//                (multi-pass)
+//      --threading     Viewer threading model: single-threaded, a draw
+//                thread per context (update / cull overlap the draw), or
+//                also a cull thread per camera (default: OSG's choice)
+//      --fps     Frame pacing: sync to the display (default), as fast as
+//                possible, or at most HZ frames per second.  The achieved
+//                rate is printed every few seconds
+//      --cfa     Sample one colour per photosite; output is a one-channel
+//                raw frame (grey on screen)
+//      --demosaic      Bilinear demosaic back to RGB after the ADC
+//      --profile Sensor profile (JSON, see SensorProfile.h) over the
+//                options above.  In batch mode repeat it to render every
+//                scene per profile into DIR/<name>, switching between
+//                chains built once per pipeline; interactive uses the first
+//      --sequence      Add noise to an image sequence (a directory of
+//                frames, or one image) instead of rendering a scene; it
+//                plays on a loop, or in batch every frame is written once
+//                at its own size.  Decode video to frames first
+//      --cpu     Batch sequences on the CPU reference backend with N
+//                threads (0 = one per core); needs no GPU
+//      --batch   Headless: render each scene N frames into a pbuffer and
+//                write the chain output to DIR (default 100, "output", png)
+//      --format  raw (16-bit), tif, exr, or any osgDB image extension
+//      --writers Encoder threads (default: one per core)
+//      --layers  Render the scene once per K output frames; the fused
+//                noise pass writes K independent realisations (max 32)
+//      --tile    Treat --size as a virtual sensor (up to 65536 a side) and
+//                render it in NxN tiles, one file per tile, with seamless
+//                noise; memory stays that of one tile.  Scenes only
 // ============================================================================
 
 #include "SensorNoiseSimulator.h"
+#include "SensorProfile.h"
+#include "BatchRenderer.h"
+#include "SensorRig.h"
+#include "TimingHud.h"
+#include "DefaultScene.h"
+#include "ProgramCache.h"
+#include "SequenceReader.h"
+#include "PboUpload.h"
 
 #include <osg/Group>
-#include <osg/Geode>
-#include <osg/ShapeDrawable>
-#include <osg/Material>
-#include <osg/Light>
-#include <osg/LightSource>
+#include <osg/ArgumentParser>
+#include <osg/DisplaySettings>
+#include <osg/Timer>
 #include <osgDB/ReadFile>
 #include <osgViewer/Viewer>
 #include <osgGA/TrackballManipulator>
+#include <osgGA/GUIEventHandler>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <vector>
 
-// ── Build a default lit scene ───────────────────────────────────────────
-static osg::ref_ptr<osg::Group> createDefaultScene()
+// ============================================================================
+// Keeps a chain at the size of the window it renders to.
+class ChainResizeHandler : public osgGA::GUIEventHandler
 {
-    osg::ref_ptr<osg::Group> root = new osg::Group;
+public:
+    explicit ChainResizeHandler(PostProcessChain& chain) : m_chain(chain) {}
 
-    // Sphere
+    bool handle(const osgGA::GUIEventAdapter& ea, osgGA::GUIActionAdapter&) override
     {
-        auto sphere = new osg::Sphere(osg::Vec3(0, 0, 0), 1.0f);
-        auto drawable = new osg::ShapeDrawable(sphere);
-        drawable->setColor(osg::Vec4(0.8f, 0.3f, 0.2f, 1.0f));
-
-        osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-        geode->addDrawable(drawable);
-
-        auto mat = new osg::Material;
-        mat->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.8f, 0.3f, 0.2f, 1.0f));
-        mat->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(1, 1, 1, 1));
-        mat->setShininess(osg::Material::FRONT_AND_BACK, 64.0f);
-        geode->getOrCreateStateSet()->setAttributeAndModes(mat);
-        root->addChild(geode);
+        if (ea.getEventType() == osgGA::GUIEventAdapter::RESIZE &&
+            ea.getWindowWidth() > 0 && ea.getWindowHeight() > 0)
+            m_chain.resize(ea.getWindowWidth(), ea.getWindowHeight());
+        return false;
     }
 
-    // Ground plane
-    {
-        auto box = new osg::Box(osg::Vec3(0, 0, -1.2f), 8.0f, 8.0f, 0.1f);
-        auto drawable = new osg::ShapeDrawable(box);
-        drawable->setColor(osg::Vec4(0.4f, 0.4f, 0.5f, 1.0f));
+private:
+    PostProcessChain& m_chain;
+};
 
-        osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-        geode->addDrawable(drawable);
-        root->addChild(geode);
-    }
+// ============================================================================
+// Prints the achieved frame rate every few seconds and the average at exit.
+class FrameRateReport : public osgGA::GUIEventHandler
+{
+public:
+    explicit FrameRateReport(double interval = 5.0) : m_interval(interval) {}
 
-    // Second sphere
+    ~FrameRateReport() override
     {
-        auto sphere = new osg::Sphere(osg::Vec3(2.0f, 1.0f, -0.5f), 0.5f);
-        auto drawable = new osg::ShapeDrawable(sphere);
-        drawable->setColor(osg::Vec4(0.2f, 0.6f, 0.9f, 1.0f));
-
-        osg::ref_ptr<osg::Geode> geode = new osg::Geode;
-        geode->addDrawable(drawable);
-
-        auto mat = new osg::Material;
-        mat->setDiffuse(osg::Material::FRONT_AND_BACK, osg::Vec4(0.2f, 0.6f, 0.9f, 1.0f));
-        mat->setSpecular(osg::Material::FRONT_AND_BACK, osg::Vec4(1, 1, 1, 1));
-        mat->setShininess(osg::Material::FRONT_AND_BACK, 32.0f);
-        geode->getOrCreateStateSet()->setAttributeAndModes(mat);
-        root->addChild(geode);
+        const double seconds = m_timer.delta_s(m_start, m_timer.tick());
+        if (m_frames > 0 && seconds > 0.0)
+            std::cout << "[Main] Average " << m_frames / seconds << " fps over "
+                      << m_frames << " frames\n";
     }
 
-    // Light
+    bool handle(const osgGA::GUIEventAdapter& ea, osgGA::GUIActionAdapter&) override
     {
-        auto light = new osg::Light;
-        light->setLightNum(0);
-        light->setPosition(osg::Vec4(5, 5, 10, 1));
-        light->setDiffuse(osg::Vec4(1.0f, 0.95f, 0.85f, 1.0f));
-        light->setAmbient(osg::Vec4(0.15f, 0.15f, 0.2f, 1.0f));
-        light->setSpecular(osg::Vec4(1, 1, 1, 1));
-
-        auto ls = new osg::LightSource;
-        ls->setLight(light);
-        root->addChild(ls);
+        if (ea.getEventType() != osgGA::GUIEventAdapter::FRAME)
+            return false;
+        const osg::Timer_t now = m_timer.tick();
+        if (m_frames++ == 0)
+        {
+            m_start = m_last = now;
+            return false;
+        }
+        ++m_sinceLast;
+        const double seconds = m_timer.delta_s(m_last, now);
+        if (seconds >= m_interval)
+        {
+            std::cout << "[Main] " << m_sinceLast / seconds << " fps ("
+                      << 1000.0 * seconds / m_sinceLast << " ms/frame)\n";
+            m_last = now;
+            m_sinceLast = 0;
+        }
+        return false;
     }
 
-    return root;
-}
+private:
+    osg::Timer   m_timer;
+    osg::Timer_t m_start = 0, m_last = 0;
+    unsigned int m_frames = 0, m_sinceLast = 0;
+    double       m_interval;
+};
 
 // ============================================================================
 int main(int argc, char** argv)
 {
-    const unsigned int WIDTH  = 1280;
-    const unsigned int HEIGHT = 720;
+    osg::ArgumentParser arguments(&argc, argv);
+    unsigned int WIDTH  = 1280;
+    unsigned int HEIGHT = 720;
+    arguments.read("--size", WIDTH, HEIGHT);
+    double dynamicResMs = 0.0;
+    arguments.read("--dynamic-res", dynamicResMs);
+    float sceneScale = 1.0f;
+    arguments.read("--scene-scale", sceneScale);
+    std::string threading;
+    arguments.read("--threading", threading);
+    std::string fps = "vsync";
+    arguments.read("--fps", fps);
+    bool fused = arguments.read("--fused");
+    bool compute = arguments.read("--compute");
+    bool batch = arguments.read("--batch");
+    std::string poisson = "table";
+    arguments.read("--poisson", poisson);
+    std::string signal = "half";
+    arguments.read("--signal", signal);
+    std::string seedText;
+    arguments.read("--seed", seedText);
+    std::uint64_t seed = 0;
+    if (!seedText.empty())
+    {
+        char* end = nullptr;
+        seed = std::strtoull(seedText.c_str(), &end, 0);
+        if (*end != '\0')
+            std::cerr << "[Main] Invalid --seed: " << seedText << " (using " << seed << ")\n";
+    }
+    bool fastNormals = arguments.read("--fast-normals");
+    std::string timingCsv;
+    bool timing = arguments.read("--timing");
+    if (arguments.read("--timing-csv", timingCsv))
+        timing = true;
+    std::string shaderCache;
+    if (arguments.read("--shader-cache", shaderCache))
+        ProgramCache::instance().setBinaryCacheDirectory(shaderCache);
+    std::string shaderDir = "shaders";
+    if (arguments.read("--shader-dir", shaderDir))
+        ProgramCache::instance().setReadFromDisk(true);
+    bool hotReload = arguments.read("--hot-reload");
+
+    BatchRenderer::Options batchOptions;
+    batchOptions.width  = WIDTH;
+    batchOptions.height = HEIGHT;
+    arguments.read("--frames", batchOptions.frames);
+    arguments.read("--output", batchOptions.outputDir);
+    arguments.read("--format", batchOptions.extension);
+    arguments.read("--writers", batchOptions.writerThreads);
+    arguments.read("--layers", batchOptions.layers);
+    arguments.read("--tile", batchOptions.tileSize);
+    unsigned int sensors = 1;
+    arguments.read("--sensors", sensors);
+    unsigned int subFrames = 1;
+    arguments.read("--subframes", subFrames);
+    std::string cfa;
+    arguments.read("--cfa", cfa);
+    bool demosaic = arguments.read("--demosaic");
+    std::string sequencePath;
+    arguments.read("--sequence", sequencePath);
+    int cpuThreads = -1;
+    arguments.read("--cpu", cpuThreads);
+    std::vector<std::string> profilePaths;
+    for (std::string path; arguments.read("--profile", path); )
+        profilePaths.push_back(path);
+
+    // A sequence replaces the scene and sets the size
+    std::unique_ptr<SequenceReader> sequence;
+    if (!sequencePath.empty())
+    {
+        sequence.reset(new SequenceReader(SequenceReader::listFiles(sequencePath)));
+        if (!sequence->start(!batch))
+            return 1;
+        WIDTH  = sequence->getWidth();
+        HEIGHT = sequence->getHeight();
+        if (sensors > 1)
+            std::cerr << "[Main] --sensors needs a scene; showing one sensor.\n";
+        sensors = 1;
+    }
+
+    // Load scenes (every remaining argument), or create the default one
+    std::vector<osg::ref_ptr<osg::Node>> scenes;
+    for (int i = 1; sequence == nullptr && i < arguments.argc(); ++i)
+    {
+        if (arguments.isOption(i))
+            continue;
+        osg::ref_ptr<osg::Node> node = osgDB::readRefNodeFile(arguments[i]);
+        if (node)
+            scenes.push_back(node);
+        else
+            std::cerr << "[Main] Could not load: " << arguments[i] << "\n\n";
+    }
+    if (scenes.empty() && !sequence)
+        scenes.push_back(createDefaultScene());
+
+    // Chain options, shared by the simulator and every rig sensor
+    PostProcessChain::PoissonQuality poissonQuality = PostProcessChain::PoissonQuality::Table;
+    if (poisson == "fast")
+        poissonQuality = PostProcessChain::PoissonQuality::Fast;
+    else if (poisson == "exact")
+        poissonQuality = PostProcessChain::PoissonQuality::Exact;
+    else if (poisson != "table")
+        std::cerr << "[Main] Unknown --poisson mode: " << poisson << " (using table)\n";
+    PostProcessChain::SignalFormat signalFormat = PostProcessChain::SignalFormat::Float16;
+    if (signal == "unorm8")
+        signalFormat = PostProcessChain::SignalFormat::UNorm8;
+    else if (signal == "float")
+        signalFormat = PostProcessChain::SignalFormat::Float32;
+    else if (signal == "r11g11b10")
+        signalFormat = PostProcessChain::SignalFormat::R11G11B10F;
+    else if (signal != "half")
+        std::cerr << "[Main] Unknown --signal format: " << signal << " (using half)\n";
+    PostProcessChain::CfaPattern cfaPattern = PostProcessChain::CfaPattern::None;
+    if (cfa == "rggb")
+        cfaPattern = PostProcessChain::CfaPattern::RGGB;
+    else if (cfa == "bggr")
+        cfaPattern = PostProcessChain::CfaPattern::BGGR;
+    else if (cfa == "grbg")
+        cfaPattern = PostProcessChain::CfaPattern::GRBG;
+    else if (cfa == "gbrg")
+        cfaPattern = PostProcessChain::CfaPattern::GBRG;
+    else if (!cfa.empty())
+        std::cerr << "[Main] Unknown --cfa pattern: " << cfa << " (using full RGB)\n";
+    const PostProcessChain::Backend backend = compute ? PostProcessChain::Backend::Compute
+                                                      : PostProcessChain::Backend::Raster;
+
+    // The command line as a profile; --profile files are read over it
+    SensorProfile cliProfile;
+    cliProfile.name = "cli";
+    cliProfile.pipeline.mode = fused ? PostProcessChain::BuildMode::Fused
+                                     : PostProcessChain::BuildMode::MultiPass;
+    cliProfile.pipeline.backend   = backend;
+    cliProfile.pipeline.signal    = signalFormat;
+    cliProfile.pipeline.poisson   = poissonQuality;
+    cliProfile.pipeline.cfa       = cfaPattern;
+    cliProfile.pipeline.demosaic  = demosaic;
+    cliProfile.pipeline.subFrames = subFrames;
+    cliProfile.params.photonFastNormals = fastNormals;
+    cliProfile.params.darkFastNormals   = fastNormals;
+    cliProfile.params.readFastNormals   = fastNormals;
+
+    std::vector<SensorProfile> profiles;
+    for (const std::string& path : profilePaths)
+    {
+        SensorProfile profile = cliProfile;
+        if (!SensorProfile::load(path, profile))
+            return 1;
+        for (const SensorProfile& other : profiles)
+        {
+            if (other.name == profile.name)
+            {
+                std::cerr << "[Main] Profile name '" << profile.name << "' of " << path
+                          << " is already used; profiles write to per-name directories.\n";
+                return 1;
+            }
+        }
+        std::cout << "[Main] Profile '" << profile.name << "' from " << path << "\n";
+        profiles.push_back(profile);
+    }
+    const SensorProfile& profile = profiles.empty() ? cliProfile : profiles.front();
+
+    // Settings profiles do not hold, shared by every simulator
+    auto configure = [&](SensorNoiseSimulator& sim) {
+        sim.chain().setGpuTimingEnabled(timing);
+        sim.chain().setHotReloadEnabled(hotReload);
+        sim.chain().setSeed(seed);
+        sim.chain().setSceneScale(sceneScale);
+    };
+
+    // Create modular sensor noise simulator
+    SensorNoiseSimulator simulator(WIDTH, HEIGHT, shaderDir, profile.pipeline.backend);
+    configure(simulator);
+    simulator.applyProfile(profile);
+
+    if (cpuThreads >= 0 && !(batch && sequence))
+        std::cerr << "[Main] --cpu needs --batch and --sequence; using the GPU.\n";
+    if (batch && sensors > 1)
+        std::cerr << "[Main] --sensors is interactive only; rendering one sensor.\n";
+    if (batchOptions.tileSize > 0 && (!batch || sequence))
+        std::cerr << "[Main] --tile needs --batch and a scene; rendering untiled.\n";
+    if (profiles.size() > 1 && (!batch || sequence))
+        std::cerr << "[Main] Several --profile need --batch and a scene; using '"
+                  << profile.name << "'.\n";
+    if (batch)
+    {
+        batchOptions.timingCsv = timingCsv;
+        BatchRenderer renderer(simulator, batchOptions);
+        if (sequence && cpuThreads >= 0)
+            return renderer.runSequenceCpu(*sequence, unsigned(cpuThreads));
+        if (sequence)
+            return renderer.runSequence(*sequence);
+        return profiles.size() > 1 ? renderer.runProfiles(profiles, scenes, configure)
+                                   : renderer.run(scenes);
+    }
 
     std::cout << "====================================================\n"
               << "  Sensor Noise Simulator — Modular OSG Pipeline\n"
               << "====================================================\n"
-              << "  Noise modules (toggle with 1-4):\n"
+              << "  Noise modules (toggle with 1-5):\n"
               << "    1  PRNU         (Photo-Response Non-Uniformity)\n"
               << "    2  Dark Noise   (Dark Current + DSNU + Hot Pixels)\n"
               << "    3  Photon Noise (Poisson Shot Noise)\n"
               << "    4  Read Noise   (Gaussian Readout)\n"
+              << "    5  ADC          (Gain + N-bit Quantisation)\n"
               << "\n"
               << "  Parameter controls:\n"
               << "    +/-   Photon scale    d/D   Dark current\n"
               << "    n/N   Read noise      p/P   PRNU\n"
-              << "    s/S   DSNU            R     Reset all\n"
+              << "    s/S   DSNU            b/B   ADC bits\n"
+              << "    R     Reset all to the profile\n"
               << "====================================================\n\n";
 
-    // Load or create scene
-    osg::ref_ptr<osg::Node> scene;
-    if (argc > 1)
+    // A rig renders the scene once and fans it out into N sensors, each
+    // with half the photon scale of the previous one; keys drive sensor 0.
+    SensorRig rig(WIDTH, HEIGHT, shaderDir);
+    SensorNoiseSimulator* controlled = &simulator;
+    osg::ref_ptr<osg::Group> root;
+    if (sensors > 1)
+    {
+        const unsigned int cols = static_cast<unsigned int>(std::ceil(std::sqrt(double(sensors))));
+        for (unsigned int i = 0; i < sensors; ++i)
+        {
+            SensorNoiseSimulator& sensor = rig.addSensor(WIDTH / cols, HEIGHT / cols,
+                                                         profile.pipeline.backend);
+            configure(sensor);
+            sensor.applyProfile(profile);
+            sensor.photonNoise()->setPhotonScale(profile.params.photonScale / float(1u << std::min(i, 16u)));
+        }
+        rig.setOutput(SensorRig::Output::MosaicOnScreen);
+        rig.setSceneFormat(simulator.chain().getSignalInternalFormat());
+        root = rig.build(scenes.front());
+        controlled = &rig.sensor(0);
+    }
+    else if (sequence)
     {
-        scene = osgDB::readNodeFile(argv[1]);
-        if (!scene)
-            std::cerr << "[Main] Could not load: " << argv[1] << "\n\n";
+        // Show the newest decoded frame; a slow decoder repeats the last
+        osg::ref_ptr<osg::Texture2D> input = RenderTargetPool::createTexture(
+            WIDTH, HEIGHT, PboUpload::internalFormatFor(sequence->getDataType()));
+        SequenceReader* reader = sequence.get();
+        osg::ref_ptr<PboUpload> upload = new PboUpload(
+            input, WIDTH, HEIGHT,
+            [reader](osg::ref_ptr<osg::Image>& image)
+            {
+                SequenceReader::Frame frame;
+                if (!reader->next(frame, false))
+                    return false;
+                image = frame.image;
+                return true;
+            },
+            sequence->getPixelFormat(), sequence->getDataType());
+        root = simulator.applyToTexture(input);
+        root->addChild(PboUpload::createCamera(upload));
+    }
+    else
+    {
+        root = simulator.apply(scenes.front());
+        if (dynamicResMs > 0.0)
+            simulator.chain().setDynamicResolution(true, dynamicResMs);
     }
-    if (!scene)
-        scene = createDefaultScene();
 
-    // Create modular sensor noise simulator
-    SensorNoiseSimulator simulator(WIDTH, HEIGHT);
-    osg::ref_ptr<osg::Group> root = simulator.apply(scene);
+    if (GpuTimer* timer = controlled->chain().getGpuTimer())
+    {
+        if (!timingCsv.empty())
+            timer->openCsv(timingCsv);
+        root->addChild(createTimingHud(timer, WIDTH, HEIGHT));
+    }
+
+    // ── Threading model and frame pacing ────────────────────────────────
+    osgViewer::Viewer::ThreadingModel threadingModel = osgViewer::Viewer::AutomaticSelection;
+    if (threading == "single")
+        threadingModel = osgViewer::Viewer::SingleThreaded;
+    else if (threading == "draw")
+        threadingModel = osgViewer::Viewer::DrawThreadPerContext;
+    else if (threading == "cull-draw")
+        threadingModel = osgViewer::Viewer::CullThreadPerCameraDrawThreadPerContext;
+    else if (!threading.empty())
+        std::cerr << "[Main] Unknown --threading model: " << threading << " (using OSG's choice)\n";
+
+    bool   vsync   = fps == "vsync";
+    double maxRate = 0.0;
+    if (!vsync && fps != "uncapped")
+    {
+        maxRate = std::atof(fps.c_str());
+        if (maxRate <= 0.0)
+        {
+            std::cerr << "[Main] Invalid --fps: " << fps << " (using vsync)\n";
+            vsync = true;
+        }
+    }
+    osg::DisplaySettings::instance()->setSyncToVBlank(vsync);
 
     // Set up viewer
     osgViewer::Viewer viewer;
+    viewer.setThreadingModel(threadingModel);
+    viewer.setRunMaxFrameRate(maxRate);
     viewer.setSceneData(root);
     viewer.setUpViewInWindow(100, 100, WIDTH, HEIGHT);
     viewer.setCameraManipulator(new osgGA::TrackballManipulator);
-    viewer.addEventHandler(simulator.getEventHandler());
+    viewer.addEventHandler(controlled->getEventHandler());
+    if (sensors <= 1)
+        viewer.addEventHandler(new ChainResizeHandler(simulator.chain()));
+    viewer.addEventHandler(new FrameRateReport);
 
     return viewer.run();
 }